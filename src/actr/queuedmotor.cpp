@@ -0,0 +1,70 @@
+#include "queuedmotor.h"
+#include <time.h>
+#include <errno.h>
+
+CREATE_LOGGER("QueuedMotor");
+
+QueuedMotor::QueuedMotor(PlayerCc::Position2dProxy& proxy) : Motor(proxy) {
+    sem_init(&pending, 0, 0);
+    dropped = 0;
+    LOG_CTOR << "Constructed." << std::endl;
+}
+
+QueuedMotor::~QueuedMotor() {
+    sem_destroy(&pending);
+    LOG_DTOR << "Destructed." << std::endl;
+}
+
+void QueuedMotor::update() {
+    Order order;
+    order.isGoTo = false;
+    order.motion = motion;
+    queue(order);
+}
+
+void QueuedMotor::goTo(Position pos) {
+    Order order;
+    order.isGoTo = true;
+    order.goal = pos;
+    queue(order);
+}
+
+void QueuedMotor::queue(const Order& order) {
+    if (orders.push(order))
+        sem_post(&pending);
+    else
+        dropped++;
+}
+
+bool QueuedMotor::apply(int timeout) {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += timeout / 1000;
+    ts.tv_nsec += (timeout % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+
+    int r;
+    while ((r = sem_timedwait(&pending, &ts)) == -1 && errno == EINTR)
+        ; //interrupted by a signal, keep waiting
+    if (r == -1)
+        return false; //timed out
+
+    Order order;
+    if (!orders.pop(order))
+        return false;
+
+    if (order.isGoTo)
+        positionProxy->GoTo(order.goal.x, order.goal.y, order.goal.yaw);
+    else
+        positionProxy->SetSpeed(order.motion.x, order.motion.yaw);
+    return true;
+}
+
+std::string QueuedMotor::toString() {
+    std::stringstream out;
+    out << "QueuedMotor dropped: " << dropped << " " << Motor::toString();
+    return out.str();
+}
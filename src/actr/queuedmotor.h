@@ -0,0 +1,89 @@
+/** @file       src/actr/queuedmotor.h
+    @ingroup    ACTR
+    @brief      Motor that hands commands to an actuation thread.
+    @author     Jacob Perron <perronj@yorku.ca>
+    @author     Alex Moriarty <alexander@dal.ca>
+*/
+
+#ifndef __ACTR_QUEUEDMOTOR_H_
+#define __ACTR_QUEUEDMOTOR_H_
+
+#include <semaphore.h>
+#include <boost/lockfree/spsc_queue.hpp>
+#include "motor.h"
+
+/** A Motor whose commands are sent to Player by another thread.
+ *
+ *  Used when the Robot runs pipelined. Controllers keep calling
+ *  @ref update , @ref goTo and @ref halt as usual, but instead of talking
+ *  to the Position2dProxy these only push an order onto a lock-free
+ *  single-producer/single-consumer ring. The actuation thread calls
+ *  @ref apply in a loop to send the orders, so a slow Player write never
+ *  holds up the controller.
+ *
+ *  Only one thread may issue commands and only one thread may call
+ *  @ref apply .
+ */
+class QueuedMotor : public Motor {
+    public:
+
+        /** Constructor.
+         *
+         *  @param proxy : Position2dProxy from Player/Stage.
+         */
+        QueuedMotor(PlayerCc::Position2dProxy& proxy);
+
+        /** Destructor. */
+        ~QueuedMotor();
+
+        /** Queues the current motion to be sent to Player. */
+        void update();
+
+        /** Queues a goto to be sent to Player.
+         *
+         *  @param pos : The Position the robot should drive towards.
+         */
+        void goTo(Position pos);
+
+        /** Sends the next queued order to Player.
+         *
+         *  Called by the actuation thread. Blocks until an order is queued
+         *  or the timeout runs out.
+         *
+         *  @param timeout : Maximum time to wait, in milliseconds.
+         *
+         *  @return True if an order was sent, false on timeout.
+         */
+        bool apply(int timeout);
+
+        /** Returns string representation of this Motor. */
+        std::string toString();
+
+    private:
+
+        /** A command waiting to be sent to Player. */
+        struct Order {
+            bool isGoTo;
+            Motion motion;
+            Position goal;
+        };
+
+        /** Orders from the controller thread to the actuation thread. */
+        boost::lockfree::spsc_queue<Order, boost::lockfree::capacity<64> > orders;
+
+        /** Counts queued orders so the actuation thread can sleep. */
+        sem_t pending;
+
+        /** Number of orders lost because the ring was full. */
+        unsigned long dropped;
+
+        /** Pushes an order and wakes the actuation thread. */
+        void queue(const Order& order);
+
+        /** Disable copy constructor. */
+        QueuedMotor(const QueuedMotor& source);
+
+        /** Disable assignment operator. */
+        QueuedMotor& operator=(const QueuedMotor& source);
+};
+#endif
@@ -9,13 +9,16 @@ uint         gDebug(0);
 uint         gFrequency(10); // Hz
 uint         gDataMode(PLAYER_DATAMODE_PUSH);
 bool         gUseLaser(false);
+bool         gPipelined(false);
+bool         gEventDriven(false);
+std::string  gWorld;
 
 void print_usage(int argc, char** argv);
 
 int parse_args(int argc, char** argv)
 {
   // set the flags
-  const char* optflags = "h:p:i:d:u:lm:";
+  const char* optflags = "h:p:i:d:u:lm:tew:";
   int ch;
 
   // use getopt to parse the flags
@@ -45,6 +48,15 @@ int parse_args(int argc, char** argv)
       case 'l': // datamode
           gUseLaser = true;
           break;
+      case 't': // threaded pipeline
+          gPipelined = true;
+          break;
+      case 'e': // event-driven loop
+          gEventDriven = true;
+          break;
+      case 'w': // map from a stage world
+          gWorld = optarg;
+          break;
       case '?': // help
       case ':':
       default:  // unknown
@@ -69,10 +81,16 @@ void print_usage(int argc, char** argv)
        << endl;
   cerr << "  -d <level>     : debug message level (0 = none -- 9 = all)"
        << endl;
-  cerr << "  -u <rate>      : set server update rate to <rate> in Hz"
+  cerr << "  -u <rate>      : set robot update rate to <rate> in Hz"
        << endl;
   cerr << "  -l      : Use laser if applicable"
        << endl;
+  cerr << "  -t      : Run sensing, control and actuation on separate threads"
+       << endl;
+  cerr << "  -e      : Run the controller only when Player sends fresh data"
+       << endl;
+  cerr << "  -w <world>     : load the map from the floorplan of a .world file"
+       << endl;
   cerr << "  -m <datamode>  : set server data delivery mode"
        << endl;
   cerr << "                      PLAYER_DATAMODE_PUSH = "
@@ -0,0 +1,1151 @@
+/** @file       src/bench/bench.cpp
+    @ingroup    BENCH
+    @brief      Offline benchmarks of the planning modules.
+    @author     Alex Moriarty <alexander@dal.ca>
+    @author     Jacob Perron <perronj@yorku.ca>
+*/
+
+#include <stdlib.h>
+#include <math.h>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include "data/footprint.h"
+#include "plan/map.h"
+#include "plan/mapper.h"
+#include "plan/gridplanner.h"
+#include "plan/dstarlite.h"
+#include "plan/costmap.h"
+#include "plan/staticlayer.h"
+#include "plan/obstaclelayer.h"
+#include "plan/inflationlayer.h"
+#include "plan/localcostmap.h"
+#include "plan/localizer.h"
+#include "plan/scanmatcher.h"
+#include "plan/dynamicwindow.h"
+#include "plan/purepursuit.h"
+#include "plan/mpctracker.h"
+#include "plan/pathplanner.h"
+#include "objt/vectorfieldhistogram.h"
+#include "util/geometry.h"
+#include "util/kdtree.h"
+#include "util/scheduler.h"
+
+/** Simulated SICK LMS200: 361 readings over 180 degrees, 8 m. */
+static const unsigned int LASER_READINGS = 361;
+static const double LASER_MAX_RANGE = 8.0;
+
+/** Fills a RangerData with the geometry of the simulated laser. */
+static void makeLaser(RangerData& data) {
+    data.type = LASER;
+    data.minAngle = -M_PI / 2;
+    data.maxAngle = M_PI / 2;
+    data.angleRes = M_PI / (LASER_READINGS - 1);
+    data.minRange = 0;
+    data.maxRange = LASER_MAX_RANGE;
+    data.range.assign(LASER_READINGS, LASER_MAX_RANGE);
+    data.scan.resize(LASER_READINGS);
+    for (unsigned int i = 0; i < LASER_READINGS; i++) {
+        double a = data.minAngle + i * data.angleRes;
+        data.scan.angle[i] = a;
+        data.scan.cosAngle[i] = cos(a);
+        data.scan.sinAngle[i] = sin(a);
+    }
+}
+
+/** Casts the simulated laser in a map, in half-cell steps. */
+static void simulate(const Map& map, const Position& robot, RangerData& data) {
+    double step = map.getResolution() / 2;
+    for (unsigned int i = 0; i < data.scan.size; i++) {
+        double a = robot.yaw + data.scan.angle[i];
+        double c = cos(a), s = sin(a);
+        double r = 0;
+        for (; r < data.maxRange; r += step) {
+            int x, y;
+            if (!map.worldToGrid(robot.x + r * c, robot.y + r * s, x, y) ||
+                map.isOccupied(x, y))
+                break;
+        }
+        if (r > data.maxRange)
+            r = data.maxRange;
+        data.range[i] = r;
+        data.scan.range[i] = r;
+    }
+}
+
+/** Picks a random free pose on the map. */
+static Position randomPose(const Map& map) {
+    while (true) {
+        int x = rand() % map.getWidth();
+        int y = rand() % map.getHeight();
+        if (!map.isOccupied(x, y)) {
+            Position p = map.gridToWorld(x, y);
+            p.yaw = (rand() / (double)RAND_MAX) * 2 * M_PI - M_PI;
+            return p;
+        }
+    }
+}
+
+/** Measures how fast a Mapper adds laser scans to an empty map. */
+static int benchMapping(const std::string& world, int count) {
+    Map truth;
+    if (!truth.loadWorld(world)) {
+        std::cerr << "Failed to load " << world << std::endl;
+        return 1;
+    }
+
+    //simulate the scans up front so only the mapping is timed
+    std::vector<RangerData> scans(count);
+    std::vector<Position> poses(count);
+    for (int i = 0; i < count; i++) {
+        makeLaser(scans[i]);
+        poses[i] = randomPose(truth);
+        simulate(truth, poses[i], scans[i]);
+    }
+
+    Map map(truth.getWidth() * truth.getResolution(),
+            truth.getHeight() * truth.getResolution(),
+            truth.getResolution(), truth.getOrigin());
+    Mapper mapper(map);
+    int64_t start = Scheduler::now();
+    for (int i = 0; i < count; i++)
+        mapper.update(scans[i], poses[i]);
+    double seconds = (Scheduler::now() - start) / 1e9;
+
+    std::cout << "mapping " << world << ": " << map.getWidth() << "x"
+              << map.getHeight() << " cells, " << count << " scans of "
+              << LASER_READINGS << " readings" << std::endl
+              << "  " << std::fixed << std::setprecision(3)
+              << seconds * 1e3 / count << " ms per scan, "
+              << std::setprecision(0) << count / seconds << " scans/s, "
+              << mapper.getCells() / seconds << " cells/s" << std::endl;
+    return 0;
+}
+
+/** Costs fall to nothing this far beyond the robot radius, in meters. */
+static const double INFLATION_MARGIN = 0.36;
+
+/** Stacks the layers of a costmap.
+ *
+ *  @return The obstacle layer, owned by the costmap.
+ */
+static ObstacleLayer* makeLayers(Costmap& costmap, const Map& map) {
+    ObstacleLayer* obstacles = new ObstacleLayer(map);
+    costmap.addLayer(new StaticLayer(map));
+    costmap.addLayer(obstacles);
+    costmap.addLayer(new InflationLayer(map.getResolution(), ROBOT_RADIUS,
+                                        ROBOT_RADIUS + INFLATION_MARGIN));
+    return obstacles;
+}
+
+/** Times costmap updates from laser scans against rebuilding it.
+ *
+ *  A robot scans from random poses, each scan followed by an update. A
+ *  second costmap is fed the same scans but updated once at the end,
+ *  which covers the whole map, and both must agree.
+ */
+static int benchCostmap(const std::string& world, int count) {
+    Map map;
+    if (!map.loadWorld(world)) {
+        std::cerr << "Failed to load " << world << std::endl;
+        return 1;
+    }
+    Costmap costmap(map), batch(map);
+    ObstacleLayer* obstacles = makeLayers(costmap, map);
+    ObstacleLayer* batchObstacles = makeLayers(batch, map);
+
+    int64_t start = Scheduler::now();
+    costmap.update();
+    double fullTime = (Scheduler::now() - start) / 1e9;
+
+    RangerData scan;
+    makeLaser(scan);
+    double updateTime = 0;
+    unsigned long cells = 0;
+    for (int i = 0; i < count; i++) {
+        Position pose = randomPose(map);
+        simulate(map, pose, scan);
+        //a box in front of the robot that the static map does not have
+        for (unsigned int j = 160; j < 200; j++)
+            scan.scan.range[j] = scan.range[j] = std::min(scan.range[j], 1.0);
+        obstacles->addScan(scan, pose);
+        batchObstacles->addScan(scan, pose);
+
+        start = Scheduler::now();
+        Bounds b = costmap.update();
+        updateTime += (Scheduler::now() - start) / 1e9;
+        if (!b.isEmpty())
+            cells += (unsigned long)(b.x1 - b.x0 + 1) * (b.y1 - b.y0 + 1);
+    }
+    batch.update();
+
+    int wrong = 0;
+    for (int y = 0; y < map.getHeight(); y++)
+        for (int x = 0; x < map.getWidth(); x++)
+            if (costmap.getCost(x, y) != batch.getCost(x, y))
+                wrong++;
+
+    std::cout << "costmap " << world << ": " << map.getWidth() << "x"
+              << map.getHeight() << " cells, " << count << " scans" << std::endl
+              << std::fixed << std::setprecision(3) << "  full   "
+              << fullTime * 1e3 << " ms" << std::endl << "  update "
+              << updateTime * 1e3 / count << " ms mean, " << std::setprecision(0)
+              << cells / (double)count << " cells" << std::endl
+              << "  " << wrong << " cells differ from a single update" << std::endl;
+    return 0;
+}
+
+/** Times a rolling window following a robot across a map.
+ *
+ *  The robot drives diagonally from one corner to the other, scanning
+ *  at random headings. The window is just large enough for the laser to
+ *  never reach past it, and as the robot only ever moves up and right
+ *  no cell comes back into the window after leaving it, so the window
+ *  must agree with one large enough to never drop a cell.
+ */
+static int benchLocal(const std::string& world, int count) {
+    Map map;
+    if (!map.loadWorld(world)) {
+        std::cerr << "Failed to load " << world << std::endl;
+        return 1;
+    }
+    double res = map.getResolution();
+    int size = 2 * (int)ceil(LASER_MAX_RANGE / res) + 2;
+    LocalCostmap window(size, res);
+    LocalCostmap whole(2 * std::max(map.getWidth(), map.getHeight()) + size, res);
+    size = window.getSize();
+
+    RangerData scan;
+    makeLaser(scan);
+    Position from = map.gridToWorld(0, 0);
+    Position to = map.gridToWorld(map.getWidth() - 1, map.getHeight() - 1);
+    double time = 0;
+    int wrong = 0;
+    for (int i = 0; i < count; i++) {
+        double t = i / (double)std::max(count - 1, 1);
+        Position pose(from.x + t * (to.x - from.x), from.y + t * (to.y - from.y),
+                      (rand() / (double)RAND_MAX) * 2 * M_PI - M_PI);
+        simulate(map, pose, scan);
+
+        int64_t start = Scheduler::now();
+        window.youAreHere(pose);
+        window.addScan(scan);
+        time += (Scheduler::now() - start) / 1e9;
+        whole.youAreHere(pose);
+        whole.addScan(scan);
+
+        //compare the cells of the window
+        int cx = (int)floor(pose.x / res) - size / 2;
+        int cy = (int)floor(pose.y / res) - size / 2;
+        for (int y = cy; y < cy + size; y++) {
+            for (int x = cx; x < cx + size; x++) {
+                double wx = (x + 0.5) * res, wy = (y + 0.5) * res;
+                if (window.getCost(wx, wy) != whole.getCost(wx, wy))
+                    wrong++;
+            }
+        }
+    }
+
+    std::cout << "local " << world << ": " << count << " scans" << std::endl << std::fixed << std::setprecision(3) << "  tick "
+              << time * 1e3 / count << " ms mean" << std::endl
+              << "  " << window.toString() << std::endl
+              << "  " << wrong << " cells differ from an unbounded window" << std::endl;
+    return 0;
+}
+
+/** @return The distance between two poses, in meters. */
+static double poseError(const Position& a, const Position& b) {
+    return sqrt((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y));
+}
+
+/** Times Monte Carlo localization and checks it against drifting odometry.
+ *
+ *  The robot wanders the map, turning away from walls. Its odometry
+ *  over-reads distance by 3% and turns 0.05 rad per meter to the left,
+ *  while the laser is cast from the true pose.
+ */
+static int benchLocalize(const std::string& world, int particles, int count) {
+    Map map;
+    if (!map.loadWorld(world)) {
+        std::cerr << "Failed to load " << world << std::endl;
+        return 1;
+    }
+    map.computeDistance();
+    Localizer localizer(map, particles);
+
+    RangerData scan;
+    makeLaser(scan);
+    Position truth = randomPose(map);
+    while (map.getClearance(truth) < 0.5)
+        truth = randomPose(map);
+    Position odometry = truth;
+
+    double time = 0, filterError = 0, odometryError = 0;
+    for (int i = 0; i < count; i++) {
+        //step ahead, or turn on the spot in front of a wall
+        double step = 0.12, turn = 0.1 * (rand() / (double)RAND_MAX - 0.5);
+        Position next(truth.x + step * cos(truth.yaw), truth.y + step * sin(truth.yaw),
+                      truth.yaw + turn);
+        if (map.getClearance(next) < 0.4) {
+            step = 0;
+            turn = (rand() % 2 ? 1 : -1) * (0.5 + rand() / (double)RAND_MAX);
+            next = Position(truth.x, truth.y, truth.yaw + turn);
+        }
+        truth = next;
+        double measured = step * 1.03, drift = turn + 0.05 * step;
+        odometry.x += measured * cos(odometry.yaw);
+        odometry.y += measured * sin(odometry.yaw);
+        odometry.yaw += drift;
+        simulate(map, truth, scan);
+
+        int64_t start = Scheduler::now();
+        Position estimate = localizer.update(odometry, scan);
+        time += (Scheduler::now() - start) / 1e9;
+        filterError += poseError(estimate, truth);
+        odometryError += poseError(odometry, truth);
+    }
+
+    std::cout << "localize " << world << ": " << particles << " particles, "
+              << count << " steps" << std::endl << std::fixed
+              << std::setprecision(3) << "  " << localizer.toString() << std::endl
+              << "  mean error " << filterError / count << " m, odometry "
+              << odometryError / count << " m" << std::endl
+              << "  final error " << poseError(localizer.getPose(), truth)
+              << " m, odometry " << poseError(odometry, truth) << " m" << std::endl
+              << "  " << time * 1e3 / count << " ms per scan" << std::endl;
+    return 0;
+}
+
+/** Picks a start and a goal 2 to 5 m apart, both in the open. */
+static void randomRun(const Map& map, Position& robot, Position& goal) {
+    do {
+        robot = randomPose(map);
+        goal = randomPose(map);
+    } while (map.getClearance(robot) < 0.4 || map.getClearance(goal) < 0.4 ||
+             poseError(robot, goal) < 2 || poseError(robot, goal) > 5);
+}
+
+/** Times VFH+ steering and drives with it in a map.
+ *
+ *  Each run starts the robot at a random pose with a goal 2 to 5 m away
+ *  and drives with the steered motion at 10 Hz. A run ends at the goal,
+ *  in a collision, when the robot is within its inscribed radius of an
+ *  obstacle, or after a number of steps, stuck in a dead end VFH+ cannot
+ *  see out of without a planner.
+ */
+static int benchSteering(const std::string& world, int runs, int steps) {
+    Map map;
+    if (!map.loadWorld(world)) {
+        std::cerr << "Failed to load " << world << std::endl;
+        return 1;
+    }
+    map.computeDistance();
+
+    RangerData scan;
+    makeLaser(scan);
+    double time = 0, dt = 0.1;
+    int calls = 0, reached = 0, collided = 0;
+    for (int run = 0; run < runs; run++) {
+        Position robot, goal;
+        randomRun(map, robot, goal);
+        VectorFieldHistogram vfh;
+        for (int i = 0; i < steps; i++) {
+            if (poseError(robot, goal) < 0.3) {
+                reached++;
+                break;
+            }
+            if (map.getClearance(robot) < ROBOT_RADIUS) {
+                collided++;
+                break;
+            }
+            simulate(map, robot, scan);
+            double toGoal = atan2(goal.y - robot.y, goal.x - robot.x) - robot.yaw;
+
+            int64_t start = Scheduler::now();
+            Motion m = vfh.steer(scan, wrapAngle(toGoal), robot.yaw);
+            time += (Scheduler::now() - start) / 1e9;
+            calls++;
+
+            robot.x += m.x * dt * cos(robot.yaw);
+            robot.y += m.x * dt * sin(robot.yaw);
+            robot.yaw += m.yaw * dt;
+        }
+    }
+
+    std::cout << "vfh " << world << ": " << runs << " runs of up to " << steps
+              << " steps, " << VectorFieldHistogram::getSectors() << " sectors"
+              << std::endl << "  " << reached << " reached the goal, "
+              << collided << " collided, " << runs - reached - collided
+              << " stuck" << std::endl << std::fixed << std::setprecision(3)
+              << "  " << time * 1e6 / std::max(calls, 1) << " us per scan"
+              << std::endl;
+    return 0;
+}
+
+/** Times the Dynamic Window Approach and drives with it in a map.
+ *
+ *  Runs are set up as for VFH+, with the laser filling a LocalCostmap
+ *  that the planner reads, and the robot driving at the planned speeds
+ *  at 10 Hz.
+ */
+static int benchDynamicWindow(const std::string& world, int runs, int steps) {
+    Map map;
+    if (!map.loadWorld(world)) {
+        std::cerr << "Failed to load " << world << std::endl;
+        return 1;
+    }
+    map.computeDistance();
+
+    RangerData scan;
+    makeLaser(scan);
+    DynamicWindow dwa(0.1);
+    double time = 0;
+    int calls = 0, reached = 0, collided = 0;
+    for (int run = 0; run < runs; run++) {
+        Position robot, goal;
+        randomRun(map, robot, goal);
+        LocalCostmap window(128, map.getResolution());
+        Motion motion;
+        for (int i = 0; i < steps; i++) {
+            if (poseError(robot, goal) < 0.3) {
+                reached++;
+                break;
+            }
+            if (map.getClearance(robot) < ROBOT_RADIUS) {
+                collided++;
+                break;
+            }
+            simulate(map, robot, scan);
+            window.youAreHere(robot);
+            window.addScan(scan);
+
+            int64_t start = Scheduler::now();
+            motion = dwa.plan(window, goal, motion);
+            time += (Scheduler::now() - start) / 1e9;
+            calls++;
+
+            robot.x += motion.x * dwa.getPeriod() * cos(robot.yaw);
+            robot.y += motion.x * dwa.getPeriod() * sin(robot.yaw);
+            robot.yaw += motion.yaw * dwa.getPeriod();
+        }
+    }
+
+    std::cout << "dwa " << world << ": " << runs << " runs of up to " << steps
+              << " steps" << std::endl << "  " << reached << " reached the goal, "
+              << collided << " collided, " << runs - reached - collided
+              << " stuck" << std::endl << std::fixed << std::setprecision(3)
+              << "  " << dwa.toString() << std::endl
+              << "  " << time * 1e6 / std::max(calls, 1) << " us per plan"
+              << std::endl;
+    return 0;
+}
+
+/** Drives the robot at a motion for one period, with the speeds reached
+ *  within the acceleration limits of PurePursuit.
+ */
+static void drive(Position& robot, Motion& speed, const Motion& command, double dt) {
+    double accel = 0.5 * dt, turnAccel = 2.0 * dt;
+    speed.x += std::max(-accel, std::min(accel, command.x - speed.x));
+    speed.yaw += std::max(-turnAccel, std::min(turnAccel, command.yaw - speed.yaw));
+    robot.x += speed.x * dt * cos(robot.yaw);
+    robot.y += speed.x * dt * sin(robot.yaw);
+    robot.yaw += speed.yaw * dt;
+}
+
+/** @return Distance from a point to a line of waypoints. */
+static double lineDistance(const std::vector<Position>& line, const Position& p) {
+    double best = HUGE_VAL;
+    for (unsigned int i = 0; i + 1 < line.size(); i++) {
+        double sx = line[i + 1].x - line[i].x, sy = line[i + 1].y - line[i].y;
+        double l2 = sx * sx + sy * sy;
+        double t = l2 > 0 ? ((p.x - line[i].x) * sx + (p.y - line[i].y) * sy) / l2 : 0;
+        t = std::min(std::max(t, 0.0), 1.0);
+        best = std::min(best, hypot(line[i].x + t * sx - p.x, line[i].y + t * sy - p.y));
+    }
+    return best;
+}
+
+/** Time, distance from the end and furthest off the line, once turned
+ *  onto it past the first waypoint, of tracked runs.
+ */
+struct TrackStats {
+    double time, offLine, worst, error;
+    int finished;
+
+    TrackStats() : time(0), offLine(0), worst(0), error(0), finished(0) { };
+};
+
+/** Drives along waypoints with a PurePursuit or an MpcTracker. */
+template <class Tracker>
+static void runTracker(Tracker& tracker, const std::vector<Position>& waypoints,
+                       double dt, TrackStats& stats) {
+    Position robot = waypoints[0];
+    Motion speed;
+    tracker.setPath(waypoints);
+    int steps = 0;
+    double offLine = 0;
+    while (!tracker.isFinished() && steps < 100000) {
+        Motion command = tracker.track(robot, speed, dt);
+        drive(robot, speed, command, dt);
+        if (tracker.getWaypoint() > 1)
+            offLine = std::max(offLine, lineDistance(waypoints, robot));
+        steps++;
+    }
+    stats.time += steps * dt;
+    stats.offLine += offLine;
+    stats.worst = std::max(stats.worst, offLine);
+    stats.error += poseError(robot, waypoints.back());
+    stats.finished += tracker.isFinished();
+}
+
+/** Prints the stats of tracked runs. */
+static void printTracking(const char* label, const TrackStats& stats, int runs) {
+    std::cout << "  " << label << std::fixed << std::setprecision(1)
+              << stats.time / runs << " s per path, " << stats.finished
+              << " finished " << std::setprecision(3) << stats.error / runs
+              << " m from the end, " << stats.offLine / runs << " m off the line, "
+              << stats.worst << " m at worst" << std::endl;
+}
+
+/** Times missions along planned paths, stopping at every position against
+ *  blending through them with pure pursuit and with MPC.
+ *
+ *  Stopping, the robot turns to face each position on the spot, then
+ *  drives straight to it at PathExecuter::SPEED and TURNRATE, as the
+ *  proxy's GoTo does. All modes accelerate as fast as the same limits
+ *  allow.
+ */
+static int benchTracking(const std::string& world, int runs) {
+    Map map;
+    if (!map.loadWorld(world)) {
+        std::cerr << "Failed to load " << world << std::endl;
+        return 1;
+    }
+    map.computeDistance();
+
+    double dt = 0.1, stopTime = 0, length = 0;
+    int positions = 0;
+    PurePursuit pursuit;
+    MpcTracker mpc, rushed;
+    rushed.setBudget(20e-6);
+    TrackStats pursuitStats, mpcStats, rushedStats;
+    GridPlanner planner;
+    Path path;
+    for (int run = 0; run < runs; run++) {
+        Position start = randomPose(map), dest = randomPose(map);
+        while (map.getClearance(start) < 0.4 || map.getClearance(dest) < 0.4 ||
+               poseError(start, dest) < 5 ||
+               !PathPlanner::calcPath(planner, map, start, dest, path) || path.size() < 3) {
+            start = randomPose(map);
+            dest = randomPose(map);
+        }
+        std::vector<Position> waypoints(1, start);
+        for (int i = 0; i < path.size(); i++)
+            waypoints.push_back(path.getPosition(i));
+        for (unsigned int i = 1; i < waypoints.size(); i++)
+            length += poseError(waypoints[i - 1], waypoints[i]);
+        positions += waypoints.size() - 1;
+
+        //stop and turn at every position
+        Position robot = start;
+        Motion speed;
+        int steps = 0;
+        for (unsigned int i = 1; i < waypoints.size() && steps < 100000; i++) {
+            while (poseError(robot, waypoints[i]) > 0.1 && steps < 100000) {
+                double off = atan2(waypoints[i].y - robot.y, waypoints[i].x - robot.x) - robot.yaw;
+                off = wrapAngle(off);
+                Motion command(0, off > 0 ? 0.5 : -0.5);
+                if (fabs(off) < 0.05)
+                    command = Motion(0.5, 2 * off);
+                else if (speed.x > 0)
+                    command = Motion(0, 0);
+                drive(robot, speed, command, dt);
+                steps++;
+            }
+        }
+        stopTime += steps * dt;
+
+        //blend through them
+        runTracker(pursuit, waypoints, dt, pursuitStats);
+        runTracker(mpc, waypoints, dt, mpcStats);
+        runTracker(rushed, waypoints, dt, rushedStats);
+    }
+
+    std::cout << "track " << world << ": " << runs << " paths, " << std::fixed
+              << std::setprecision(1) << length / runs << " m and "
+              << positions / (double)runs << " positions on average" << std::endl
+              << "  stop at positions " << stopTime / runs << " s per path" << std::endl;
+    printTracking("pure pursuit      ", pursuitStats, runs);
+    printTracking("mpc               ", mpcStats, runs);
+    std::cout << "    " << mpc.toString() << std::endl;
+    printTracking("mpc, 20 us budget ", rushedStats, runs);
+    std::cout << "    " << rushed.toString() << std::endl;
+    return 0;
+}
+
+/** @return A sample of a normal distribution, by Box-Muller. */
+static double gaussianNoise(double sigma) {
+    double u = (rand() + 1.0) / (RAND_MAX + 2.0), v = rand() / (double)RAND_MAX;
+    return sigma * sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+}
+
+/** Checks KdTree::nearest against a linear search. */
+static int checkKdTree(int count) {
+    std::vector<KdTree::Point> points;
+    for (int i = 0; i < count; i++)
+        points.push_back(KdTree::Point(rand() / (float)RAND_MAX * 10,
+                                       rand() / (float)RAND_MAX * 10, 0, 0));
+    std::vector<KdTree::Point> copy = points;
+    KdTree tree;
+    tree.build(copy);
+
+    int wrong = 0;
+    for (int q = 0; q < 1000; q++) {
+        float x = rand() / (float)RAND_MAX * 10, y = rand() / (float)RAND_MAX * 10;
+        float best = 0.5f * 0.5f;
+        for (int i = 0; i < count; i++) {
+            float dx = points[i].x - x, dy = points[i].y - y;
+            best = std::min(best, dx * dx + dy * dy);
+        }
+        int k = tree.nearest(x, y, 0.5f);
+        float found = 0.5f * 0.5f;
+        if (k >= 0)
+            found = (tree[k].x - x) * (tree[k].x - x) + (tree[k].y - y) * (tree[k].y - y);
+        if (found != best)
+            wrong++;
+    }
+    return wrong;
+}
+
+/** Times filling a Path and consuming it from the front, as PathExecuter
+ *  does, in rounds reusing the same Path.
+ *
+ *  Every position comes with a turn and a move, as a plan from the
+ *  console would have.
+ */
+static int benchPath(int count) {
+    Path path;
+    for (int round = 0; round < 3; round++) {
+        int64_t start = Scheduler::now();
+        path.reset(Position());
+        for (int i = 1; i < count; i++) {
+            path.addMove(Move(M_PI / 2, false));
+            path.addMove(Move(1, true));
+            path.addPosition(Position(i, 0, 0));
+        }
+        int64_t filled = Scheduler::now();
+        int moves = 0;
+        while (path.size() > 0) {
+            while (path.numOfMoves(0) > 0) {
+                path.removeMove();
+                moves++;
+            }
+            path.removePosition(0);
+        }
+        int64_t end = Scheduler::now();
+        if (moves != 2 * (count - 1))
+            return 1;
+        std::cout << "path round " << round << ": " << count << " positions, filled in "
+                  << (filled - start) / (double)count << " ns and consumed in "
+                  << (end - filled) / (double)count << " ns per position" << std::endl;
+    }
+    return 0;
+}
+
+/** Matches scans 0.3 m apart in a corridor too long for the laser to see
+ *  its ends, where nothing fixes the motion along it.
+ *
+ *  @param along, across : Set to the mean error of the matched motion
+ *      along and across the corridor, in meters.
+ *
+ *  @return Number of matches that failed.
+ */
+static int checkCorridor(int count, double& along, double& across) {
+    Map corridor(40, 2, 0.05, Position(0, 0, 0));
+    for (int x = 0; x < corridor.getWidth(); x++) {
+        corridor.setOccupied(x, 0, true);
+        corridor.setOccupied(x, corridor.getHeight() - 1, true);
+    }
+    ScanMatcher matcher;
+    RangerData first, second;
+    makeLaser(first);
+    makeLaser(second);
+
+    int failed = 0;
+    along = across = 0;
+    for (int i = 0; i < count; i++) {
+        Position a(gaussianNoise(1), gaussianNoise(0.2), gaussianNoise(0.1));
+        Position b(a.x + 0.3 * cos(a.yaw), a.y + 0.3 * sin(a.yaw), a.yaw);
+        simulate(corridor, a, first);
+        simulate(corridor, b, second);
+
+        //odometry a little off, mostly along the way
+        Position pose(0.3 + gaussianNoise(0.02), gaussianNoise(0.02),
+                      gaussianNoise(0.02));
+        if (!matcher.matchScans(first, second, pose))
+            failed++;
+        double c = cos(a.yaw), s = sin(a.yaw);
+        double ex = c * pose.x - s * pose.y - 0.3 * c;
+        double ey = s * pose.x + c * pose.y - 0.3 * s;
+        along += fabs(ex) / count;
+        across += fabs(ey) / count;
+    }
+    return failed;
+}
+
+/** Times ICP scan matching between nearby poses.
+ *
+ *  Scan to scan, the odometry guess of the motion between two scans is
+ *  off by 5 cm and 0.05 rad. Scan to map, the pose is off by as much.
+ *  Last, scans are matched in a corridor, see @ref checkCorridor .
+ */
+static int benchMatching(const std::string& world, int count) {
+    Map map;
+    if (!map.loadWorld(world)) {
+        std::cerr << "Failed to load " << world << std::endl;
+        return 1;
+    }
+    map.computeDistance();
+    ScanMatcher matcher;
+    matcher.setMap(map);
+
+    RangerData first, second;
+    makeLaser(first);
+    makeLaser(second);
+    double scanTime = 0, mapTime = 0;
+    double guessError = 0, scanError = 0, mapError = 0, scanYaw = 0, mapYaw = 0;
+    int scanFailed = 0, mapFailed = 0;
+    for (int i = 0; i < count; i++) {
+        Position a = randomPose(map);
+        while (map.getClearance(a) < 0.5)
+            a = randomPose(map);
+        double step = 0.1 + 0.2 * rand() / RAND_MAX, turn = 0.4 * rand() / RAND_MAX - 0.2;
+        Position b(a.x + step * cos(a.yaw), a.y + step * sin(a.yaw), a.yaw + turn);
+        simulate(map, a, first);
+        simulate(map, b, second);
+
+        //scan to scan, from a noisy guess of b in the frame of a
+        Position truth(step, 0, turn);
+        Position pose(truth.x + gaussianNoise(0.05), truth.y + gaussianNoise(0.05),
+                      truth.yaw + gaussianNoise(0.05));
+        guessError += poseError(pose, truth);
+        int64_t start = Scheduler::now();
+        if (!matcher.matchScans(first, second, pose))
+            scanFailed++;
+        scanTime += (Scheduler::now() - start) / 1e9;
+        scanError += poseError(pose, truth);
+        scanYaw += fabs(wrapAngle(pose.yaw - truth.yaw));
+
+        //scan to map, from a noisy pose
+        pose = Position(b.x + gaussianNoise(0.05), b.y + gaussianNoise(0.05),
+                        b.yaw + gaussianNoise(0.05));
+        start = Scheduler::now();
+        if (!matcher.matchMap(second, pose))
+            mapFailed++;
+        mapTime += (Scheduler::now() - start) / 1e9;
+        mapError += poseError(pose, b);
+        mapYaw += fabs(wrapAngle(pose.yaw - b.yaw));
+    }
+
+    std::cout << "icp " << world << ": " << count << " matches of "
+              << LASER_READINGS << " readings" << std::endl << std::fixed
+              << std::setprecision(3) << "  guess error " << guessError / count
+              << " m" << std::endl
+              << "  scan to scan " << scanTime * 1e3 / count << " ms, error "
+              << scanError / count << " m " << scanYaw / count << " rad, "
+              << scanFailed << " failed" << std::endl
+              << "  scan to map  " << mapTime * 1e3 / count << " ms, error "
+              << mapError / count << " m " << mapYaw / count << " rad, "
+              << mapFailed << " failed" << std::endl
+              << "  " << checkKdTree(2000) << " kd-tree queries differ from a linear search"
+              << std::endl;
+
+    double along, across;
+    int failed = checkCorridor(100, along, across);
+    std::cout << "  corridor error " << along << " m along, " << across
+              << " m across, " << failed << " failed" << std::endl;
+    return 0;
+}
+
+/** Fills a map with random rectangular obstacles. */
+static void generate(Map& map, int obstacles) {
+    int w = map.getWidth(), h = map.getHeight();
+    for (int i = 0; i < obstacles; i++) {
+        int x0 = rand() % w, y0 = rand() % h;
+        int x1 = x0 + 1 + rand() % (w / 20), y1 = y0 + 1 + rand() % (h / 20);
+        for (int y = y0; y < y1 && y < h; y++)
+            for (int x = x0; x < x1 && x < w; x++)
+                map.setOccupied(x, y, true);
+    }
+}
+
+/** Picks a random free cell on the map. */
+static void randomCell(const Map& map, int& x, int& y) {
+    do {
+        x = rand() % map.getWidth();
+        y = rand() % map.getHeight();
+    } while (map.isOccupied(x, y) ||
+             (map.hasDistance() &&
+              map.getClearance(x, y) < ROBOT_RADIUS));
+}
+
+/** @return Length of a path of cells, in cells. */
+static double pathLength(const Map& map, const std::vector<int>& path) {
+    double length = 0;
+    for (unsigned int i = 1; i < path.size(); i++)
+        length += path[i] - path[i - 1] == 1 || path[i - 1] - path[i] == 1 ||
+                  path[i] - path[i - 1] == map.getWidth() ||
+                  path[i - 1] - path[i] == map.getWidth() ? 1 : M_SQRT2;
+    return length;
+}
+
+/** Runs every query with one search mode and prints the timings.
+ *
+ *  @param lengths : Set to the path length of every query, -1 if there
+ *      is no path.
+ */
+static void benchQueries(const char* label, GridPlanner::searchMode mode,
+                         const Map& map, const std::vector<int>& queries,
+                         std::vector<double>& lengths) {
+    GridPlanner planner;
+    planner.setMode(mode);
+    planner.setRadius(ROBOT_RADIUS);
+    std::vector<int> path;
+    path.reserve(map.getWidth() * map.getHeight());
+
+    //one query to size the buffers
+    planner.search(map, queries[0], queries[1], queries[2], queries[3], path);
+
+    int count = queries.size() / 4;
+    double seconds = 0, worst = 0;
+    float closest = map.getClearance(queries[0], queries[1]);
+    unsigned long expanded = 0, heapOps = 0;
+    lengths.clear();
+    for (int i = 0; i < count; i++) {
+        const int* q = &queries[i * 4];
+        int64_t start = Scheduler::now();
+        bool found = planner.search(map, q[0], q[1], q[2], q[3], path);
+        double t = (Scheduler::now() - start) / 1e9;
+        seconds += t;
+        if (t > worst)
+            worst = t;
+        expanded += planner.getExpanded();
+        heapOps += planner.getHeapOps();
+        lengths.push_back(found ? pathLength(map, path) : -1);
+        for (unsigned int j = 0; found && j < path.size(); j++)
+            closest = std::min(closest, map.getClearance(path[j] % map.getWidth(),
+                                                         path[j] / map.getWidth()));
+    }
+
+    std::cout << "  " << label << std::fixed << std::setprecision(3)
+              << seconds * 1e3 / count << " ms mean, " << worst * 1e3
+              << " ms worst, " << std::setprecision(0)
+              << expanded / (double)count << " expanded, "
+              << heapOps / (double)count << " heap ops, "
+              << std::setprecision(2) << closest << " m closest to a wall"
+              << std::endl;
+}
+
+/** Times A* and JPS on the same random queries of one map.
+ *
+ *  Paths keep the robot's radius from the walls, so the distance field
+ *  is computed first and only cells that far from a wall are queried.
+ */
+static void benchPlanning(const std::string& name, Map& map, int count) {
+    map.computeDistance();
+
+    //the same queries for every mode
+    std::vector<int> queries(count * 4);
+    for (int i = 0; i < count; i++) {
+        randomCell(map, queries[i * 4], queries[i * 4 + 1]);
+        randomCell(map, queries[i * 4 + 2], queries[i * 4 + 3]);
+    }
+
+    std::vector<double> astar, jps;
+    int found = 0;
+    std::cout << "planning " << name << ": " << map.getWidth() << "x"
+              << map.getHeight() << " cells, " << count << " queries"
+              << std::endl;
+    benchQueries("A*  ", GridPlanner::ASTAR, map, queries, astar);
+    benchQueries("JPS ", GridPlanner::JUMP_POINT, map, queries, jps);
+
+    //both must find equally short paths
+    int mismatched = 0;
+    for (int i = 0; i < count; i++) {
+        if (astar[i] >= 0)
+            found++;
+        if (fabs(astar[i] - jps[i]) > 1e-3)
+            mismatched++;
+    }
+    std::cout << "  " << found << " reachable, " << mismatched
+              << " paths of different length" << std::endl;
+}
+
+/** Blocks or clears a square of free cells, through the log-odds.
+ *
+ *  @param cells : The cells blocked, cleared again if @p block is false.
+ */
+static void obstruct(Map& map, int cx, int cy, int radius, bool block,
+                     std::vector<int>& cells) {
+    if (!block) {
+        for (unsigned int i = 0; i < cells.size(); i++)
+            map.addLogOdds(cells[i] % map.getWidth(), cells[i] / map.getWidth(),
+                           -2 * Map::LOG_ODDS_MAX);
+        cells.clear();
+        return;
+    }
+    for (int y = cy - radius; y <= cy + radius; y++)
+        for (int x = cx - radius; x <= cx + radius; x++)
+            if (map.inBounds(x, y) && !map.isOccupied(x, y)) {
+                map.addLogOdds(x, y, 2 * Map::LOG_ODDS_MAX);
+                cells.push_back(y * map.getWidth() + x);
+            }
+}
+
+/** Times D* Lite repairs against planning again with A*.
+ *
+ *  Every query plans a path, moves the robot a quarter of the way along
+ *  it and drops an obstacle on it halfway, then takes the obstacle away.
+ *  Both changes are repaired with D* Lite and planned from scratch with
+ *  A*, and the path lengths must agree. Both keep the robot's radius from
+ *  the walls, through the distance field updated after every change. When
+ *  the obstacle lands that close to the robot, A* refuses the start and
+ *  D* Lite must lead out of the margin instead.
+ */
+static void benchReplanning(const std::string& name, Map& map, int count) {
+    DStarLite dstar;
+    GridPlanner astar;
+    dstar.setRadius(ROBOT_RADIUS);
+    astar.setRadius(ROBOT_RADIUS);
+    map.computeDistance();
+    std::vector<int> path, changes, blocked;
+    double planTime = 0, repairTime = 0, fullTime = 0;
+    unsigned long planExpanded = 0, repairExpanded = 0, fullExpanded = 0;
+    int queries = 0, repairs = 0, mismatched = 0, inMargin = 0, escaped = 0;
+    map.trackChanges(true);
+
+    while (queries < count) {
+        int sx, sy, gx, gy;
+        randomCell(map, sx, sy);
+        randomCell(map, gx, gy);
+        int64_t start = Scheduler::now();
+        bool found = dstar.plan(map, sx, sy, gx, gy);
+        planTime += (Scheduler::now() - start) / 1e9;
+        planExpanded += dstar.getExpanded();
+        queries++;
+        if (!found || !dstar.getPath(path) || path.size() < 16)
+            continue;
+
+        int w = map.getWidth();
+        int rx = path[path.size() / 4] % w, ry = path[path.size() / 4] / w;
+        int ox = path[path.size() / 2] % w, oy = path[path.size() / 2] / w;
+        for (int step = 0; step < 2; step++) {
+            obstruct(map, ox, oy, 2, step == 0, blocked);
+            map.takeChanges(changes);
+            map.updateDistance();
+
+            start = Scheduler::now();
+            bool repaired = dstar.replan(rx, ry, changes) && dstar.getPath(path);
+            repairTime += (Scheduler::now() - start) / 1e9;
+            repairExpanded += dstar.getExpanded();
+            repairs++;
+            if (map.getClearance(rx, ry) < ROBOT_RADIUS) {
+                //out of the margin, and never back in
+                unsigned int i = 0;
+                while (repaired && i < path.size() &&
+                       map.getClearance(path[i] % w, path[i] / w) < ROBOT_RADIUS)
+                    i++;
+                while (repaired && i < path.size() &&
+                       map.getClearance(path[i] % w, path[i] / w) >= ROBOT_RADIUS)
+                    i++;
+                inMargin++;
+                if (repaired && i == path.size())
+                    escaped++;
+                continue;
+            }
+
+            std::vector<int> full;
+            start = Scheduler::now();
+            astar.search(map, rx, ry, gx, gy, full);
+            fullTime += (Scheduler::now() - start) / 1e9;
+            fullExpanded += astar.getExpanded();
+
+            if (fabs(pathLength(map, path) - pathLength(map, full)) > 1e-3)
+                mismatched++;
+        }
+    }
+    map.trackChanges(false);
+
+    std::cout << "replanning " << name << ": " << map.getWidth() << "x"
+              << map.getHeight() << " cells, " << queries << " plans, "
+              << repairs << " repairs" << std::endl << std::fixed
+              << std::setprecision(3) << "  D* Lite plan   "
+              << planTime * 1e3 / queries << " ms mean, "
+              << std::setprecision(0) << planExpanded / (double)queries
+              << " expanded" << std::endl << std::setprecision(3)
+              << "  D* Lite repair " << repairTime * 1e3 / repairs
+              << " ms mean, " << std::setprecision(0)
+              << repairExpanded / (double)repairs << " expanded" << std::endl
+              << std::setprecision(3) << "  A* replan      "
+              << fullTime * 1e3 / (repairs - inMargin) << " ms mean, "
+              << std::setprecision(0) << fullExpanded / (double)(repairs - inMargin)
+              << " expanded" << std::endl
+              << "  " << mismatched << " paths of different length, " << inMargin
+              << " repairs from inside the margin, " << escaped << " led out"
+              << std::endl;
+}
+
+/** @return Clearance of a cell found by looking at every cell around it. */
+static float bruteClearance(const Map& map, int x, int y, int radius) {
+    int best = radius * radius;
+    for (int j = std::max(y - radius, 0); j <= std::min(y + radius, map.getHeight() - 1); j++)
+        for (int i = std::max(x - radius, 0); i <= std::min(x + radius, map.getWidth() - 1); i++)
+            if (map.isOccupied(i, j))
+                best = std::min(best, (i - x) * (i - x) + (j - y) * (j - y));
+    return sqrt((float)best) * map.getResolution();
+}
+
+/** Counts sampled cells whose clearance differs from brute force. */
+static int checkClearance(const Map& map, int radius, int x0, int y0, int x1, int y1,
+                          int samples) {
+    int wrong = 0;
+    for (int i = 0; i < samples; i++) {
+        int x = std::min(std::max(x0 + rand() % (x1 - x0 + 1), 0), map.getWidth() - 1);
+        int y = std::min(std::max(y0 + rand() % (y1 - y0 + 1), 0), map.getHeight() - 1);
+        if (fabs(map.getClearance(x, y) - bruteClearance(map, x, y, radius)) > 1e-4)
+            wrong++;
+    }
+    return wrong;
+}
+
+/** Times the full distance transform and updates after small changes. */
+static void benchDistance(const std::string& name, Map& map, int count) {
+    const double maxClearance = 2.0;
+    int radius = (int)ceil(maxClearance / map.getResolution());
+
+    int runs = 10;
+    int64_t start = Scheduler::now();
+    for (int i = 0; i < runs; i++)
+        map.computeDistance(maxClearance);
+    double fullTime = (Scheduler::now() - start) / 1e9 / runs;
+    int wrong = checkClearance(map, radius, 0, 0, map.getWidth() - 1,
+                               map.getHeight() - 1, 10000);
+
+    //drop a small obstacle and take it away again
+    std::vector<int> blocked;
+    double updateTime = 0;
+    for (int i = 0; i < count; i++) {
+        int x, y;
+        randomCell(map, x, y);
+        for (int step = 0; step < 2; step++) {
+            obstruct(map, x, y, 2, step == 0, blocked);
+            start = Scheduler::now();
+            map.updateDistance();
+            updateTime += (Scheduler::now() - start) / 1e9;
+            wrong += checkClearance(map, radius, x - 2 * radius, y - 2 * radius,
+                                    x + 2 * radius, y + 2 * radius, 50);
+        }
+    }
+
+    std::cout << "distance " << name << ": " << map.getWidth() << "x"
+              << map.getHeight() << " cells, clearance up to " << maxClearance
+              << " m (" << radius << " cells), "
+              << boost::thread::hardware_concurrency() << " threads" << std::endl
+              << std::fixed << std::setprecision(3) << "  full   "
+              << fullTime * 1e3 << " ms" << std::endl << "  update "
+              << updateTime * 1e3 / (2 * count) << " ms mean after a 5x5 change"
+              << std::endl << "  " << wrong << " wrong of "
+              << 10000 + 100 * count << " sampled cells" << std::endl;
+}
+
+/** Runs one of the benchmarks on a map. */
+static int benchPlanners(const std::string& bench, const std::string& name,
+                         Map& map, int count) {
+    if (bench == "replanning")
+        benchReplanning(name, map, count);
+    else if (bench == "distance")
+        benchDistance(name, map, count);
+    else
+        benchPlanning(name, map, count);
+    return 0;
+}
+
+static void usage(const char* name) {
+    std::cerr << "USAGE:  " << name << " <benchmark> [options]" << std::endl
+              << std::endl << "Where <benchmark> can be:" << std::endl
+              << "  mapping <world> [scans] : log-odds mapping of laser scans"
+              << std::endl
+              << "  planning <world> [queries] : grid planners on a world"
+              << std::endl
+              << "  planning <cells> [queries] : grid planners on a generated"
+              << " <cells>x<cells> map" << std::endl
+              << "  replanning <world|cells> [queries] : D* Lite repairs"
+              << " against A*" << std::endl
+              << "  distance <world|cells> [changes] : distance transform"
+              << std::endl
+              << "  costmap <world> [scans] : layered costmap updates"
+              << std::endl
+              << "  local <world> [scans] : rolling window around the robot"
+              << std::endl
+              << "  localize <world> [particles] [steps] : Monte Carlo localization"
+              << std::endl
+              << "  icp <world> [matches] : scan matching"
+              << std::endl
+              << "  vfh <world> [runs] [steps] : VFH+ steering towards goals"
+              << std::endl
+              << "  dwa <world> [runs] [steps] : Dynamic Window Approach"
+              << std::endl
+              << "  track <world> [paths] : pure pursuit and MPC against"
+              << " stopping at every position" << std::endl
+              << "  path [positions] : filling and consuming a Path"
+              << std::endl;
+}
+
+int main(int argc, char** argv) {
+    Logger::start("bench");
+    srand(1);
+
+    int result = 1;
+    std::string name = argc > 1 ? argv[1] : "";
+    if (name == "mapping" && argc > 2)
+        result = benchMapping(argv[2], argc > 3 ? atoi(argv[3]) : 1000);
+    else if (name == "costmap" && argc > 2)
+        result = benchCostmap(argv[2], argc > 3 ? atoi(argv[3]) : 1000);
+    else if (name == "local" && argc > 2)
+        result = benchLocal(argv[2], argc > 3 ? atoi(argv[3]) : 1000);
+    else if (name == "icp" && argc > 2)
+        result = benchMatching(argv[2], argc > 3 ? atoi(argv[3]) : 1000);
+    else if (name == "vfh" && argc > 2)
+        result = benchSteering(argv[2], argc > 3 ? atoi(argv[3]) : 100,
+                               argc > 4 ? atoi(argv[4]) : 600);
+    else if (name == "dwa" && argc > 2)
+        result = benchDynamicWindow(argv[2], argc > 3 ? atoi(argv[3]) : 100,
+                                    argc > 4 ? atoi(argv[4]) : 600);
+    else if (name == "track" && argc > 2)
+        result = benchTracking(argv[2], argc > 3 ? atoi(argv[3]) : 100);
+    else if (name == "path")
+        result = benchPath(argc > 2 ? atoi(argv[2]) : 100000);
+    else if (name == "localize" && argc > 2)
+        result = benchLocalize(argv[2], argc > 3 ? atoi(argv[3]) : 5000,
+                               argc > 4 ? atoi(argv[4]) : 500);
+    else if ((name == "planning" || name == "replanning" || name == "distance")
+             && argc > 2) {
+        int count = argc > 3 ? atoi(argv[3]) : 100;
+        int cells = atoi(argv[2]);
+        if (cells > 0) {
+            Map map(cells * 0.05, cells * 0.05, 0.05);
+            generate(map, cells * cells / 2000);
+            result = benchPlanners(name, argv[2], map, count);
+        }
+        else {
+            Map map;
+            if (map.loadWorld(argv[2]))
+                result = benchPlanners(name, argv[2], map, count);
+        }
+    }
+    else
+        usage(argv[0]);
+
+    Logger::stop();
+    return result;
+}
@@ -12,13 +12,15 @@ uint         gDebug(0);
 uint         gFrequency(10); // Hz
 uint         gDataMode(PLAYER_DATAMODE_PUSH);
 bool         gUseLaser(false);
+bool         gPipelined(false);
+bool         gEventDriven(false);
 
 void print_usage(int argc, char** argv);
 
 int parse_args(int argc, char** argv)
 {
   // set the flags
-  const char* optflags = "h:p:i:d:u:lm:";
+  const char* optflags = "h:p:i:d:u:lm:te";
   int ch;
 
   // use getopt to parse the flags
@@ -48,6 +50,12 @@ int parse_args(int argc, char** argv)
       case 'l': // datamode
           gUseLaser = true;
           break;
+      case 't': // threaded pipeline
+          gPipelined = true;
+          break;
+      case 'e': // event-driven loop
+          gEventDriven = true;
+          break;
       case '?': // help
       case ':':
       default:  // unknown
@@ -72,10 +80,14 @@ void print_usage(int argc, char** argv)
        << endl;
   cerr << "  -d <level>     : debug message level (0 = none -- 9 = all)"
        << endl;
-  cerr << "  -u <rate>      : set server update rate to <rate> in Hz"
+  cerr << "  -u <rate>      : set robot update rate to <rate> in Hz"
        << endl;
   cerr << "  -l      : Use laser if applicable"
        << endl;
+  cerr << "  -t      : Run sensing, control and actuation on separate threads"
+       << endl;
+  cerr << "  -e      : Run the controller only when Player sends fresh data"
+       << endl;
   cerr << "  -m <datamode>  : set server data delivery mode"
        << endl;
   cerr << "                      PLAYER_DATAMODE_PUSH = "
@@ -1,8 +1,16 @@
 #include "braitenberg.h"
+#include <math.h>
+#include <float.h>
 #include <sstream>
+#include <algorithm>
 
 CREATE_LOGGER("Braitenberg");
 
+/** Readings further off the heading than this are not seen, in radians.
+ *  The ring's side sonars at 90 degrees still count.
+ */
+static const double SIDE_ANGLE = M_PI / 2 + 0.01;
+
 Braitenberg::Braitenberg(Motor& m) : Controller(m) {
     motor = &m;
     config = A;
@@ -15,8 +23,18 @@ Braitenberg::~Braitenberg() {
 }
 
 void Braitenberg::update() {
-    double leftRange = data.range[0];
-    double rightRange = data.range[1];
+    //closest reading ahead on each side, by bearing as the rangers are
+    //not in side order; one straight ahead counts for both
+    const Scan& scan = data->scan;
+    double leftRange = FLT_MAX, rightRange = FLT_MAX;
+    for (unsigned int i = 0; i < scan.size; i++) {
+        if (fabs(scan.angle[i]) > SIDE_ANGLE)
+            continue;
+        if (scan.angle[i] >= 0)
+            leftRange = std::min(leftRange, (double)scan.range[i]);
+        if (scan.angle[i] <= 0)
+            rightRange = std::min(rightRange, (double)scan.range[i]);
+    }
     double leftSpeed, rightSpeed;
 
     switch (config) {
@@ -107,7 +125,7 @@ void Braitenberg::executeCommand(const Command cmd) {
     }
 }
 
-void Braitenberg::setRangerData(RangerData data) {
+void Braitenberg::setRangerData(RangerSnapshot data) {
     this->data = data;
 }
 
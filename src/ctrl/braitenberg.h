@@ -62,7 +62,7 @@ class Braitenberg : public Controller {
          *
          *  @param data : The latest RangerData.
          */
-        void setRangerData(RangerData data);
+        void setRangerData(RangerSnapshot data);
 
         /** Executes a Command from the Console.
          *
@@ -84,7 +84,7 @@ class Braitenberg : public Controller {
         braitenBehave behaviour;
 
         /** Latest ranger data. */
-        RangerData data;
+        RangerSnapshot data;
 
         /** Reference to robot motor. */
         Motor* motor;
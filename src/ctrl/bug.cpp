@@ -40,11 +40,17 @@ bool Bug::bug2(Position goal) {
     return isArrived;
 }
 
-void Bug::setRangerData(RangerData data) {
+void Bug::setRangerData(RangerSnapshot data) {
     wf.setRangerData(data);
     od.setRangerData(data);
 }
 
+void Bug::setLocalCostmap(const LocalCostmap& costmap) {
+    wf.setLocalCostmap(costmap);
+    od.setCostmap(&costmap);
+    nav.setLocalCostmap(&costmap);
+}
+
 void Bug::youAreHere(Position pos) {
     robotPos = pos;
     pe.setLocal(pos);
@@ -64,7 +64,13 @@ class Bug : public Controller {
          *
          *  @param data : The lastest RangerData.
          */
-        void setRangerData(RangerData data);
+        void setRangerData(RangerSnapshot data);
+
+        /** Passes the costmap to the internal wall-follower as well.
+         *
+         *  @param costmap : The costmap, owned by the Robot.
+         */
+        void setLocalCostmap(const LocalCostmap& costmap);
 
         /** Sets the latest Position of the robot.
          *
@@ -3,6 +3,8 @@
 CREATE_LOGGER("Controller");
 
 Controller::Controller(Motor& m) : pe(m), oa(m) {
+    map = NULL;
+    pe.setNavigation(nav);
     LOG_CTOR << "Constructed." << std::endl;
 }
 
@@ -10,19 +12,35 @@ Controller::~Controller() {
     LOG_DTOR << "Destructed." << std::endl;
 }
 
-void Controller::setRangerData(RangerData data) {
+void Controller::setRangerData(RangerSnapshot data) {
     od.setRangerData(data);
+    oa.setRangerData(data);
 }
 
-void Controller::setRangerData(RangerData *data) {
-    if (data != NULL) {
-        //Use first ranger only
-        setRangerData(data[0]);
+void Controller::setRangerData(const std::vector<RangerSnapshot>& data) {
+    RangerSnapshot primary;
+    for (unsigned int i = 0; i < data.size(); i++) {
+        if (data[i]->type == LASER)
+            setLaserData(data[i]);
+        else if (!primary)
+            primary = data[i];
     }
+
+    //robot without sonars, lasers are all there is
+    if (!primary && !data.empty())
+        primary = data[0];
+
+    if (primary)
+        setRangerData(primary);
     else
         MAKE_LOG << "No ranger data passed!" << std::endl;
 }
 
+void Controller::setLaserData(RangerSnapshot data) {
+    od.setLaserData(data);
+    oa.setLaserData(data);
+}
+
 void Controller::update() {
     //a brain-dead robot.
 }
@@ -31,6 +49,15 @@ void Controller::setMotor(Motor& m) {
     pe.setMotor(m);
 }
 
+void Controller::setMap(Map& m) {
+    map = &m;
+}
+
+void Controller::setLocalCostmap(const LocalCostmap& costmap) {
+    od.setCostmap(&costmap);
+    nav.setLocalCostmap(&costmap);
+}
+
 void Controller::youAreHere(Position pos) {
     //Brain-dead robot doesn't care.
 }
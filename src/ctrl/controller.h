@@ -13,6 +13,8 @@
 #include "plan/navigation.h"
 #include "plan/pathexecuter.h"
 #include "plan/pathplanner.h"
+#include "plan/map.h"
+#include "plan/localcostmap.h"
 #include "objt/objectdetector.h"
 #include "objt/objectavoider.h"
 #include "data/rangerdata.h"
@@ -54,21 +56,29 @@ class Controller : public CommandExecuter, public Module {
          *  Distributes the data to the relevant sub-classes, such as
          *  Navigation and ObjectAvoider.
          *
-         *  @param data : A RangerData struct.
+         *  @param data : Shared snapshot of the readings of one ranger.
          */
-        virtual void setRangerData(RangerData data);
+        virtual void setRangerData(RangerSnapshot data);
 
         /** Takes new relavent ranger data for multiple rangers.
          *
          *  Distributes the data from the various rangers to the relevant
-         *  sub-classes.
+         *  sub-classes. Laser data goes to @ref setLaserData and the first
+         *  other ranger goes to @ref setRangerData ; if the robot only has
+         *  lasers the first one is used for both.
          *
-         *  @note For the purposes of this basic Controller, only the first
-         *      ranger in the array is utilized.
+         *  @param data : Snapshots, one per ranger.
+         */
+        virtual void setRangerData(const std::vector<RangerSnapshot>& data);
+
+        /** Takes new laser data.
+         *
+         *  By default the laser is only used by the ObjectDetector and
+         *  the ObjectAvoider.
          *
-         *  @param data : An array of RangerData structs.
+         *  @param data : Shared snapshot of the laser readings.
          */
-        virtual void setRangerData(RangerData *data);
+        virtual void setLaserData(RangerSnapshot data);
 
         /** Updates controller actions.
          *
@@ -102,6 +112,21 @@ class Controller : public CommandExecuter, public Module {
          */
         virtual void youAreHere(Position pos);
 
+        /** Gives the controller a map of the world to plan on.
+         *
+         *  @param map : The map, owned by the Robot.
+         */
+        virtual void setMap(Map& map);
+
+        /** Gives the controller the obstacles around the robot.
+         *
+         *  By default the costmap is used by the ObjectDetector and by
+         *  Navigation to steer the PathExecuter between positions.
+         *
+         *  @param costmap : The costmap, owned by the Robot.
+         */
+        virtual void setLocalCostmap(const LocalCostmap& costmap);
+
         /** Returns information on this Controller.
          *
          *  @return String representation of this Controller.
@@ -131,6 +156,9 @@ class Controller : public CommandExecuter, public Module {
         /** PathExecuter. */
         PathExecuter pe;
 
+        /** Map of the world, NULL if there is none. */
+        Map* map;
+
     private:
 
     /** Disable copy constructor. */
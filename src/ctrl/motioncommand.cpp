@@ -1,5 +1,7 @@
 #include "motioncommand.h"
 #include <sstream>
+#include <algorithm>
+#include "util/scheduler.h"
 
 CREATE_LOGGER("MotionCommand");
 
@@ -7,27 +9,92 @@ MotionCommand::MotionCommand(Motor& m) : Controller(m), bug(m) {
     planning = false;
     isBug2 = false;
     doingAlg = false;
+    replanning = false;
+    reachable = false;
+    replanner.setRadius(ROBOT_RADIUS);
     LOG_CTOR << "Constructed." << std::endl;
 }
 
 MotionCommand::~MotionCommand() {
+    stopReplanning();
     LOG_DTOR << "Destructed." << std::endl;
 }
 
 void MotionCommand::update() {
+    Position target;
+    if (replanning) {
+        if (!replan())
+            pe.halt(); //wait for a way through to open up
+        else if (od.check() && pe.getTarget(target))
+            oa.avoid(target); //too close to something not yet on the map
+        else if (pe.execute())
+            stopReplanning(); //arrived
+        return;
+    }
+
     if (od.check() || doingAlg) //check for near obstacles
 	    if (isBug2) {
             doingAlg = true;
             if (bug.bug2(goal))
                 doingAlg = false; //finished bug2 algorithm
         }
+        else if (pe.getTarget(target))
+            oa.avoid(target); //steer around towards the next position
         else
             pe.halt();
     else
         pe.execute();
 }
 
+bool MotionCommand::replan() {
+    map->takeChanges(changes);
+    if (changes.empty())
+        return reachable;
+
+    int x, y;
+    if (!map->worldToGrid(robotPos.x, robotPos.y, x, y)) {
+        MAKE_LOG << "Robot is off the map, path given up." << std::endl;
+        stopReplanning();
+        pe.abandonPath();
+        return false;
+    }
+    bool wasReachable = reachable;
+    int64_t start = Scheduler::now();
+    reachable = replanner.replan(x, y, changes) && replanner.getPath(repaired);
+    LOG_DEBUG << changes.size() << " cells changed, repair expanded "
+              << replanner.getExpanded() << " cells in "
+              << (Scheduler::now() - start) / 1e6 << " ms." << std::endl;
+    if (!reachable) {
+        if (wasReachable)
+            MAKE_LOG << "Goal cut off, waiting." << std::endl;
+        return false;
+    }
+
+    //keep the current path unless the rest of it changed
+    std::vector<int>::iterator at = std::find(cells.begin(), cells.end(), repaired[0]);
+    if (at != cells.end() && cells.end() - at == (long)repaired.size() &&
+        std::equal(repaired.begin(), repaired.end(), at))
+        return true;
+
+    cells.swap(repaired);
+    PathPlanner::toPath(*map, cells, robotPos, goal, path);
+    pe.setPath(path);
+    MAKE_LOG << "Path repaired around new obstacles." << std::endl;
+    return true;
+}
+
+void MotionCommand::stopReplanning() {
+    if (replanning)
+        map->trackChanges(false);
+    replanning = false;
+}
+
 void MotionCommand::executeCommand(const Command cmd) {
+    //any new motion command replaces the path on the map
+    if (cmd.name == move || cmd.name == turn || cmd.name == gt ||
+        cmd.name == endplan)
+        stopReplanning();
+
     switch(cmd.name){
         case move:
             if (cmd.arg.size() >= 2) {
@@ -41,13 +108,13 @@ void MotionCommand::executeCommand(const Command cmd) {
                 goal = PathPlanner::calcPosition(robotPos, distance);
 
                 if (planning) {
-                    plannedPath->addMove(Move(distance, true));
+                    plannedPath.addMove(Move(distance, true));
                     MAKE_LOG << "Added move to the plan." << std::endl;
                 }
                 else {
-                    Path* path = new Path(robotPos);
-                    path->addMove(Move(distance, true));
-                    pe.setPath(*path);
+                    path.reset(robotPos);
+                    path.addMove(Move(distance, true));
+                    pe.setPath(path);
                     MAKE_LOG << "Moving "<< distance << " meters." << std::endl;
                 }
             }
@@ -62,13 +129,13 @@ void MotionCommand::executeCommand(const Command cmd) {
                 //convert to radians
                 yaw = yaw * (M_PI/180);
                 if (planning) {
-                    plannedPath->addMove(Move(yaw, false));
+                    plannedPath.addMove(Move(yaw, false));
                     MAKE_LOG << "Added turn to the plan." << std::endl;
                 }
                 else {
-                    Path* path = new Path(robotPos);
-                    path->addMove(Move(yaw, false));
-                    pe.setPath(*path);
+                    path.reset(robotPos);
+                    path.addMove(Move(yaw, false));
+                    pe.setPath(path);
                     MAKE_LOG << "Turning " << cmd.arg[1] << " degrees." << std::endl;
                 }
             }
@@ -83,13 +150,35 @@ void MotionCommand::executeCommand(const Command cmd) {
                 goal.yaw = (M_PI/180)*std::strtod(cmd.arg[3].c_str(), NULL);
 
                 if (planning) {
-                    plannedPath->addPosition(goal);
+                    plannedPath.addPosition(goal);
                     MAKE_LOG << "Added goto to the plan." << std::endl;
                 }
+                else if (map != NULL) {
+                    //plan around the obstacles on the map, repaired as the
+                    //rangers find new ones
+                    int sx, sy, gx, gy;
+                    if (!map->worldToGrid(robotPos.x, robotPos.y, sx, sy) ||
+                        !map->worldToGrid(goal.x, goal.y, gx, gy)) {
+                        TO_CONSOLE("That position or the robot is off the map.");
+                        break;
+                    }
+                    if (!replanner.plan(*map, sx, sy, gx, gy) ||
+                        !replanner.getPath(cells)) {
+                        TO_CONSOLE("No path to that position.");
+                        break;
+                    }
+                    PathPlanner::toPath(*map, cells, robotPos, goal, path);
+                    pe.setPath(path);
+                    map->trackChanges(true);
+                    replanning = true;
+                    reachable = true;
+                    MAKE_LOG << "Planned path to (" << cmd.arg[1] << ", "
+                    << cmd.arg[2] << ") with " << path.size() << " positions." << std::endl;
+                }
                 else {
-                    Path* path = new Path();
-                    path->addPosition(goal);
-                    pe.setPath(*path);
+                    path.clear();
+                    path.addPosition(goal);
+                    pe.setPath(path);
                     MAKE_LOG << "Going to position (" << cmd.arg[1] << ", "
                     << cmd.arg[2] << ", " << cmd.arg[3] << ")" << std::endl;
                 }
@@ -100,14 +189,26 @@ void MotionCommand::executeCommand(const Command cmd) {
 
         case plan:
             planning = true;
-            plannedPath = new Path(robotPos);
+            plannedPath.reset(robotPos);
             break;
 
         case endplan:
-            pe.setPath(*plannedPath);
+            if (planning)
+                pe.setPath(plannedPath);
             planning = false;
             break;
 
+        case track:
+            if (cmd.arg.size() >= 2 && (cmd.arg[1] == "on" || cmd.arg[1] == "mpc")) {
+                pe.setTracking(true);
+                pe.setPredictive(cmd.arg[1] == "mpc");
+            }
+            else if (cmd.arg.size() >= 2 && cmd.arg[1] == "off")
+                pe.setTracking(false);
+            else
+                TO_CONSOLE("usage: track state, state={'on', 'mpc' or 'off'}");
+            break;
+
 		case bug2:
 			if (cmd.arg.size() >= 2) {
 				if (cmd.arg[1] == "on")
@@ -129,14 +230,22 @@ void MotionCommand::executeCommand(const Command cmd) {
 void MotionCommand::youAreHere(Position p) {
     robotPos = p;
     pe.setLocal(p);
+    oa.setLocal(p);
     bug.youAreHere(p);
 }
 
-void MotionCommand::setRangerData(RangerData data) {
+void MotionCommand::setRangerData(RangerSnapshot data) {
     od.setRangerData(data);
+    oa.setRangerData(data);
     bug.setRangerData(data);
 }
 
+void MotionCommand::setLocalCostmap(const LocalCostmap& costmap) {
+    od.setCostmap(&costmap);
+    nav.setLocalCostmap(&costmap);
+    bug.setLocalCostmap(costmap);
+}
+
 std::string MotionCommand::toString() {
-    return "MotionCommand Controller";
+    return "MotionCommand Controller, " + pe.toString();
 }
@@ -8,8 +8,10 @@
 #ifndef __CTRL_MOTIONCOMMAND_H_
 #define __CTRL_MOTIONCOMMAND_H_
 
+#include <vector>
 #include "controller.h"
 #include "bug.h"
+#include "plan/dstarlite.h"
 
 class MotionCommand : public Controller {
     public:
@@ -29,6 +31,13 @@ class MotionCommand : public Controller {
          *
          *  This function first checks for obstacles using ObjectDetector,
          *  followed by a continued execution by PathExecuter.
+         *
+         *  While following a path planned on the map, obstacles are not
+         *  stopped for. The rangers have already added them to the map, so
+         *  the path is repaired around them with D* Lite and the robot
+         *  keeps moving. Only an obstacle the ObjectDetector finds too
+         *  close, one the map has not caught up with, is steered around
+         *  by the ObjectAvoider. It only halts while no path is left.
          */
         virtual void update();
 
@@ -48,11 +57,18 @@ class MotionCommand : public Controller {
 
         /** Sets the latest RangerData.
          *
-         *  Ranger data is passed on to ObjectDetector and the Bug controller.
+         *  Ranger data is passed on to ObjectDetector, ObjectAvoider and the
+         *  Bug controller.
          *
          *  @param data : Latest RangerData to be used.
          */
-        void setRangerData(RangerData data);
+        void setRangerData(RangerSnapshot data);
+
+        /** Passes the costmap to ObjectDetector and the Bug controller.
+         *
+         *  @param costmap : The costmap, owned by the Robot.
+         */
+        void setLocalCostmap(const LocalCostmap& costmap);
 
         /** String representation of this Controller. */
         virtual std::string toString();
@@ -68,7 +84,10 @@ class MotionCommand : public Controller {
     private:
 
         /** Stores a more complex path with more than one motion command. */
-        Path* plannedPath;
+        Path plannedPath;
+
+        /** Paths handed to the PathExecuter, reused for each command. */
+        Path path;
 
         /** The goal position for the last motion command. */
         Position goal;
@@ -82,6 +101,30 @@ class MotionCommand : public Controller {
         /** Determines if controller is finished completing an algorithm. */
         bool doingAlg;
 
+        /** Keeps the path to the goal on the map up to date. */
+        DStarLite replanner;
+
+        /** True while following a path kept up to date by the replanner. */
+        bool replanning;
+
+        /** True if the replanner has a path to the goal. */
+        bool reachable;
+
+        /** Cells of the path being followed, as y*width+x. */
+        std::vector<int> cells;
+
+        /** Map cells that changed since the last tick, and the new path. */
+        std::vector<int> changes, repaired;
+
+        /** Repairs the path if the map changed since the last tick.
+         *
+         *  @return False if the goal cannot be reached.
+         */
+        bool replan();
+
+        /** Stops keeping the path up to date. */
+        void stopReplanning();
+
         /** Disable copy constructor. */
         MotionCommand(const MotionCommand& source);
 
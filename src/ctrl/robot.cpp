@@ -1,18 +1,33 @@
 #include "robot.h"
+#include "actr/queuedmotor.h"
 
 CREATE_LOGGER("Robot");
 
 
 Robot::Robot( PlayerCc::PlayerClient &robot,
               PlayerCc::RangerProxy &rangerProxy,
-              PlayerCc::Position2dProxy &positionProxy
-            ) {
+              PlayerCc::Position2dProxy &positionProxy,
+              double frequency,
+              loopMode mode,
+              unsigned int dataMode
+            ) : scheduler(frequency) {
     //initialize variables
     ranger.push_back(new Ranger(rangerProxy));
-    motor = new Motor(positionProxy);
+    if (mode == PIPELINED)
+        motor = new QueuedMotor(positionProxy);
+    else
+        motor = new Motor(positionProxy);
+    this->mode = mode;
+    this->dataMode = dataMode;
+    running = false;
+    droppedPercepts = 0;
     local = new Local(positionProxy);
+    map = NULL;
+    mapper = NULL;
+    localizer = NULL;
     player = &robot;
     controller = new Controller(*motor);
+    controller->setLocalCostmap(localCostmap);
     power = false;
 
     //pass console to logger for "in-console" logging
@@ -20,7 +35,7 @@ Robot::Robot( PlayerCc::PlayerClient &robot,
     LOG_CTOR << "Constructed." << std::endl;
 }
 
-Robot::Robot() {
+Robot::Robot() : scheduler(10) {
     PlayerCc::PlayerClient player(PlayerCc::PLAYER_HOSTNAME, PlayerCc::PLAYER_PORTNUM);
 
     //create ranger and motor classes
@@ -42,8 +57,16 @@ Robot::Robot() {
     ranger.push_back(new Ranger(rangerProxy1));
     ranger.push_back(new Ranger(rangerProxy2));
     local = new Local(positionProxy);
+    map = NULL;
+    mapper = NULL;
+    localizer = NULL;
     controller = new Controller(*motor);
+    controller->setLocalCostmap(localCostmap);
     power = false;
+    mode = SERIAL;
+    dataMode = PLAYER_DATAMODE_PUSH;
+    running = false;
+    droppedPercepts = 0;
 
     Logger::setConsole(console);
     LOG_CTOR << "Constructed." << std::endl;
@@ -53,6 +76,8 @@ Robot::~Robot() {
     delete controller;
     delete motor;
     delete local;
+    delete mapper;
+    delete localizer;
 /*
     Ranger** sen = ranger.c_array();
     for (int i = 0; i < ranger.size(); i++) {
@@ -66,61 +91,238 @@ void Robot::addRanger(Ranger& ranger) {
     this->ranger.push_back(&ranger);
 }
 
+void Robot::setMap(Map& map) {
+    this->map = &map;
+    map.computeDistance();
+    controller->setMap(map);
+    delete mapper;
+    mapper = new Mapper(map);
+
+    delete localizer;
+    localizer = new Localizer(map);
+}
+
 void Robot::setController(Controller& control) {
     this->controller = &control;
+    controller->setLocalCostmap(localCostmap);
 }
 
 void Robot::run() {
-    bool continueOperation = true;
+    MAKE_LOG << "Enter superloop at " << scheduler.getFrequency() << " Hz!" << std::endl;
+
+    //terminal I/O runs on its own thread
+    console.start();
 
-    MAKE_LOG << "Enter superloop!" << std::endl;
+    switch (mode) {
+        case PIPELINED:
+            runPipelined();
+            break;
+        case EVENT_DRIVEN:
+            runEventDriven();
+            break;
+        default:
+            runSerial();
+            break;
+    }
+
+    console.stop();
+    MAKE_LOG << scheduler.toString() << std::endl;
+} //end run
+
+void Robot::runSerial() {
+    bool continueOperation = true;
+    Percept percept;
+    scheduler.start();
 
     //enter superloop
     while(continueOperation) {
-        //update console
-        continueOperation = console.update();
-
-        //check for new command
-        if (console.isNewCommand()) {
-            //get new command
-            Command cmd = console.getCommand();
-            //execute command
-            executeCommand(cmd);
-        }
+        //execute new commands from the console
+        continueOperation = updateConsole();
 
         //get update from Player/Stage
         player->Read();
 
-        int size = ranger.size();
+        //read rangers and local, pass to controller
+        sense(percept);
+        think(percept);
 
-        //read ranger data and pass to controller
-        if (size == 1) {
-            RangerData data = ranger[0].getData();
+        //wait for the next tick
+        scheduler.sleep();
+    } //end superloop
+} //end runSerial
 
-            //pass data to controller
-            controller->setRangerData(data);
-        }
-        else { //multiple rangers
-            RangerData data[size];
-            //initialize array
-            for (int i = 0; i < size; i++)
-                data[i] = ranger[i].getData();
+void Robot::runPipelined() {
+    bool continueOperation = true;
+    Percept percept;
+
+    //start acquisition and actuation stages
+    running = true;
+    boost::thread acquisition(&Robot::acquire, this);
+    boost::thread actuation(&Robot::actuate, this);
+    MAKE_LOG << "Pipeline started." << std::endl;
+
+    scheduler.start();
+
+    //controller stage
+    while(continueOperation) {
+        //execute new commands from the console
+        continueOperation = updateConsole();
+
+        //only the newest percept matters, skip any older ones
+        bool fresh = false;
+        while (percepts.pop(percept))
+            fresh = true;
+
+        if (fresh)
+            think(percept);
+        else if (power && !percept.ranger.empty())
+            controller->update(); //keep acting on the last readings
+
+        //wait for the next tick
+        scheduler.sleep();
+    } //end superloop
+
+    //stop acquisition and actuation stages
+    running = false;
+    acquisition.join();
+    actuation.join();
+    MAKE_LOG << "Pipeline stopped, " << droppedPercepts
+             << " percepts dropped." << std::endl;
+} //end runPipelined
+
+void Robot::runEventDriven() {
+    bool continueOperation = true;
+    bool requested = false;
+    unsigned long events = 0, idle = 0;
+    Percept percept;
 
-            //pass data to controller
-            controller->setRangerData(data);
-        } //end pass ranger data
+    //wait at most one period so console commands are still executed
+    int timeout = (int)(1000.0 / scheduler.getFrequency());
+    scheduler.start();
 
-        //pass local
-        controller->youAreHere(local->getLocal());
+    while(continueOperation) {
+        //execute new commands from the console
+        continueOperation = updateConsole();
+
+        //in pull mode the server only sends data when asked for it
+        if (dataMode == PLAYER_DATAMODE_PULL && !requested) {
+            player->RequestData();
+            requested = true;
+        }
+
+        //sleep until the Player socket has something for us
+        if (!player->Peek(timeout)) {
+            idle++;
+            continue;
+        }
+        player->Read();
+        requested = false;
 
-        //if power is off skip controller update.
-        if (!power)
+        //ignore messages that carry no new readings
+        if (!isFresh())
             continue;
 
-        //update controller
-        controller->update();
+        //each event is a tick, timed but not paced
+        events++;
+        scheduler.beginTick();
+        sense(percept);
+        think(percept);
+        scheduler.endTick();
     } //end superloop
-} //end run
+
+    MAKE_LOG << "Event loop handled " << events << " updates, "
+             << idle << " idle timeouts." << std::endl;
+} //end runEventDriven
+
+bool Robot::isFresh() {
+    if (local->isFresh())
+        return true;
+    for (unsigned int i = 0; i < ranger.size(); i++)
+        if (ranger[i].isFresh())
+            return true;
+    return false;
+} //end isFresh
+
+void Robot::acquire() {
+    Percept percept;
+    while (running) {
+        //blocks until Player has new data
+        player->Read();
+        sense(percept);
+        if (!percepts.push(percept))
+            droppedPercepts++; //controller stage is falling behind
+    }
+} //end acquire
+
+void Robot::actuate() {
+    QueuedMotor* queued = static_cast<QueuedMotor*>(motor);
+    while (running)
+        queued->apply(100);
+
+    //send whatever is left, ie. the final halt
+    while (queued->apply(0))
+        ;
+} //end actuate
+
+bool Robot::updateConsole() {
+    //execute every command issued since the last tick, never blocks
+    Command cmd;
+    while (console.getCommand(cmd))
+        executeCommand(cmd);
+
+    //false once the exit command was received
+    return console.isRunning();
+} //end updateConsole
+
+void Robot::sense(Percept& percept) {
+    percept.ranger.resize(ranger.size());
+    int laser = -1;
+    for (unsigned int i = 0; i < ranger.size(); i++) {
+        bool fresh = ranger[i].isFresh();
+        percept.ranger[i] = ranger[i].getData();
+        if (laser < 0 && fresh && percept.ranger[i]->type == LASER)
+            laser = i;
+    }
+
+    //odometry corrected by a new laser scan, if there is one
+    if (laser >= 0)
+        percept.position = local->getLocal(*percept.ranger[laser]);
+    else
+        percept.position = local->getLocal();
+} //end sense
+
+void Robot::think(Percept& percept) {
+    //correct the odometry on the map, by the laser if there is one
+    if (localizer != NULL && !percept.ranger.empty()) {
+        unsigned int scan = 0;
+        for (unsigned int i = 0; i < percept.ranger.size(); i++)
+            if (percept.ranger[i]->type == LASER) {
+                scan = i;
+                break;
+            }
+        percept.position = localizer->update(percept.position, *percept.ranger[scan]);
+    }
+
+    //add every scan to the map
+    if (mapper != NULL)
+        for (unsigned int i = 0; i < percept.ranger.size(); i++)
+            mapper->update(*percept.ranger[i], percept.position);
+
+    //slide the window of local obstacles along and fill it in
+    localCostmap.youAreHere(percept.position);
+    for (unsigned int i = 0; i < percept.ranger.size(); i++)
+        localCostmap.addScan(*percept.ranger[i]);
+
+    //pass ranger data to controller
+    controller->setRangerData(percept.ranger);
+
+    //pass local
+    controller->youAreHere(percept.position);
+
+    //update controller, unless power is off
+    if (power)
+        controller->update();
+} //end think
 
 void Robot::executeCommand(const Command command) {
 /*  MAKE_LOG << "Num of Args: " << command.arg.size() << std::endl;
@@ -180,8 +382,35 @@ void Robot::executeCommand(const Command command) {
             delete controller;
             //assign new controller
             controller = newController;
+            controller->setLocalCostmap(localCostmap);
+            if (map != NULL)
+                controller->setMap(*map);
             break;
 
+        case stats:
+            TO_CONSOLE(scheduler.toString());
+            if (mapper != NULL)
+                TO_CONSOLE(mapper->toString());
+            if (localizer != NULL)
+                TO_CONSOLE(localizer->toString());
+            TO_CONSOLE(localCostmap.toString());
+            TO_CONSOLE(controller->toString());
+            break;
+
+        case loglevel: {
+            //change how much a module logs
+            logLevel level;
+            if (command.arg.size() < 3 || !Logger::parseLevel(command.arg[2], level)) {
+                TO_CONSOLE("usage: loglevel <module|all> <debug|info|warn|error|off>");
+                break;
+            }
+            if (Logger::setLevel(command.arg[1], level))
+                TO_CONSOLE("Log level of " + command.arg[1] + " set to " + command.arg[2] + ".");
+            else
+                TO_CONSOLE("No such module: " + command.arg[1]);
+            break;
+        }
+
         case NAC:
             //do nothing
             TO_CONSOLE("That's not a Command.");
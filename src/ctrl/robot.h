@@ -10,6 +10,9 @@
 
 #include <libplayerc++/playerc++.h>
 #include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
+#include <boost/thread.hpp>
+#include <boost/atomic.hpp>
 #include <vector>
 #include "controller.h"
 #include "motioncommand.h"
@@ -22,9 +25,22 @@
 #include "snsr/ranger.h"
 #include "hrio/console.h"
 #include "plan/local.h"
+#include "plan/map.h"
+#include "plan/mapper.h"
+#include "plan/localcostmap.h"
+#include "plan/localizer.h"
+#include "util/scheduler.h"
+#include "data/percept.h"
 
 class Motor;
 
+/** How the superloop is driven. */
+enum loopMode {
+    SERIAL,         //all stages on one thread at a fixed rate
+    PIPELINED,      //sense, think and act on separate threads
+    EVENT_DRIVEN    //one tick per batch of fresh Player data
+};
+
 /** The top-level class that contains all modules required to run a robot.
  *
  *  Used to initialize "lower-level" modules (parts) of the robot. Modules,
@@ -38,6 +54,19 @@ class Motor;
  *
  *  Currently, the player/stage library is implemented here to initialize
  *  and link the PlayerClient with the motor and rangers.
+ *
+ *  The superloop can optionally run pipelined across three threads. An
+ *  acquisition thread reads Player and publishes a Percept per update
+ *  through a lock-free ring, the controller thread (the caller of
+ *  @ref run ) consumes the newest Percept every tick, and an actuation
+ *  thread sends the motor commands through a QueuedMotor. A slow
+ *  controller tick then never delays sensor intake or motor writes.
+ *  Pipelined mode relies on the PlayerClient being thread-safe, as it is
+ *  when playerc++ is built with Boost thread support.
+ *
+ *  In event-driven mode the superloop instead sleeps on the Player socket
+ *  and only runs the controller once fresh ranger or odometry data has
+ *  arrived, so an idle robot costs next to no CPU.
  */
 class Robot : public CommandExecuter {
     public:
@@ -54,10 +83,20 @@ class Robot : public CommandExecuter {
          *      added later with @ref addRanger .
          *
          *  @param motor : The motor used to drive the robot.
+         *
+         *  @param frequency : Rate of the superloop in Hz.
+         *
+         *  @param mode : How the superloop is driven.
+         *
+         *  @param dataMode : Data delivery mode the PlayerClient was set to,
+         *      either PLAYER_DATAMODE_PUSH or PLAYER_DATAMODE_PULL.
          */
         Robot( PlayerCc::PlayerClient& robot,
                PlayerCc::RangerProxy &rangerProxy,
-               PlayerCc::Position2dProxy &positionProxy );
+               PlayerCc::Position2dProxy &positionProxy,
+               double frequency = 10,
+               loopMode mode = SERIAL,
+               unsigned int dataMode = PLAYER_DATAMODE_PUSH );
 
         /** Default contructor.
          *
@@ -74,6 +113,10 @@ class Robot : public CommandExecuter {
          *  Initiates the "Think-Act" superloop and effectively blocks main.
          *  The only way to kill the robot after this function is called is
          *  to invoke the "exit" command from the the robots personal console.
+         *
+         *  Each iteration of the superloop is paced by the Scheduler, so the
+         *  read/sense/update/actuate steps run at a fixed rate no matter how
+         *  long the console or Player take to respond.
          */
         void run();
 
@@ -86,6 +129,16 @@ class Robot : public CommandExecuter {
          */
         void addRanger(Ranger& ranger);
 
+        /** Gives the robot a map of its world.
+         *
+         *  Its distance field is computed, and the map is then updated
+         *  from every scan of every ranger. From then on the odometry is
+         *  corrected by localizing on the map.
+         *
+         *  @param map : The map, owned by the caller.
+         */
+        void setMap(Map& map);
+
         /** Swaps current controller for a new one.
          *
          *  The robots behaviour is changed before running or on the fly
@@ -112,15 +165,84 @@ class Robot : public CommandExecuter {
         /** A reference to Local. */
         Local* local;
 
-        /** Provides human-robot interaction. Called in superloop. */
+        /** Map of the world, NULL if there is none. */
+        Map* map;
+
+        /** Updates the map from the rangers, NULL if there is no map. */
+        Mapper* mapper;
+
+        /** Corrects the odometry on the map, NULL if there is no map. */
+        Localizer* localizer;
+
+        /** Obstacles around the robot, fed by the rangers. */
+        LocalCostmap localCostmap;
+
+        /** Provides human-robot interaction. Runs on its own thread. */
         Console console;
 
+        /** Paces the superloop at a fixed rate. */
+        Scheduler scheduler;
+
         /** Player from player/stage. */
         PlayerCc::PlayerClient* player;
 
         /** State of robot, on/off. */
         bool power;
 
+        /** Runs every stage of the superloop on the calling thread. */
+        void runSerial();
+
+        /** Runs the controller stage and spawns the other two stages. */
+        void runPipelined();
+
+        /** Runs the controller only when Player delivers fresh data. */
+        void runEventDriven();
+
+        /** Checks if any proxy received new data since it was last read.
+         *
+         *  @return True if a ranger or the local has fresh data.
+         */
+        bool isFresh();
+
+        /** Acquisition stage, reads Player and publishes percepts. */
+        void acquire();
+
+        /** Actuation stage, sends queued motor commands to Player. */
+        void actuate();
+
+        /** Executes any new command from the console.
+         *
+         *  @return False if the exit command was received.
+         */
+        bool updateConsole();
+
+        /** Reads all rangers and the local into a Percept.
+         *
+         *  @param percept : Filled with the latest readings.
+         */
+        void sense(Percept& percept);
+
+        /** Passes a Percept to the controller and updates it.
+         *
+         *  @param percept : The latest readings.
+         */
+        void think(Percept& percept);
+
+        /** How the superloop is driven. */
+        loopMode mode;
+
+        /** Player data delivery mode, push or pull. */
+        unsigned int dataMode;
+
+        /** Tells the acquisition and actuation threads to keep running. */
+        boost::atomic<bool> running;
+
+        /** Percepts from the acquisition thread to the controller thread. */
+        boost::lockfree::spsc_queue<Percept, boost::lockfree::capacity<16> > percepts;
+
+        /** Number of percepts lost because the controller fell behind. */
+        unsigned long droppedPercepts;
+
         /** Disable copy constructor. */
         Robot(const Robot& source);
 
@@ -1,4 +1,5 @@
 #include "wallfollower.h"
+#include "util/scankernels.h"
 
 CREATE_LOGGER("WallFollower");
 
@@ -15,44 +16,37 @@ WallFollower::~WallFollower() {
 }
 
 void WallFollower::update() {
-    MAKE_LOG << "Entering Update()" << std::endl;
+    LOG_DEBUG << "Entering Update()" << std::endl;
     double front, back;
     Position frontPos, backPos;
     if (isLeft) { //left side sonars
-        front = data.range[0];
-        back = data.range[15];
-        frontPos = data.pos[0];
-        backPos = data.pos[15];
+        front = data->range[0];
+        back = data->range[15];
+        frontPos = data->pos[0];
+        backPos = data->pos[15];
     }
     else { //right side sonars
-        front = data.range[7];
-        back = data.range[8];
-        frontPos = data.pos[7];
-        backPos = data.pos[8];
+        front = data->range[7];
+        back = data->range[8];
+        frontPos = data->pos[7];
+        backPos = data->pos[8];
     }
     //front sonars
-    double fl = data.range[3];
-    double fr = data.range[4];
+    double fl = data->range[3];
+    double fr = data->range[4];
 
     int closestIndex;
     double closestReading, diff, rangerDist, dist;
     double rotation = 1;
     double turnrate = PathExecuter::TURNRATE;
-    Path* path;
 
     switch (state) {
         case looking:
-            MAKE_LOG << "Looking..." << std::endl;
-            closestIndex = -1; //sonar index with closest reading
-            closestReading = data.maxRange; //best reading
-
-            //determine closest reading
-            for (unsigned int i = 0; i < data.range.size(); i++) {
-                if (data.range[i] < closestReading) {
-                    closestReading = data.range[i];
-                    closestIndex = i;
-                }
-            }
+            LOG_DEBUG << "Looking..." << std::endl;
+            //determine closest reading and its sonar index
+            closestReading = ScanKernels::minimum(data->scan, closestIndex);
+            if (closestReading >= data->maxRange)
+                closestIndex = -1; //nothing within range
 
             //if no wall found, move forward.
             if (closestIndex == -1)
@@ -61,32 +55,32 @@ void WallFollower::update() {
                 //stop motor, in case already moving forward
                 pe.halt();
                 //determine angle to pose robot
-                dist = data.pos[closestIndex].yaw;
+                dist = data->pos[closestIndex].yaw;
                 //Set pathexecuter to turn robot
-                path = new Path(robotLocation);
-                path->addMove(Move(dist, false));
-                pe.setPath(*path);
+                path.reset(robotLocation);
+                path.addMove(Move(dist, false));
+                pe.setPath(path);
                 //move to next state, which executes set turn
                 state = found;
             }
             break;
 
         case found:
-            MAKE_LOG << "Found..." << std::endl;
+            LOG_DEBUG << "Found..." << std::endl;
             if (pe.executeMove()) { //if finished turning
                 //check forward rangers
                 if (fr <= 0.4 || fl <= 0.4) { //stop, set turn
                     //pe.halt();
-                    path = new Path(robotLocation);
+                    path.reset(robotLocation);
                     //set turn to align side of robot with wall
                     //at this point it is assumed robot is more or less
                     //perpendicular to the wall, hence 90 degree turns.
                     if (isLeft)
-                        path->addMove(Move(M_PI/-2.0, 0));
+                        path.addMove(Move(M_PI/-2.0, 0));
                     else
-                        path->addMove(Move(M_PI/2.0, 0));
+                        path.addMove(Move(M_PI/2.0, 0));
 
-                    pe.setPath(*path);
+                    pe.setPath(path);
 
                     //move to next state, which excutes set turn
                     state = executeMove;
@@ -97,7 +91,7 @@ void WallFollower::update() {
             break;
 
         case executeMove:
-            MAKE_LOG << "Executing Move..." << std::endl;
+            LOG_DEBUG << "Executing Move..." << std::endl;
             //continue executing move until finished
             if (pe.executeMove()) {
                 state = movingParallel;
@@ -105,7 +99,7 @@ void WallFollower::update() {
             break;
 
         case movingParallel:
-            MAKE_LOG << "Moving Parallel..." << std::endl;
+            LOG_DEBUG << "Moving Parallel..." << std::endl;
 
             //check for concave corner
             if (fl < 0.4 || fr < 0.4) {
@@ -133,49 +127,49 @@ void WallFollower::update() {
                 break;
             } */
 
-            MAKE_LOG << "Calculating rotation..." << std::endl;
+            LOG_DEBUG << "Calculating rotation..." << std::endl;
             //calc rotation required to make parallel
             rotation *= atan(diff/rangerDist);
-            MAKE_LOG << "setting turnrate..." << std::endl;
+            LOG_DEBUG << "setting turnrate..." << std::endl;
             //calc turnrate as a factor of rotation
             turnrate = rotation*1.5;
-            MAKE_LOG << "Turnrate : " << turnrate << std::endl;
+            LOG_DEBUG << "Turnrate : " << turnrate << std::endl;
             //set motion
             pe.setMotion(Motion(PathExecuter::SPEED, turnrate));
             break;
 
         case concave:
-            MAKE_LOG << "Concave..." << std::endl;
+            LOG_DEBUG << "Concave..." << std::endl;
             //stop any existing movement
             pe.halt();
 
             //determine appropriate turn to make
             //currently set to make 90 degree turns
-            path = new Path(robotLocation);
+            path.reset(robotLocation);
             if (isLeft) //making right turn
-                path->addMove(Move(M_PI/-2.0, false));
+                path.addMove(Move(M_PI/-2.0, false));
             else //left turn
-                path->addMove(Move(M_PI/2.0, false));
+                path.addMove(Move(M_PI/2.0, false));
 
             //set turn
-            pe.setPath(*path);
+            pe.setPath(path);
             //change state to execute turn
             state = executeMove;
             break;
 
         case convex:
-            MAKE_LOG << "Convex..." << std::endl;
+            LOG_DEBUG << "Convex..." << std::endl;
             //turn until both side rangers see wall again
             //check if both rangers out of corner range
             if (front >= 2 && back >= 2) {
                 pe.halt();
                 MAKE_LOG << "Adding 90 degree turn" << std::endl;
-                path = new Path(robotLocation);
+                path.reset(robotLocation);
                 if (isLeft)
-                    path->addMove(Move(M_PI/2.0, false));
+                    path.addMove(Move(M_PI/2.0, false));
                 else
-                    path->addMove(Move(M_PI/-2.0, false));
-                pe.setPath(*path);
+                    path.addMove(Move(M_PI/-2.0, false));
+                pe.setPath(path);
                 state = executeMove;
             }
             else
@@ -205,7 +199,7 @@ void WallFollower::executeCommand(const Command cmd) {
     }
 }
 
-void WallFollower::setRangerData(RangerData data) {
+void WallFollower::setRangerData(RangerSnapshot data) {
     this->data = data;
     od.setRangerData(data);
 }
@@ -64,7 +64,7 @@ class WallFollower : public Controller {
          *
          *  @param data : The latest RangerData.
          */
-        void setRangerData(RangerData data);
+        void setRangerData(RangerSnapshot data);
 
         /** Sets the latest Position of the robot.
          *
@@ -97,7 +97,10 @@ class WallFollower : public Controller {
         wfState state;
 
         /** Latest ranger data. */
-        RangerData data;
+        RangerSnapshot data;
+
+        /** Turns handed to the PathExecuter, reused for each. */
+        Path path;
 
     private:
 
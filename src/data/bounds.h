@@ -0,0 +1,63 @@
+/** @file       src/data/bounds.h
+    @ingroup    DATA
+    @brief      Bounds struct.
+    @author     Alex Moriarty <alexander@dal.ca>
+    @author     Jacob Perron <perronj@yorku.ca>
+*/
+
+#ifndef __DATA_BOUNDS_H_
+#define __DATA_BOUNDS_H_
+
+#include <limits.h>
+
+/** A window of grid cells, inclusive on both ends.
+ *
+ *  Starts out empty and grows to cover every cell added to it.
+ */
+struct Bounds {
+    int x0, y0, x1, y1;
+
+    /** Default constructor, an empty window. */
+    Bounds() : x0(INT_MAX), y0(INT_MAX), x1(INT_MIN), y1(INT_MIN) { };
+
+    /** Constructor. */
+    Bounds(int x0, int y0, int x1, int y1) : x0(x0), y0(y0), x1(x1), y1(y1) { };
+
+    /** @return True if the window holds no cell. */
+    bool isEmpty() const { return x0 > x1 || y0 > y1; }
+
+    /** Grows the window to cover a cell. */
+    void add(int x, int y) {
+        if (x < x0) x0 = x;
+        if (x > x1) x1 = x;
+        if (y < y0) y0 = y;
+        if (y > y1) y1 = y;
+    }
+
+    /** Grows the window to cover another one. */
+    void add(const Bounds& b) {
+        if (b.isEmpty())
+            return;
+        add(b.x0, b.y0);
+        add(b.x1, b.y1);
+    }
+
+    /** Pads the window by some cells on every side. */
+    void grow(int cells) {
+        if (isEmpty())
+            return;
+        x0 -= cells;
+        y0 -= cells;
+        x1 += cells;
+        y1 += cells;
+    }
+
+    /** Shrinks the window to a width x height grid. */
+    void clip(int width, int height) {
+        if (x0 < 0) x0 = 0;
+        if (y0 < 0) y0 = 0;
+        if (x1 > width - 1) x1 = width - 1;
+        if (y1 > height - 1) y1 = height - 1;
+    }
+};
+#endif
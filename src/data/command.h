@@ -23,6 +23,9 @@ enum robotCommand {
     mode,
     behave,
     bug2,
+    stats,
+    loglevel,
+    track,
     NAC //Not A Command
 };
 
@@ -0,0 +1,23 @@
+/** @file       src/data/footprint.h
+    @ingroup    DATA
+    @brief      Size of the robot body.
+    @author     Alex Moriarty <alexander@dal.ca>
+    @author     Jacob Perron <perronj@yorku.ca>
+*/
+
+#ifndef __DATA_FOOTPRINT_H_
+#define __DATA_FOOTPRINT_H_
+
+/** Half the length and width of the robot body, in meters. The body is
+ *  the Pioneer's, a 0.44 m by 0.38 m box centred on the robot position.
+ */
+static const double ROBOT_HALF_LENGTH = 0.22, ROBOT_HALF_WIDTH = 0.19;
+
+/** Radius of the largest circle inside the body, in meters.
+ *
+ *  Planners and controllers keep at least this much clearance around the
+ *  robot position, and add their own margin on top of it.
+ */
+static const double ROBOT_RADIUS = ROBOT_HALF_WIDTH;
+
+#endif
@@ -4,21 +4,23 @@
 
 CREATE_LOGGER("Path");
 
-Path::Path(Position start) {
-    Node n;
-    n.position = start;
-    node.push_back(n);
-    overwritten = true; //no need for place-holder.
+/** Nodes of a new ring, a power of two. */
+static const int INITIAL_NODES = 8;
+
+Path::Path(Position start) : ring(INITIAL_NODES) {
+    reset(start); //no need for place-holder.
     LOG_CTOR << "Constructed." << std::endl;
 }
 
-Path::Path() {
+Path::Path() : ring(INITIAL_NODES) {
     //initial position needed for scenerio when working with moves only.
-    Position pos;
-    Node n;
-    n.position = pos;
-    node.push_back(n);
-    overwritten = false;
+    clear();
+    LOG_CTOR << "Constructed." << std::endl;
+}
+
+Path::Path(const Path& source) : ring(INITIAL_NODES) {
+    head = count = 0;
+    *this = source;
     LOG_CTOR << "Constructed." << std::endl;
 }
 
@@ -26,55 +28,105 @@ Path::~Path() {
     LOG_DTOR << "Destructed." << std::endl;
 }
 
+Path& Path::operator=(const Path& source) {
+    if (this == &source)
+        return *this;
+    head = count = 0;
+    for (int i = 0; i < source.count; i++) {
+        const Node& from = source.at(i);
+        Node& to = push();
+        to.position = from.position;
+        to.move.assign(from.move.begin() + from.first, from.move.end());
+    }
+    overwritten = source.overwritten;
+    return *this;
+}
+
+void Path::clear() {
+    head = count = 0;
+    push().position = Position();
+    overwritten = false;
+}
+
+void Path::reset(Position start) {
+    head = count = 0;
+    push().position = start;
+    overwritten = true;
+}
+
+Path::Node& Path::push() {
+    int capacity = ring.size();
+    if (count == capacity) {
+        //unroll into a ring twice the size, taking the moves along
+        std::vector<Node> larger(capacity * 2);
+        for (int i = 0; i < count; i++) {
+            Node& n = at(i);
+            larger[i].position = n.position;
+            larger[i].move.swap(n.move);
+            larger[i].first = n.first;
+        }
+        ring.swap(larger);
+        head = 0;
+    }
+    //reuse whatever the slot held before
+    Node& n = at(count++);
+    n.move.clear();
+    n.first = 0;
+    return n;
+}
+
 void Path::addPosition(Position pos) {
     if (!overwritten) { //first position being added
-        node.pop_back();//remove place holder
+        count--; //remove place holder
         overwritten = true;
     }
-    Node n;
-    n.position = pos;
-    node.push_back(n);
+    push().position = pos;
 }
 
 void Path::addMove(Move m, int i) {
-    node[i].move.push_back(m);
+    at(i).move.push_back(m);
 }
 
 void Path::addMove(Move m) {
-    addMove(m, node.size()-1);
+    addMove(m, count - 1);
 }
 
-int Path::size() {
-    return node.size();
+int Path::size() const {
+    return count;
 }
 
-int Path::numOfMoves(int i) {
-    return node[i].move.size();
+int Path::numOfMoves(int i) const {
+    return at(i).move.size() - at(i).first;
 }
 
-Position Path::getPosition(int i) {
-    return node[i].position;
+Position Path::getPosition(int i) const {
+    return at(i).position;
 }
 
-Move Path::getMove(int i, int j) {
-    return node[i].move[j];
+Move Path::getMove(int i, int j) const {
+    return at(i).move[at(i).first + j];
 }
 
-Move Path::getMove() {
+Move Path::getMove() const {
     // Could result in segfault if move or node doesn't exist.
-    return node[0].move[0];
+    return getMove(0, 0);
 }
 
 Position Path::removePosition(int i) {
     // Could result in segfault if move or node doesn't exist?
     //copy Position struct
-    Position p = node[i].position;
-
-    //remove original and it's associated Move structs
-    for (int k = 0; k < node.size(); k++)
-        node[i].move.erase(node[i].move.begin()+k);
-
-    node.erase(node.begin()+i);
+    Position p = at(i).position;
+
+    //remove original, it's associated Move structs go with it
+    if (i == 0)
+        head = (head + 1) & (ring.size() - 1);
+    else
+        for (int k = i; k + 1 < count; k++) {
+            at(k).position = at(k + 1).position;
+            at(k).move.swap(at(k + 1).move);
+            at(k).first = at(k + 1).first;
+        }
+    count--;
 
     return p;
 }
@@ -82,21 +134,23 @@ Position Path::removePosition(int i) {
 Move Path::removeMove(int i, int j) {
     //Could result in segfaults if move or node doesn't exist?
     //copy Move struct
-    Move m = node[i].move[j];
-    //remove original
-    node[i].move.erase(node[i].move.begin()+j-1);
+    Node& n = at(i);
+    Move m = n.move[n.first + j];
+
+    //remove original, from the front by skipping over it
+    if (j == 0)
+        n.first++;
+    else
+        n.move.erase(n.move.begin() + n.first + j);
+    if (n.first == (int)n.move.size()) {
+        n.move.clear();
+        n.first = 0;
+    }
     return m;
 }
 
 Move Path::removeMove() {
-    //Could result in segfaults if move or node doesn't exist?
-    //copy Move struct
-    Move m = node[0].move[0];
-
-    //remove original
-    node[0].move.erase(node[0].move.begin());
-
-    return m;
+    return removeMove(0, 0);
 }
 
 /* 
@@ -27,6 +27,13 @@
  *
  *  @ref checkpoint allows the client to add a new Position to the end of the
  *  list based on the moves taken from the previous Position.
+ *
+ *  The nodes are kept in a ring, so a Path is consumed from the front in
+ *  constant time per Position or Move. Consumed nodes keep their storage
+ *  for the ones added after them, and clearing or assigning to a Path
+ *  keeps it too, so a Path that is reused rather than recreated stops
+ *  allocating once it has held its longest plan. Paths are values: copy
+ *  one to hand it over, rather than sharing a pointer to it.
  */
 class Path {
     public:
@@ -51,9 +58,24 @@ class Path {
          */
         Path(Position pos);
 
+        /** Copy constructor. */
+        Path(const Path& source);
+
         /** Destructor. */
         ~Path();
 
+        /** Copies a Path into the storage of this one. */
+        Path& operator=(const Path& source);
+
+        /** Empties the path, as if newly constructed without a Position. */
+        void clear();
+
+        /** Empties the path, as if newly constructed from a Position.
+         *
+         *  @param pos : The first Position in the Path.
+         */
+        void reset(Position pos);
+
         /** Adds a Position to the end of the path.
          *
          *  @note Client should take care to realize that added moves
@@ -88,7 +110,7 @@ class Path {
          *
          *  @return The current number of positions in the path.
          */
-        int size();
+        int size() const;
 
         /** Returns the number of moves taken after a Position.
          *
@@ -99,7 +121,7 @@ class Path {
          *
          *  @return The number of moves.
          */
-        int numOfMoves(int i);
+        int numOfMoves(int i) const;
 
         /** Adds a new Position to the end of the path.
          *
@@ -115,7 +137,7 @@ class Path {
          *
          *  @return A Position in the Path.
          */
-        Position getPosition(int i);
+        Position getPosition(int i) const;
 
         /** Accessor for Move.
          *
@@ -126,13 +148,13 @@ class Path {
          *
          *  @return A Move in the Path.
          */
-        Move getMove(int positionIndex, int moveIndex);
+        Move getMove(int positionIndex, int moveIndex) const;
 
         /** Accessor for first element in first list of moves.
          *
          *  @return A Move in the Path.
          */
-        Move getMove();
+        Move getMove() const;
 
         /** Removes a Position from the Path.
          *
@@ -167,13 +189,30 @@ class Path {
 
     private:
 
+        /** A Position and the moves after it, those before @c first
+         *  already removed.
+         */
         struct Node {
             Position position;
             std::vector<Move> move;
+            int first;
         };
 
-        /** List of nodes each containing a Position and list of Moves. */
-        std::vector<Node> node;
+        /** Ring of nodes, its size a power of two. */
+        std::vector<Node> ring;
+
+        /** Index in the ring of the first node, and number of nodes. */
+        int head, count;
+
+        /** @return The node of a Position index. */
+        Node& at(int i) { return ring[(head + i) & (ring.size() - 1)]; }
+        const Node& at(int i) const { return ring[(head + i) & (ring.size() - 1)]; }
+
+        /** Adds an empty node to the end, doubling the ring if full.
+         *
+         *  @return The node added.
+         */
+        Node& push();
 
         /** Used to determine when placeholder Position should be removed. */
         bool overwritten;
@@ -0,0 +1,29 @@
+/** @file       src/data/percept.h
+    @ingroup    Data
+    @brief      Percept struct.
+    @author     Alex Moriarty <alexander@dal.ca>
+    @author     Jacob Perron <perronj@yorku.ca>
+*/
+
+#ifndef __DATA_PERCEPT_H_
+#define __DATA_PERCEPT_H_
+
+#include <vector>
+#include "rangerdata.h"
+#include "position.h"
+
+/** Everything the robot sensed during one Player update.
+ *
+ *  Used to hand sensor readings from the acquisition thread to the
+ *  controller thread when the Robot runs pipelined. One RangerSnapshot is
+ *  kept per ranger, in the same order as the rangers aboard the Robot.
+ */
+struct Percept {
+
+    /** Readings of every ranger. */
+    std::vector<RangerSnapshot> ranger;
+
+    /** Robot location at the time of the readings. */
+    Position position;
+};
+#endif
@@ -8,7 +8,16 @@
 #ifndef __DATA_RANGERDATA_H_
 #define __DATA_RANGERDATA_H_
 
+#include <vector>
+#include <boost/shared_ptr.hpp>
 #include "position.h"
+#include "scan.h"
+
+/** Kinds of rangers a robot can carry. */
+enum rangerType {
+    SONAR,  //one element per reading
+    LASER   //a single element sweeping many readings
+};
 
 /** Holds data from a ranger.
  *
@@ -17,6 +26,10 @@
  *  using RangerData to know what type of data is contained inside.
  *
  *  For now RangerData is set up for data from a RangerProxy in Player/Stage.
+ *
+ *  The readings are held twice: as @ref range and @ref pos for indexed
+ *  access to individual rangers, and as a Scan for the per-tick loops
+ *  over every reading done with ScanKernels.
  */
 struct RangerData {
 
@@ -26,13 +39,27 @@ struct RangerData {
     /** Angle of individual ranger relative to robot. */
     std::vector<Position> pos;
 
+    /** Kind of ranger the data comes from. */
+    rangerType type;
+
+    /** Readings and geometry laid out for ScanKernels. */
+    Scan scan;
+
     /** Other RangerProxy data. */
     double angleRes, minAngle, maxAngle, minRange, maxRange;
 
     /** Constructor */
     RangerData(std::vector<double> r, std::vector<Position> p) : range(r), pos(p) { };
 
-    RangerData() { };
+    RangerData() : type(SONAR), angleRes(0), minAngle(0), maxAngle(0), minRange(0), maxRange(0) { };
 
 };
+
+/** Read-only RangerData shared by every consumer of one update.
+ *
+ *  A Ranger produces one snapshot per update and every Controller,
+ *  ObjectDetector and Bug holds a reference to it instead of a copy.
+ *  Consumers must not modify it.
+ */
+typedef boost::shared_ptr<const RangerData> RangerSnapshot;
 #endif
@@ -0,0 +1,70 @@
+/** @file       src/data/scan.h
+    @ingroup    Data
+    @brief      Scan struct.
+    @author     Alex Moriarty <alexander@dal.ca>
+    @author     Jacob Perron <perronj@yorku.ca>
+*/
+
+#ifndef __DATA_SCAN_H_
+#define __DATA_SCAN_H_
+
+#include <vector>
+#include <cfloat>
+#include <stdint.h>
+#include <boost/align/aligned_allocator.hpp>
+
+/** A float array aligned for SIMD loads. */
+typedef std::vector<float, boost::alignment::aligned_allocator<float, 16> > FloatArray;
+
+/** An int array aligned for SIMD loads. */
+typedef std::vector<int32_t, boost::alignment::aligned_allocator<int32_t, 16> > IntArray;
+
+/** Ranger readings laid out as separate arrays (structure of arrays).
+ *
+ *  Every array holds one value per reading, so the kernels in ScanKernels
+ *  can stream through them four floats at a time. The arrays are padded up
+ *  to a multiple of @ref WIDTH ; padded readings have a range of FLT_MAX so
+ *  they are never picked as a minimum or seen as an obstacle.
+ *
+ *  Only @ref range changes between updates, the rest is the ranger
+ *  geometry and is filled once by the Ranger.
+ */
+struct Scan {
+
+    /** Number of floats processed at once by the kernels. */
+    static const unsigned int WIDTH = 4;
+
+    /** Number of actual readings, without padding. */
+    unsigned int size;
+
+    /** Range readings, in meters. */
+    FloatArray range;
+
+    /** Direction of each reading relative to the robot, in radians. */
+    FloatArray angle;
+
+    /** Precomputed cos and sin of @ref angle . */
+    FloatArray cosAngle, sinAngle;
+
+    /** Where each reading originates relative to the robot. */
+    FloatArray originX, originY;
+
+    /** Default constructor, an empty scan. */
+    Scan() : size(0) { };
+
+    /** Resizes all arrays for a number of readings, plus padding.
+     *
+     *  @param n : Number of readings.
+     */
+    void resize(unsigned int n) {
+        unsigned int padded = (n + WIDTH - 1) / WIDTH * WIDTH;
+        size = n;
+        range.assign(padded, FLT_MAX);
+        angle.assign(padded, 0);
+        cosAngle.assign(padded, 0);
+        sinAngle.assign(padded, 0);
+        originX.assign(padded, 0);
+        originY.assign(padded, 0);
+    }
+};
+#endif
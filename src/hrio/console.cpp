@@ -7,43 +7,77 @@
 //CREATE_LOGGER("Console");
 
 Console::Console() {
-    terminal.setTimeout(10);
-    newCommand = false;
+    terminal.setTimeout(50);
+    running = false;
   //  MAKE_LOG << "Constructed." << std::endl;
 }
 
 Console::~Console() {
+    stop();
+
+    //free anything left in the queues
+    Command* cmd;
+    while (commands.pop(cmd))
+        delete cmd;
+    std::string* msg;
+    while (messages.pop(msg))
+        delete msg;
   // MAKE_LOG << "Destructed." << std::endl;
 }
 
-bool Console::update() {
+void Console::start() {
+    running = true;
+    thread = boost::thread(&Console::run, this);
+}
+
+void Console::stop() {
+    running = false;
+    if (thread.joinable())
+        thread.join();
+}
+
+bool Console::isRunning() {
+    return running;
+}
+
+void Console::run() {
   std::string line;
-  if(!terminal.checkRequestPending()) {
-    terminal.clrScreen();          // clear terminal screen
-    write(1, "\0337\033[1;1H", 8); // move cursor to its upper-left corner
-    displayMenu();
-    terminal.requestLine(">");
-  }
-  else {
-    if(terminal.getLine(line)) {   // read command, if any
-      if(line == "exit")           // check if the command is "exit"
-        return false;
-      else if (line == "clear")
-        history.clear();
-      else
-        processCommand(line);      // regular command, process
+  while (running) {
+    collectLog();
+    if(!terminal.checkRequestPending()) {
+      terminal.clrScreen();          // clear terminal screen
+      write(1, "\0337\033[1;1H", 8); // move cursor to its upper-left corner
+      displayMenu();
+      terminal.requestLine(">");
+    }
+    else {
+      if(terminal.getLine(line)) {   // read command, if any, waits for timeout
+        if(line == "exit")           // check if the command is "exit"
+          running = false;
+        else if (line == "clear")
+          history.clear();
+        else
+          processCommand(line);      // regular command, process
+      }
     }
   }
-  return true;
 }
 
-Command Console::getCommand() {
-    newCommand = false;
-    return command;
+void Console::collectLog() {
+    std::string* msg;
+    while (messages.pop(msg)) {
+        history.insert(history.begin(), *msg);
+        delete msg;
+    }
 }
 
-bool Console::isNewCommand() {
-    return newCommand;
+bool Console::getCommand(Command& cmd) {
+    Command* next;
+    if (!commands.pop(next))
+        return false;
+    cmd = *next;
+    delete next;
+    return true;
 }
 
 void Console::displayMenu() {
@@ -89,22 +123,29 @@ void Console::processCommand(std::string& line) {
               std::istream_iterator<std::string>(),
               std::back_inserter<std::vector<std::string> >(token) );
 
+    //ignore empty lines
+    if (token.empty())
+        return;
+
     std::string c = token[0];
     //create Command object with enum robotCommand as name
-    Command cmd(stoe(c));
+    Command* cmd = new Command(stoe(c));
     //copy remaining args, if any
-    cmd.arg = token;
+    cmd->arg = token;
 
-    command = cmd;
-    newCommand = true;
+    //hand over to the control loop
+    if (!commands.push(cmd)) {
+        history.insert(history.begin(), "Too many commands pending, ignored.");
+        delete cmd;
+    }
 } //end processCommand
 
 /** Convienence method that turns a string into a robotCommand enum. */
 robotCommand Console::stoe(const std::string str) {
     if (str == "start")
-        return start;
+        return ::start; //enum, not Console::start
     else if (str == "stop")
-        return stop;
+        return ::stop;
     else if (str == "load")
         return load;
     else if (str == "goto")
@@ -125,10 +166,18 @@ robotCommand Console::stoe(const std::string str) {
 		return mode;
     else if (str == "behave")
 		return behave;
+    else if (str == "stats")
+        return stats;
+    else if (str == "loglevel")
+        return loglevel;
+    else if (str == "track")
+        return track;
 	else
         return NAC; //Not A Command
 }
 
 void Console::log(const std::string line) {
-    history.insert(history.begin(), line);
+    std::string* msg = new std::string(line);
+    if (!messages.push(msg))
+        delete msg; //console thread is not keeping up, drop the line
 }
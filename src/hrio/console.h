@@ -9,11 +9,20 @@
 #define __HRIO_CONSOLE_H_
 
 #include <sstream>
+#include <boost/lockfree/queue.hpp>
+#include <boost/thread.hpp>
+#include <boost/atomic.hpp>
 #include "PSTermIOSimple.h"
 #include "data/command.h"
 
 /** This class provides means for human-robot interaction through a console.
  *  It uses the PSTermIO library to make the user input non-blocking.
+ *
+ *  All terminal I/O happens on the console's own thread, started with
+ *  @ref start . Parsed commands are passed to the control loop through a
+ *  lock-free queue drained with @ref getCommand , and lines logged with
+ *  @ref log travel back to the console thread through a second lock-free
+ *  queue. The control loop therefore never waits on the terminal.
  */
 class Console {
     public:
@@ -24,47 +33,37 @@ class Console {
         /** Default destructor. */
         virtual ~Console();
 
-        /** Checks if there is a new input from a user, processes it and executes
-         *  commands.
-         *
-         *  Here we distinguish between two "states" of the console system:
-         *    #) The menu is NOT displayed, NOT waiting for the user input.
-         *    #) The menu is on the screen and system waits for the user input.
-         *  When the system is in first state, we clear screen, display menu and ask
-         *  for the user input.
-         *  When the system is in second state, we check if the user input ready (which
-         *  means that the user has typed something and hit "enter"). If it is ready,
-         *  then we process it and execute whatever is commanded.
+        /** Starts the console thread. */
+        void start();
+
+        /** Stops the console thread and waits for it to finish. */
+        void stop();
+
+        /** Used to let the client know if the console is still running.
          *
-         *  @return false if the exit command received, true if a regular command or no
-         *          command received
+         *  @return false once the exit command was received, true otherwise.
          */
-        bool update();
+        bool isRunning();
 
         /** Logs a line to the console.
          *
          *  The string provided is added to the log history of the console, part of
-         *  which is displayed to console.
+         *  which is displayed to console. Safe to call from any thread.
          *
          *  @param line : The string to be logged.
          */
         void log(const std::string line);
 
-        /** Gets the last command issued.
+        /** Takes the oldest command not yet executed.
          *
-         *  Should be called after calling @ref isNewCommand in order to check
-         *  whether or not the command is old and should not be executed.
+         *  Never blocks. Should be called until it returns false in order to
+         *  execute every command issued since the last call.
          *
-         *  @return The last Command object created by Console.
-         */
-        Command getCommand();
-
-        /** Used to let the client know if there has been a new command issued.
+         *  @param cmd : Set to the command, if there is one.
          *
-         *  @return @c true if there has been a new command since the last
-         *      @ref getCommand call. @c false otherwise.
+         *  @return @c true if a command was taken, @c false otherwise.
          */
-        bool isNewCommand();
+        bool getCommand(Command& cmd);
 
         /** Static method used to convert a string into a 'robotCommand' enum.
          *
@@ -74,6 +73,22 @@ class Console {
 
     private:
 
+        /** Body of the console thread.
+         *
+         *  Here we distinguish between two "states" of the console system:
+         *    #) The menu is NOT displayed, NOT waiting for the user input.
+         *    #) The menu is on the screen and system waits for the user input.
+         *  When the system is in first state, we clear screen, display menu and ask
+         *  for the user input.
+         *  When the system is in second state, we check if the user input ready (which
+         *  means that the user has typed something and hit "enter"). If it is ready,
+         *  then we process it and queue whatever is commanded.
+         */
+        void run();
+
+        /** Moves lines logged by other threads into the history. */
+        void collectLog();
+
         /** Prints the main menu to the terminal. */
         void displayMenu();
 
@@ -104,11 +119,17 @@ class Console {
         /** Use of provided PSTermIO object. */
         MobileRobots::PSTermIO terminal;
 
-        /** The last command issued through the console. */
-        Command command;
+        /** Commands from the console thread to the control loop. */
+        boost::lockfree::queue<Command*, boost::lockfree::capacity<64> > commands;
+
+        /** Lines from any thread to the console thread. */
+        boost::lockfree::queue<std::string*, boost::lockfree::capacity<256> > messages;
+
+        /** The console thread. */
+        boost::thread thread;
 
-        /** State depends on whether there is new command or not. */
-        bool newCommand;
+        /** Cleared on the exit command or by @ref stop . */
+        boost::atomic<bool> running;
 
         /** History logging commands and other information. */
         std::vector<std::string> history;
@@ -42,6 +42,9 @@
 class Module {
     public:
 
+        /** Destructor, virtual so modules can be deleted through a base. */
+        virtual ~Module() {}
+
         /** Returns a string representation of the module.
          *
          *  The representation should include something like the name of the
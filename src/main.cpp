@@ -3,6 +3,7 @@
 #include <libplayerc++/playerc++.h>
 #include "args.h"
 #include "ctrl/robot.h"
+#include "plan/map.h"
 #include "util/logger.h"
 #include "docs/mainpage.h"
 
@@ -12,8 +13,16 @@ int main(int argc, char **argv) {
     CREATE_LOGGER("main");
     Logger::start("numbers");
 
+    parse_args(argc, argv);
+
     PlayerClient player(gHostname, gPort);
 
+    // Set how the server delivers data, in push mode only keep the newest
+    // message of each kind so the robot never acts on a stale backlog
+    player.SetDataMode(gDataMode);
+    if (gDataMode == PLAYER_DATAMODE_PUSH)
+        player.SetReplaceRule(true, PLAYER_MSGTYPE_DATA);
+
     // Subscribe to the position2d device
     Position2dProxy positionProxy(&player, gIndex);
 
@@ -22,6 +31,11 @@ int main(int argc, char **argv) {
     */
     RangerProxy rangerProxy(&player, 1);
 
+    // Subscribe to the SICK laser as well, if asked for
+    RangerProxy* laserProxy = NULL;
+    if (gUseLaser)
+        laserProxy = new RangerProxy(&player, 0);
+
     // Actually connect proxies with player server by initiating communication
     player.Read();
 
@@ -30,6 +44,10 @@ int main(int argc, char **argv) {
     positionProxy.RequestGeom();
     rangerProxy.RequestConfigure();
     rangerProxy.RequestGeom();
+    if (laserProxy != NULL) {
+        laserProxy->RequestConfigure();
+        laserProxy->RequestGeom();
+    }
 
     // Do actual communication with server
     player.Read();
@@ -38,11 +56,25 @@ int main(int argc, char **argv) {
 
     // We now create high-level modules
     {
-        Robot robot(player, rangerProxy, positionProxy);
+        loopMode mode = SERIAL;
+        if (gPipelined)
+            mode = PIPELINED;
+        else if (gEventDriven)
+            mode = EVENT_DRIVEN;
+
+        Map map;
+        Robot robot(player, rangerProxy, positionProxy, gFrequency, mode, gDataMode);
+        if (laserProxy != NULL)
+            robot.addRanger(*new Ranger(*laserProxy));
+
+        // Load the map of the world, if given
+        if (!gWorld.empty() && map.loadWorld(gWorld))
+            robot.setMap(map);
         MAKE_LOG << "Ready to run robot." << std::endl;
         robot.run();
         MAKE_LOG << "Finished running" << std::endl;
     }
+    delete laserProxy;
     Logger::stop();
 
     return 0;
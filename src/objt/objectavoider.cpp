@@ -1,9 +1,14 @@
 #include "objectavoider.h"
+#include <math.h>
+#include "util/geometry.h"
+#include "util/scheduler.h"
 
 CREATE_LOGGER("ObjectAvoider");
 
 ObjectAvoider::ObjectAvoider(Motor& motor) {
     this->motor = &motor;
+    calls = 0;
+    time = 0;
     LOG_CTOR << "Constructed." << std::endl;
 }
 
@@ -11,13 +16,35 @@ ObjectAvoider::~ObjectAvoider() {
     LOG_DTOR << "Destructed." << std::endl;
 }
 
-void ObjectAvoider::avoid() {
-    motor->halt();
-    MAKE_LOG << "Motor halted." << std::endl;
+Motion ObjectAvoider::avoid(const Position& goal) {
+    RangerSnapshot data = laser ? laser : ranger;
+    if (!data) {
+        motor->halt();
+        return Motion();
+    }
+
+    int64_t start = Scheduler::now();
+    double toGoal = atan2(goal.y - robot.y, goal.x - robot.x) - robot.yaw;
+    Motion m = vfh.steer(*data, wrapAngle(toGoal), robot.yaw);
+    motor->setMotion(m);
+    motor->update();
+
+    calls++;
+    time += Scheduler::now() - start;
+    LOG_DEBUG << "Steering into sector " << vfh.getSector() << "." << std::endl;
+    return m;
+}
+
+void ObjectAvoider::setRangerData(RangerSnapshot data) {
+    ranger = data;
+}
+
+void ObjectAvoider::setLaserData(RangerSnapshot data) {
+    laser = data;
 }
 
-void ObjectAvoider::setPosition(Path pos) {
-    this->position = pos;
+void ObjectAvoider::setLocal(Position pos) {
+    robot = pos;
 }
 
 void ObjectAvoider::setMotor(Motor& motor) {
@@ -25,6 +52,10 @@ void ObjectAvoider::setMotor(Motor& motor) {
 }
 
 std::string ObjectAvoider::toString() {
-    //TODO
-    return "ObjectAvoider";
+    std::stringstream ss;
+    ss << "ObjectAvoider: " << calls << " steers";
+    if (calls > 0)
+        ss << " of " << time / 1e3 / calls << " us on average";
+    ss << ".";
+    return ss.str();
 }
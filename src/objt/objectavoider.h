@@ -8,10 +8,14 @@
 #ifndef __OBJT_OBJECTAVOIDER_H_
 #define __OBJT_OBJECTAVOIDER_H_
 
+#include <stdint.h>
+#include <sstream>
 #include "infs/module.h"
 #include "actr/motor.h"
 #include "data/position.h"
-#include "data/path.h"
+#include "data/motion.h"
+#include "data/rangerdata.h"
+#include "objt/vectorfieldhistogram.h"
 
 /** Avoids objects and obstacles.
  *
@@ -21,9 +25,9 @@
  *
  *  It should be predefined by the controller that after an object is
  *  detected if ObjectDetector should pass control to ObjectAvoider.
- *  The controller can also specify ahead of time how it wants the
- *  ObjectAvoider to behave, according to predefined modes, through
- *  the ObjectDetector.
+ *
+ *  Steering is by VectorFieldHistogram, which keeps the robot moving
+ *  around obstacles rather than stopping dead in front of them.
  */
 class ObjectAvoider : public Module {
     public:
@@ -37,21 +41,31 @@ class ObjectAvoider : public Module {
         /** Destructor. */
         ~ObjectAvoider();
 
-        /** Moves the robot so there are no immediate obstacles in its path.
+        /** Steers the robot towards a goal around the obstacles in view.
+         *
+         *  The motion is sent to the motor. With no gap wide enough to
+         *  pass, the robot turns on the spot towards the goal.
+         *
+         *  @param goal : Where the robot is headed.
          *
-         *  Based on the current Position of obstacles provided, move the robot
-         *  according to the preset behaviour in order to avoid said obstacles.
+         *  @return The motion sent to the motor.
+         */
+        Motion avoid(const Position& goal);
+
+        /** Sets the most recent ranger readings from the robot.
          *
-         *  @note: Class is not fully functional, right now only halts motor in
-         *      order to stop from crashing into obstacles.
+         *  @param data : Shared snapshot of the ranger readings.
          */
-        void avoid();
+        void setRangerData(RangerSnapshot data);
 
-        /** Sets the current Position of known obstacles.
+        /** Sets the most recent laser readings, used over the rangers.
          *
-         *  @param positions : The known positions of obstacles to be avoided.
+         *  @param data : Shared snapshot of the laser readings.
          */
-        void setPosition(Path positions);
+        void setLaserData(RangerSnapshot data);
+
+        /** Sets the current location of the robot. */
+        void setLocal(Position pos);
 
         /** Sets reference to robot motor. */
         void setMotor(Motor& m);
@@ -70,10 +84,20 @@ class ObjectAvoider : public Module {
         /** Disable assignment operator. */
         ObjectAvoider& operator=(const ObjectAvoider& source);
 
-        /** Most recent known Position of obstacles. */
-        Path position;
-
         /** Reference to motor, for purpose of manual override. */
         Motor* motor;
+
+        /** Most recent ranger and laser readings. */
+        RangerSnapshot ranger, laser;
+
+        /** Current location of the robot. */
+        Position robot;
+
+        /** Picks the direction to steer in. */
+        VectorFieldHistogram vfh;
+
+        /** Statistics. */
+        unsigned long calls;
+        int64_t time;
 };
 #endif
@@ -1,9 +1,11 @@
 #include "objectdetector.h"
+#include "util/scankernels.h"
 
 CREATE_LOGGER("ObjectDetector");
 
 ObjectDetector::ObjectDetector() {
     threshold = 0.25;
+    costmap = NULL;
     LOG_CTOR << "Constructed." << std::endl;
 }
 
@@ -12,20 +14,37 @@ ObjectDetector::~ObjectDetector() {
 }
 
 bool ObjectDetector::check() {
-    //int minAngle = (data.range.size() * 3) / 8;
-    //int maxAngle = (data.range.size() * 5) / 8;
-    for (int i = 0; i < data.range.size(); i++) {
-        if (data.range[i] < threshold)
+    //anything inside the strip ahead of the robot
+    if (costmap != NULL) {
+        if (costmap->anyInside(0, ROBOT_HALF_LENGTH + threshold,
+                               -ROBOT_HALF_WIDTH, ROBOT_HALF_WIDTH))
             return true;
     }
+    else if (laser && ScanKernels::anyInside(laser->scan, 0,
+                                             ROBOT_HALF_LENGTH + threshold,
+                                             -ROBOT_HALF_WIDTH, ROBOT_HALF_WIDTH))
+        return true;
+
+    //anything too close to one of the rangers
+    if (data && data->type != LASER)
+        return ScanKernels::anyBelow(data->scan, threshold);
+
     return false;
 }
 
+void ObjectDetector::setLaserData(RangerSnapshot data) {
+    laser = data;
+}
+
+void ObjectDetector::setCostmap(const LocalCostmap* c) {
+    costmap = c;
+}
+
 void ObjectDetector::setThreshold(double t) {
     threshold = t;
 }
 
-void ObjectDetector::setRangerData(RangerData data) {
+void ObjectDetector::setRangerData(RangerSnapshot data) {
     this->data = data;
 }
 
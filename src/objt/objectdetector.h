@@ -11,12 +11,24 @@
 #include "infs/module.h"
 #include "data/rangerdata.h"
 #include "data/position.h"
+#include "data/footprint.h"
+#include "plan/localcostmap.h"
 
 /** Detects obstacles.
  *
  *  Given RangerData from a Controller, ObjectDetector will determine if
  *  there are any objects too close to the robot using @ref check .
  *
+ *  When the robot carries a laser its readings are used as well. Rather
+ *  than a plain distance threshold, which with 361 readings would also
+ *  trigger on walls the robot is merely passing, every laser reading is
+ *  converted to a point in the robot frame and checked against a box the
+ *  width of the robot reaching @c threshold past its front.
+ *
+ *  Given a LocalCostmap the same box is checked against it instead of the
+ *  laser readings, which also catches obstacles the laser no longer sees,
+ *  such as one beside the robot after a turn.
+ *
  *  @note ObjectDetector is planned on being expanded to potentially
  *      calculate and return the current positions of immediate objects
  */
@@ -41,9 +53,21 @@ class ObjectDetector : public Module {
 
         /** Sets the most recent ranger readings from the robot.
          *
-         *  @param data : A RangerData struct containing ranger readings.
+         *  @param data : Shared snapshot of the ranger readings.
+         */
+        void setRangerData(RangerSnapshot data);
+
+        /** Sets the most recent laser readings from the robot.
+         *
+         *  @param data : Shared snapshot of the laser readings.
          */
-        void setRangerData(RangerData data);
+        void setLaserData(RangerSnapshot data);
+
+        /** Sets the costmap of the obstacles around the robot.
+         *
+         *  @param costmap : The costmap, or NULL to use the laser alone.
+         */
+        void setCostmap(const LocalCostmap* costmap);
 
         /** Sets distance threshold.
          *
@@ -62,8 +86,14 @@ class ObjectDetector : public Module {
         /** Threshold distance for an object to be considered too close. */
         double threshold;
 
-        /** Copy of most recent ranger data from the robot. */
-        RangerData data;
+        /** Most recent ranger data from the robot. */
+        RangerSnapshot data;
+
+        /** Most recent laser data from the robot, if it has a laser. */
+        RangerSnapshot laser;
+
+        /** Obstacles around the robot, NULL if there is no costmap. */
+        const LocalCostmap* costmap;
 
         /** Disable copy constructor. */
         ObjectDetector(const ObjectDetector& source);
@@ -0,0 +1,194 @@
+#include "vectorfieldhistogram.h"
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+#include "data/footprint.h"
+
+/** Sectors of the histogram, 5 degrees each. */
+static const int SECTORS = 72;
+
+/** Readings further than this are ignored, in meters. */
+static const float WINDOW = 1.5;
+
+/** Radius obstacles are widened by, in meters. The margin is wide as
+ *  sonar readings come from a few sparse beams.
+ */
+static const double WIDENING = ROBOT_RADIUS + 0.16;
+
+/** Density above which a sector is blocked, and below which it is free
+ *  again. A reading adds the window minus its distance, in meters.
+ */
+static const float BLOCKED = 0.7, FREED = 0.5;
+
+/** Gaps wider than this many sectors get a candidate at either edge. */
+static const int WIDE_GAP = 16;
+
+/** Weights of the difference of a candidate from the goal direction,
+ *  from the current heading and from the last choice.
+ */
+static const int GOAL_WEIGHT = 5, HEADING_WEIGHT = 2, LAST_WEIGHT = 2;
+
+/** Top speeds, in meters and radians per second, and turn gain. */
+static const double MAX_SPEED = 0.3, MAX_TURN = 0.8, TURN_GAIN = 1.5;
+
+/** @return Sectors between two sectors, the short way round. */
+static int sectorDistance(int a, int b) {
+    int d = abs(a - b) % SECTORS;
+    return std::min(d, SECTORS - d);
+}
+
+/** @return The sector holding an angle in the robot frame. */
+static int toSector(double angle) {
+    int k = (int)floor(angle / (2 * M_PI / SECTORS) + 0.5) % SECTORS;
+    return k < 0 ? k + SECTORS : k;
+}
+
+/** @return The centre of a sector, in [-pi, pi). */
+static double toAngle(int sector) {
+    return (sector < SECTORS / 2 ? sector : sector - SECTORS) * 2 * M_PI / SECTORS;
+}
+
+VectorFieldHistogram::VectorFieldHistogram() {
+    tableSize = 0;
+    tableFirst = tableLast = 0;
+    histogram.assign(SECTORS, 0);
+    smoothed.assign(SECTORS, 0);
+    blocked.assign(SECTORS, 0);
+    lastSector = -1;
+    lastHeading = 0;
+
+    //a reading is widened by the angle the robot covers at its distance
+    spread.resize((int)(WINDOW * 100) + 1);
+    for (unsigned int cm = 0; cm < spread.size(); cm++) {
+        double d = std::max(cm / 100.0, 0.01);
+        double angle = d <= WIDENING ? M_PI / 2 : asin(WIDENING / d);
+        spread[cm] = (uint8_t)ceil(angle / (2 * M_PI / SECTORS));
+    }
+}
+
+int VectorFieldHistogram::getSectors() {
+    return SECTORS;
+}
+
+Motion VectorFieldHistogram::steer(const RangerData& data, double goal,
+                                   double heading) {
+    buildHistogram(data);
+    int target = toSector(goal);
+    if (lastSector >= 0)
+        lastSector = toSector(lastHeading - heading);
+    int sector = pickSector(target);
+
+    Motion m;
+    if (sector < 0) {
+        //boxed in, turn on the spot towards the goal
+        m.yaw = toAngle(target) >= 0 ? MAX_TURN : -MAX_TURN;
+        lastSector = -1;
+    lastHeading = 0;
+    }
+    else {
+        //slower the sharper the turn and the denser the obstacles that way
+        double angle = toAngle(sector);
+        m.yaw = std::max(-MAX_TURN, std::min(MAX_TURN, TURN_GAIN * angle));
+        m.x = MAX_SPEED * std::max(0.0, cos(angle)) *
+              (1 - std::min(smoothed[sector], BLOCKED) / BLOCKED);
+        lastSector = sector;
+        lastHeading = heading + angle;
+    }
+    return m;
+}
+
+void VectorFieldHistogram::buildTables(const Scan& scan) {
+    readingSector.resize(scan.size);
+    readingOffset.resize(scan.size);
+    for (unsigned int i = 0; i < scan.size; i++) {
+        readingSector[i] = toSector(scan.angle[i]);
+        readingOffset[i] = scan.originX[i] * scan.cosAngle[i] +
+                           scan.originY[i] * scan.sinAngle[i];
+    }
+    tableSize = scan.size;
+    tableFirst = scan.size > 0 ? scan.angle[0] : 0;
+    tableLast = scan.size > 0 ? scan.angle[scan.size - 1] : 0;
+}
+
+void VectorFieldHistogram::buildHistogram(const RangerData& data) {
+    const Scan& scan = data.scan;
+    if (scan.size != tableSize || (scan.size > 0 &&
+        (scan.angle[0] != tableFirst || scan.angle[scan.size - 1] != tableLast)))
+        buildTables(scan);
+
+    //densest reading covering each sector
+    std::fill(histogram.begin(), histogram.end(), 0.0f);
+    for (unsigned int i = 0; i < scan.size; i++) {
+        float d = scan.range[i] + readingOffset[i];
+        if (d >= WINDOW || scan.range[i] >= data.maxRange)
+            continue;
+        float density = WINDOW - d;
+        int k = readingSector[i], s = spread[(int)(std::max(d, 0.0f) * 100)];
+        for (int j = k - s; j <= k + s; j++) {
+            float& h = histogram[(j + SECTORS) % SECTORS];
+            h = std::max(h, density);
+        }
+    }
+
+    //smooth with weights 1 2 3 2 1
+    for (int k = 0; k < SECTORS; k++) {
+        float sum = 0;
+        for (int j = -2; j <= 2; j++)
+            sum += (3 - abs(j)) * histogram[(k + j + SECTORS) % SECTORS];
+        smoothed[k] = sum / 9;
+    }
+
+    //blocked above one threshold, free below the other, else as it was
+    for (int k = 0; k < SECTORS; k++) {
+        if (smoothed[k] > BLOCKED)
+            blocked[k] = 1;
+        else if (smoothed[k] < FREED)
+            blocked[k] = 0;
+    }
+}
+
+int VectorFieldHistogram::pickSector(int target) {
+    //start from a blocked sector so no gap wraps past the end
+    int first = -1;
+    for (int k = 0; k < SECTORS && first < 0; k++)
+        if (blocked[k])
+            first = k;
+    candidates.clear();
+    if (first < 0)
+        candidates.push_back(target);
+    else {
+        for (int i = 1; i <= SECTORS; i++) {
+            if (blocked[(first + i) % SECTORS])
+                continue;
+
+            //a gap from left to right
+            int left = first + i, right = left;
+            while (right + 1 < first + SECTORS && !blocked[(right + 1) % SECTORS])
+                right++;
+            i = right - first;
+            if (right - left + 1 <= WIDE_GAP)
+                candidates.push_back(((left + right) / 2) % SECTORS);
+            else {
+                candidates.push_back((left + WIDE_GAP / 2) % SECTORS);
+                candidates.push_back((right - WIDE_GAP / 2) % SECTORS);
+                int t = target < first ? target + SECTORS : target;
+                if (t >= left && t <= right)
+                    candidates.push_back(target);
+            }
+        }
+    }
+
+    int best = -1, bestCost = 0;
+    for (unsigned int i = 0; i < candidates.size(); i++) {
+        int c = candidates[i];
+        int cost = GOAL_WEIGHT * sectorDistance(c, target) +
+                   HEADING_WEIGHT * sectorDistance(c, 0);
+        if (lastSector >= 0)
+            cost += LAST_WEIGHT * sectorDistance(c, lastSector);
+        if (best < 0 || cost < bestCost) {
+            best = c;
+            bestCost = cost;
+        }
+    }
+    return best;
+}
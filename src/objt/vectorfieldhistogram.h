@@ -0,0 +1,103 @@
+/** @file       src/objt/vectorfieldhistogram.h
+    @ingroup    OBJT
+    @brief      VFH+ steering around obstacles.
+    @author     Alex Moriarty <alexander@dal.ca>
+    @author     Jacob Perron <perronj@yorku.ca>
+*/
+
+#ifndef __OBJT_VECTORFIELDHISTOGRAM_H_
+#define __OBJT_VECTORFIELDHISTOGRAM_H_
+
+#include <stdint.h>
+#include <vector>
+#include <sstream>
+#include "data/motion.h"
+#include "data/rangerdata.h"
+
+/** Picks a direction to drive in from ranger readings, by VFH+.
+ *
+ *  The readings within a window around the robot are binned into a polar
+ *  histogram of obstacle density, every reading widened by the robot
+ *  radius so the robot can be treated as a point. The histogram is
+ *  smoothed and turned into free and blocked sectors, with hysteresis so
+ *  a sector on the edge does not flicker. Of the gaps between blocked
+ *  sectors, the direction closest to the goal, to the current heading
+ *  and to the last choice is steered towards, slower the denser the
+ *  obstacles that way.
+ *
+ *  The sector of every reading and the widening at every distance are
+ *  kept in tables, the former rebuilt only when the geometry of the
+ *  ranger changes, so a scan costs one pass over its readings.
+ */
+class VectorFieldHistogram {
+    public:
+
+        /** Constructor. */
+        VectorFieldHistogram();
+
+        /** Steers towards a goal around the obstacles in a scan.
+         *
+         *  @param data : The ranger readings.
+         *
+         *  @param goal : Direction of the goal in the robot frame, in
+         *      radians.
+         *
+         *  @param heading : Heading of the robot in the world, in radians.
+         *      The last choice is kept in the world, so it still points
+         *      the same way after the robot turned.
+         *
+         *  @return The motion to drive with. With no gap wide enough to
+         *      pass, a turn on the spot towards the goal.
+         */
+        Motion steer(const RangerData& data, double goal, double heading);
+
+        /** @return Sector last steered into, in the robot frame when it
+         *      was chosen, -1 if boxed in.
+         */
+        int getSector() const { return lastSector; }
+
+        /** @return Number of sectors of the histogram. */
+        static int getSectors();
+
+    private:
+
+        /** Rebuilds the sector of every reading for a scan geometry. */
+        void buildTables(const Scan& scan);
+
+        /** Bins a scan into @ref histogram and smooths it. */
+        void buildHistogram(const RangerData& data);
+
+        /** @return The sector to steer into, or -1 if all are blocked. */
+        int pickSector(int target);
+
+        /** Sector of each reading, and how far ahead of the robot centre
+         *  along the reading the ranger sits.
+         */
+        std::vector<int> readingSector;
+        std::vector<float> readingOffset;
+
+        /** Geometry the reading tables were built for. */
+        unsigned int tableSize;
+        float tableFirst, tableLast;
+
+        /** Sectors a reading is widened by either side, per centimeter. */
+        std::vector<uint8_t> spread;
+
+        /** Obstacle density per sector, raw and smoothed. */
+        std::vector<float> histogram, smoothed;
+
+        /** Whether each sector is blocked. */
+        std::vector<uint8_t> blocked;
+
+        /** Gaps found by @ref pickSector , kept to reuse the storage. */
+        std::vector<int> candidates;
+
+        /** Sector last steered into, in the robot frame of the current
+         *  scan while it is processed, -1 if none.
+         */
+        int lastSector;
+
+        /** Direction last steered into, in the world. */
+        double lastHeading;
+};
+#endif
@@ -0,0 +1,63 @@
+#include "costmap.h"
+#include <string.h>
+#include "util/scheduler.h"
+
+CREATE_LOGGER("Costmap");
+
+const uint8_t Costmap::FREE;
+const uint8_t Costmap::INSCRIBED;
+const uint8_t Costmap::LETHAL;
+
+Costmap::Costmap(const Map& m) {
+    map = &m;
+    width = m.getWidth();
+    height = m.getHeight();
+    costs.assign((size_t)width * height, FREE);
+    updates = cells = 0;
+    time = 0;
+    LOG_CTOR << "Constructed." << std::endl;
+}
+
+Costmap::~Costmap() {
+    LOG_DTOR << "Destructed." << std::endl;
+}
+
+void Costmap::addLayer(CostmapLayer* layer) {
+    layers.push_back(layer);
+}
+
+Bounds Costmap::update() {
+    int64_t start = Scheduler::now();
+
+    //each layer grows the window by what it changed
+    Bounds window;
+    for (unsigned int i = 0; i < layers.size(); i++)
+        layers[i].updateBounds(window);
+    window.clip(width, height);
+    if (window.isEmpty())
+        return window;
+
+    //rebuild the window from the bottom layer up
+    int n = window.x1 - window.x0 + 1;
+    for (int y = window.y0; y <= window.y1; y++)
+        memset(&costs[(size_t)y * width + window.x0], FREE, n);
+    for (unsigned int i = 0; i < layers.size(); i++)
+        layers[i].updateCosts(*this, window);
+
+    updates++;
+    cells += (unsigned long)n * (window.y1 - window.y0 + 1);
+    time += Scheduler::now() - start;
+    LOG_DEBUG << "Updated " << n << "x" << (window.y1 - window.y0 + 1)
+              << " cells." << std::endl;
+    return window;
+}
+
+std::string Costmap::toString() {
+    std::stringstream ss;
+    ss << "Costmap: " << updates << " updates";
+    if (updates > 0)
+        ss << " of " << cells / updates << " cells in "
+           << time / 1e6 / updates << " ms on average";
+    ss << ".";
+    return ss.str();
+}
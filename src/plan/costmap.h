@@ -0,0 +1,145 @@
+/** @file       src/plan/costmap.h
+    @ingroup    PLAN
+    @brief      Layered costmap over the Map.
+    @author     Alex Moriarty <alexander@dal.ca>
+    @author     Jacob Perron <perronj@yorku.ca>
+*/
+
+#ifndef __PLAN_COSTMAP_H_
+#define __PLAN_COSTMAP_H_
+
+#include <stdint.h>
+#include <vector>
+#include <sstream>
+#include <boost/ptr_container/ptr_vector.hpp>
+#include "infs/module.h"
+#include "data/bounds.h"
+#include "plan/map.h"
+
+class Costmap;
+
+/** One source of cost in a Costmap.
+ *
+ *  Every update a layer first reports the window of cells it changed
+ *  since the last update, then writes its costs into that window of the
+ *  master grid.
+ */
+class CostmapLayer {
+    public:
+
+        /** Destructor. */
+        virtual ~CostmapLayer() { }
+
+        /** Adds the cells this layer changed since the last update.
+         *
+         *  @param bounds : The window changed by the layers below, grown
+         *      to cover the cells of this layer.
+         */
+        virtual void updateBounds(Bounds& bounds) = 0;
+
+        /** Writes the costs of this layer into a window of the master.
+         *
+         *  The window was reset to Costmap::FREE and holds the costs of
+         *  the layers below. Layers only ever raise a cost.
+         */
+        virtual void updateCosts(Costmap& master, const Bounds& window) = 0;
+};
+
+/** A grid of traversal costs, built from a stack of layers.
+ *
+ *  The costmap covers the same cells as the Map it is made for. Each
+ *  cell holds a cost from @ref FREE to @ref LETHAL , the highest of what
+ *  the layers put there. Layers are applied in the order they were
+ *  added, so an inflation layer goes last to see every obstacle below.
+ *
+ *  An update asks every layer for the window it changed and recomputes
+ *  only the union of those windows, so its cost follows the size of the
+ *  change rather than the size of the map.
+ */
+class Costmap : public Module {
+    public:
+
+        /** No cost. */
+        static const uint8_t FREE = 0;
+
+        /** The robot centred here would touch an obstacle. */
+        static const uint8_t INSCRIBED = 253;
+
+        /** An obstacle. */
+        static const uint8_t LETHAL = 254;
+
+        /** Constructor, a free grid over the cells of a map.
+         *
+         *  @param map : The map, which must outlive the costmap.
+         */
+        Costmap(const Map& map);
+
+        /** Destructor, deletes the layers. */
+        ~Costmap();
+
+        /** Adds a layer on top of the others.
+         *
+         *  @param layer : Allocated with new, deleted by the costmap.
+         */
+        void addLayer(CostmapLayer* layer);
+
+        /** Recomputes the cells the layers changed.
+         *
+         *  @return The window that was recomputed, empty if none.
+         */
+        Bounds update();
+
+        /** @return Cost of a cell, which must be on the map. */
+        uint8_t getCost(int x, int y) const {
+            return costs[y * width + x];
+        }
+
+        /** Raises the cost of a cell, which must be on the map. */
+        void raiseCost(int x, int y, uint8_t cost) {
+            uint8_t& c = costs[y * width + x];
+            if (cost > c)
+                c = cost;
+        }
+
+        /** @return The map the costmap is laid over. */
+        const Map& getMap() const { return *map; }
+
+        /** @return Width of the grid in cells. */
+        int getWidth() const { return width; }
+
+        /** @return Height of the grid in cells. */
+        int getHeight() const { return height; }
+
+        /** Returns the number of updates and their mean size and time. */
+        std::string toString();
+
+    private:
+
+        /** Disable default constructor. */
+        Costmap();
+
+        /** Disable copy constructor. */
+        Costmap(const Costmap& source);
+
+        /** Disable assignment operator. */
+        Costmap& operator=(const Costmap& source);
+
+        /** The map the costmap is laid over. */
+        const Map* map;
+
+        /** Size of the grid in cells. */
+        int width, height;
+
+        /** The layers, bottom first. */
+        boost::ptr_vector<CostmapLayer> layers;
+
+        /** Cost of every cell, row by row. */
+        std::vector<uint8_t> costs;
+
+        /** Statistics. */
+        unsigned long updates, cells;
+
+        /** Time spent in @ref update , in nanoseconds. */
+        int64_t time;
+};
+#endif
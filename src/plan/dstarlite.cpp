@@ -0,0 +1,370 @@
+#include "dstarlite.h"
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+#include "util/geometry.h"
+
+static const float INF = HUGE_VALF;
+
+/** Relative rounding error allowed when comparing keys. */
+static const float KEY_TOLERANCE = 1e-5f;
+
+static const int DX[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+static const int DY[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+
+/** Furthest a start on an obstacle is moved to an open cell, in meters,
+ *  well beyond the error of the localization.
+ */
+static const double START_REACH = 0.5;
+
+/** Neighbour k of a cell has the cell as neighbour OPPOSITE[k]. */
+static const int OPPOSITE[8] = { 1, 0, 3, 2, 7, 6, 5, 4 };
+
+DStarLite::DStarLite() {
+    map = NULL;
+    width = height = 0;
+    startX = startY = lastX = lastY = 0;
+    goal = -1;
+    km = 0;
+    radius = 0;
+    footprint = false;
+    replans = 0;
+    expanded = 0;
+}
+
+DStarLite::~DStarLite() {
+}
+
+void DStarLite::setRadius(double r) {
+    radius = r;
+}
+
+bool DStarLite::plan(const Map& m, int sx, int sy, int gx, int gy) {
+    map = &m;
+    footprint = radius > 0 && m.hasDistance();
+    if (m.getWidth() != width || m.getHeight() != height) {
+        width = m.getWidth();
+        height = m.getHeight();
+        size_t cells = (size_t)width * height;
+        g.assign(cells, INF);
+        rhs.assign(cells, INF);
+        k1.assign(cells, 0);
+        k2.assign(cells, 0);
+        slot.assign(cells, -1);
+        seen.assign(cells, 0);
+        replans = 0;
+        touched.clear();
+    }
+    else {
+        for (size_t i = 0; i < touched.size(); i++) {
+            int c = touched[i];
+            g[c] = rhs[c] = INF;
+            slot[c] = -1;
+        }
+        touched.clear();
+    }
+    heap.clear();
+    expanded = 0;
+    km = 0;
+    startX = lastX = sx;
+    startY = lastY = sy;
+    goal = -1;
+
+    if (!nearestOpen(sx, sy) || !isFree(gx, gy))
+        return false;
+    startX = lastX = sx;
+    startY = lastY = sy;
+
+    goal = gy * width + gx;
+    rhs[goal] = 0;
+    updateVertex(goal);
+    return computePath();
+}
+
+bool DStarLite::replan(int sx, int sy, const std::vector<int>& changed) {
+    if (goal < 0 || !map->inBounds(sx, sy))
+        return false;
+    bool open = nearestOpen(sx, sy);
+    expanded = 0;
+
+    //the keys in the heap were made for the old start
+    startX = sx;
+    startY = sy;
+    km += heuristic(lastX, lastY);
+    lastX = sx;
+    lastY = sy;
+
+    //a flipped cell blocks or frees the cells within the radius of it,
+    //which change their own steps and the diagonals around them
+    int reach = footprint ? (int)ceil(radius / map->getResolution()) + 1 : 1;
+    if (++replans == 0) {
+        seen.assign(seen.size(), 0);
+        replans = 1;
+    }
+    for (size_t i = 0; i < changed.size(); i++) {
+        int x = changed[i] % width;
+        int y = changed[i] / width;
+        for (int ny = y - reach; ny <= y + reach; ny++)
+            for (int nx = x - reach; nx <= x + reach; nx++) {
+                if (!map->inBounds(nx, ny))
+                    continue;
+                int n = ny * width + nx;
+                if (seen[n] == replans)
+                    continue;
+                seen[n] = replans;
+                if (n != goal)
+                    updateRhs(n);
+                updateVertex(n);
+            }
+    }
+    if (!open)
+        return false;
+    return computePath();
+}
+
+bool DStarLite::computePath() {
+    int start = startY * width + startX;
+    while (!heap.empty()) {
+        int u = heap[0];
+        //keys are sums of floats, so keys within rounding of the start's
+        //are treated as ties and still expanded
+        float s1, s2;
+        calcKey(start, s1, s2);
+        if (k1[u] > s1 + KEY_TOLERANCE * s1 && rhs[start] <= g[start])
+            break;
+
+        //the key is stale if the robot moved since it was pushed
+        float n1, n2;
+        calcKey(u, n1, n2);
+        if (k1[u] < n1 || (k1[u] == n1 && k2[u] < n2)) {
+            k1[u] = n1;
+            k2[u] = n2;
+            siftDown(0);
+            continue;
+        }
+
+        expanded++;
+        int x = u % width;
+        int y = u / width;
+        if (g[u] > rhs[u]) {
+            //cost went down, pass it on
+            g[u] = rhs[u];
+            remove(u);
+            for (int k = 0; k < 8; k++) {
+                int nx = x + DX[k];
+                int ny = y + DY[k];
+                if (!map->inBounds(nx, ny))
+                    continue;
+                int s = ny * width + nx;
+                float c = cost(nx, ny, OPPOSITE[k]) + g[u];
+                if (s != goal && c < rhs[s]) {
+                    rhs[s] = c;
+                    updateVertex(s);
+                }
+            }
+        }
+        else {
+            //cost went up, every cell that relied on it looks again
+            float old = g[u];
+            g[u] = INF;
+            for (int k = 0; k < 8; k++) {
+                int nx = x + DX[k];
+                int ny = y + DY[k];
+                if (!map->inBounds(nx, ny))
+                    continue;
+                int s = ny * width + nx;
+                if (s != goal && rhs[s] == cost(nx, ny, OPPOSITE[k]) + old)
+                    updateRhs(s);
+                updateVertex(s);
+            }
+            if (u != goal)
+                updateRhs(u);
+            updateVertex(u);
+        }
+    }
+    return rhs[start] < INF;
+}
+
+void DStarLite::updateRhs(int cell) {
+    int x = cell % width;
+    int y = cell / width;
+    float best = INF;
+    for (int k = 0; k < 8; k++) {
+        int nx = x + DX[k];
+        int ny = y + DY[k];
+        if (!map->inBounds(nx, ny))
+            continue;
+        float c = cost(x, y, k) + g[ny * width + nx];
+        if (c < best)
+            best = c;
+    }
+    rhs[cell] = best;
+}
+
+void DStarLite::updateVertex(int cell) {
+    if (g[cell] != rhs[cell]) {
+        calcKey(cell, k1[cell], k2[cell]);
+        if (slot[cell] >= 0) {
+            siftUp(slot[cell]);
+            siftDown(slot[cell]);
+        }
+        else
+            push(cell);
+    }
+    else if (slot[cell] >= 0)
+        remove(cell);
+}
+
+void DStarLite::calcKey(int cell, float& key1, float& key2) const {
+    float m = g[cell] < rhs[cell] ? g[cell] : rhs[cell];
+    key1 = m + heuristic(cell % width, cell / width) + km;
+    key2 = m;
+}
+
+float DStarLite::cost(int x, int y, int k) const {
+    int nx = x + DX[k];
+    int ny = y + DY[k];
+    if (!isOpen(x, y) || !isOpen(nx, ny))
+        return INF;
+
+    //inside the margin only steps to more clearance, so a robot that got
+    //too close to an obstacle can leave but no path goes in
+    bool leaving = inMargin(x, y);
+    if (inMargin(nx, ny) &&
+        (!leaving || map->getClearance(nx, ny) <= map->getClearance(x, y)))
+        return INF;
+    if (k < 4)
+        return 1;
+
+    //no cutting corners of obstacles, or of the margin from outside it
+    if (leaving ? !isOpen(nx, y) || !isOpen(x, ny)
+                : !isFree(nx, y) || !isFree(x, ny))
+        return INF;
+    return SQRT2;
+}
+
+bool DStarLite::nearestOpen(int& x, int& y) const {
+    if (isOpen(x, y))
+        return true;
+    int reach = std::max(1, (int)ceil(START_REACH / map->getResolution()));
+    int best = reach * reach + 1, bx = x, by = y;
+    for (int j = -reach; j <= reach; j++)
+        for (int i = -reach; i <= reach; i++)
+            if (i * i + j * j < best && isOpen(x + i, y + j)) {
+                best = i * i + j * j;
+                bx = x + i;
+                by = y + j;
+            }
+    x = bx;
+    y = by;
+    return best <= reach * reach;
+}
+
+float DStarLite::heuristic(int x, int y) const {
+    int dx = abs(x - startX);
+    int dy = abs(y - startY);
+    return dx > dy ? dx + (SQRT2 - 1) * dy : dy + (SQRT2 - 1) * dx;
+}
+
+bool DStarLite::getPath(std::vector<int>& path) const {
+    path.clear();
+    if (goal < 0 || getCost() == INF)
+        return false;
+
+    //walk downhill on the cost to the goal
+    int x = startX, y = startY;
+    int cell = y * width + x;
+    path.push_back(cell);
+    for (int steps = width * height; cell != goal && steps > 0; steps--) {
+        float best = INF;
+        int next = -1;
+        for (int k = 0; k < 8; k++) {
+            int nx = x + DX[k];
+            int ny = y + DY[k];
+            if (!map->inBounds(nx, ny))
+                continue;
+            float c = cost(x, y, k) + g[ny * width + nx];
+            if (c < best) {
+                best = c;
+                next = k;
+            }
+        }
+        if (next < 0)
+            break;
+        x += DX[next];
+        y += DY[next];
+        cell = y * width + x;
+        path.push_back(cell);
+    }
+
+    if (cell != goal) {
+        path.clear();
+        return false;
+    }
+    return true;
+}
+
+float DStarLite::getCost() const {
+    if (goal < 0)
+        return INF;
+    return rhs[startY * width + startX];
+}
+
+void DStarLite::push(int cell) {
+    if (slot[cell] == -1)
+        touched.push_back(cell);
+    slot[cell] = heap.size();
+    heap.push_back(cell);
+    siftUp(slot[cell]);
+}
+
+void DStarLite::remove(int cell) {
+    int i = slot[cell];
+    int last = heap.back();
+    heap.pop_back();
+    slot[cell] = -2;
+    if (last != cell) {
+        heap[i] = last;
+        slot[last] = i;
+        siftUp(i);
+        siftDown(slot[last]);
+    }
+}
+
+/** Heap order: lower k1 first, ties to the lower k2. */
+#define BEFORE(a, b) (k1[a] < k1[b] || (k1[a] == k1[b] && k2[a] < k2[b]))
+
+void DStarLite::siftUp(int i) {
+    int cell = heap[i];
+    while (i > 0) {
+        int up = (i - 1) >> 1;
+        if (!BEFORE(cell, heap[up]))
+            break;
+        heap[i] = heap[up];
+        slot[heap[i]] = i;
+        i = up;
+    }
+    heap[i] = cell;
+    slot[cell] = i;
+}
+
+void DStarLite::siftDown(int i) {
+    int n = heap.size();
+    int cell = heap[i];
+    while (true) {
+        int child = 2 * i + 1;
+        if (child >= n)
+            break;
+        if (child + 1 < n && BEFORE(heap[child + 1], heap[child]))
+            child++;
+        if (!BEFORE(heap[child], cell))
+            break;
+        heap[i] = heap[child];
+        slot[heap[i]] = i;
+        i = child;
+    }
+    heap[i] = cell;
+    slot[cell] = i;
+}
+
+#undef BEFORE
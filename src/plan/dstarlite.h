@@ -0,0 +1,209 @@
+/** @file       src/plan/dstarlite.h
+    @ingroup    PLAN
+    @brief      Incremental replanning over the Map with D* Lite.
+    @author     Alex Moriarty <alexander@dal.ca>
+    @author     Jacob Perron <perronj@yorku.ca>
+*/
+
+#ifndef __PLAN_DSTARLITE_H_
+#define __PLAN_DSTARLITE_H_
+
+#include <stdint.h>
+#include <vector>
+#include "plan/map.h"
+
+/** Keeps a shortest path to a goal up to date while the Map changes.
+ *
+ *  D* Lite (Koenig and Likhachev) searches backwards, from the goal to
+ *  the robot, and keeps the cost to the goal of every cell it settled
+ *  (@c g ) together with a one-step lookahead of it (@c rhs ). When cells
+ *  of the map flip between free and occupied only those cells and their
+ *  neighbours are updated; the search then resumes from the open list it
+ *  kept and only repairs the costs that actually changed, near the new
+ *  obstacles and between them and the robot. As the robot moves, the
+ *  keys already in the open list stay valid by adding the distance moved
+ *  to an offset (@c km ) rather than reordering the heap.
+ *
+ *  The grid, step costs, corner rule and radius are those of GridPlanner,
+ *  and the heuristic is the octile distance to the robot. Unlike there,
+ *  a robot already closer to an obstacle than the radius is not stuck:
+ *  inside that margin steps are allowed away from the obstacles, so a
+ *  path leads out of it, but no path leads into it. A start on an
+ *  obstacle, where localization error can put the robot, is moved to the
+ *  nearest open cell. The open list
+ *  is an indexed binary heap, so cells are updated and removed in place.
+ *  The per cell buffers are only sized again when the map size changes;
+ *  otherwise @ref plan resets just the cells the last plan touched.
+ */
+class DStarLite {
+    public:
+
+        /** Default constructor. */
+        DStarLite();
+
+        /** Destructor. */
+        ~DStarLite();
+
+        /** Sets the least clearance of a path, see GridPlanner::setRadius .
+         *
+         *  @param r : Radius of the robot in meters, 0 to only keep off
+         *      the obstacles.
+         */
+        void setRadius(double r);
+
+        /** Plans from scratch.
+         *
+         *  @param map : The map to plan on, which must outlive the
+         *      planner or the next call to plan.
+         *
+         *  @param sx, sy : The start cell, where the robot is.
+         *
+         *  @param gx, gy : The goal cell.
+         *
+         *  @return False if the goal cannot be reached, the start is
+         *      deep inside an obstacle or the goal is closer to one than
+         *      the radius.
+         */
+        bool plan(const Map& map, int sx, int sy, int gx, int gy);
+
+        /** Repairs the plan after the robot moved and the map changed.
+         *
+         *  @param sx, sy : The new start cell.
+         *
+         *  @param changed : Cells that flipped since the last call, as
+         *      y*width+x, see Map::takeChanges .
+         *
+         *  @return False if the goal cannot be reached anymore, such as
+         *      from a start deep inside an obstacle.
+         */
+        bool replan(int sx, int sy, const std::vector<int>& changed);
+
+        /** Follows the plan from the start to the goal.
+         *
+         *  @param path : Filled with the cells of the path, start first,
+         *      as indices y*width+x.
+         *
+         *  @return False if there is no path.
+         */
+        bool getPath(std::vector<int>& path) const;
+
+        /** @return Cost of the path from the start, in cells. */
+        float getCost() const;
+
+        /** @return Number of cells expanded by the last plan or replan. */
+        unsigned long getExpanded() const { return expanded; }
+
+    private:
+
+        /** Disable copy constructor. */
+        DStarLite(const DStarLite& source);
+
+        /** Disable assignment operator. */
+        DStarLite& operator=(const DStarLite& source);
+
+        /** Expands cells until the start is settled. */
+        bool computePath();
+
+        /** Recomputes the lookahead cost of a cell from its neighbours. */
+        void updateRhs(int cell);
+
+        /** Puts a cell on, moves it in or takes it off the open list,
+         *  depending on whether it is consistent (g equals rhs).
+         */
+        void updateVertex(int cell);
+
+        /** Sets the key of a cell from its costs and the heuristic. */
+        void calcKey(int cell, float& k1, float& k2) const;
+
+        /** @return Cost of the step from a cell to neighbour k, infinite
+         *      if either cell is blocked, the step cuts a corner or it
+         *      goes into the margin rather than out of it.
+         */
+        float cost(int x, int y, int k) const;
+
+        /** Moves a cell on an obstacle to the nearest open cell.
+         *
+         *  @return False if there is none.
+         */
+        bool nearestOpen(int& x, int& y) const;
+
+        /** @return Octile distance from a cell to the start. */
+        float heuristic(int x, int y) const;
+
+        /** @return True if the cell is on the map and not occupied. */
+        bool isOpen(int x, int y) const {
+            return map->inBounds(x, y) && !map->isOccupied(x, y);
+        }
+
+        /** @return True if the cell is closer to an obstacle than the
+         *      radius, which must be on the map.
+         */
+        bool inMargin(int x, int y) const {
+            return footprint && map->getClearance(x, y) < radius;
+        }
+
+        /** @return True if the cell is on the map, free and at least
+         *      the radius away from every obstacle.
+         */
+        bool isFree(int x, int y) const {
+            return isOpen(x, y) && !inMargin(x, y);
+        }
+
+        /** Heap operations on the open list. */
+        void push(int cell);
+        void remove(int cell);
+        void siftUp(int slot);
+        void siftDown(int slot);
+
+        /** Map being planned on. */
+        const Map* map;
+
+        /** Size of the map. */
+        int width, height;
+
+        /** Least clearance of a path in meters. */
+        float radius;
+
+        /** True if @ref radius is checked, once the map has distances. */
+        bool footprint;
+
+        /** Start and goal cells. */
+        int startX, startY, goal;
+
+        /** Start of the previous replan, for @ref km . */
+        int lastX, lastY;
+
+        /** Heuristic offset, the distance the robot moved so far. */
+        float km;
+
+        /** Cost to the goal, and its one-step lookahead, per cell. */
+        std::vector<float> g, rhs;
+
+        /** Key of each open cell, compared first by k1 then by k2. */
+        std::vector<float> k1, k2;
+
+        /** Slot of each open cell in @ref heap , -1 for cells no plan
+         *  touched yet and -2 for cells that left the open list.
+         */
+        std::vector<int32_t> slot;
+
+        /** Cells put on the open list since the last @ref plan , the only
+         *  ones whose costs are not infinite.
+         */
+        std::vector<int32_t> touched;
+
+        /** Replan each cell was last updated in, so cells near several
+         *  changes are updated once.
+         */
+        std::vector<uint32_t> seen;
+
+        /** Number of the current replan, for @ref seen . */
+        uint32_t replans;
+
+        /** The open list, a binary heap of cells ordered by key. */
+        std::vector<int32_t> heap;
+
+        /** Statistics. */
+        unsigned long expanded;
+};
+#endif
@@ -0,0 +1,226 @@
+#include "dynamicwindow.h"
+#include <math.h>
+#include <algorithm>
+#include "data/footprint.h"
+#include "util/geometry.h"
+#include "util/scheduler.h"
+
+CREATE_LOGGER("DynamicWindow");
+
+/** Top speeds, in meters and radians per second. */
+static const double MAX_SPEED = 0.5, MAX_TURN = 1.0;
+
+/** Acceleration limits, in meters and radians per second squared. */
+static const double ACCEL = 1.0, TURN_ACCEL = 2.0;
+
+/** Speeds sampled from 0 to MAX_SPEED, and turn rates from -MAX_TURN to
+ *  MAX_TURN, at 1.25 cm/s and 0.025 rad/s apart.
+ */
+static const int SPEEDS = 41, TURNS = 81;
+
+/** Arcs are driven this far ahead, in seconds, in STEPS points. */
+static const double AHEAD = 1.5;
+static const int STEPS = 15;
+
+/** Least clearance of an arc, in meters. The margin covers the distance
+ *  the robot drifts off an arc within one period.
+ */
+static const double LEAST_CLEARANCE = ROBOT_RADIUS + 0.06;
+
+/** Clearance beyond this counts as open space, in meters. */
+static const double CLEARANCE_CAP = 0.6;
+
+/** Weights of heading towards the target, clearance and speed. */
+static const double HEADING_WEIGHT = 1.0, CLEARANCE_WEIGHT = 0.4,
+                    SPEED_WEIGHT = 0.4;
+
+/** Point of an arc driven at constant speeds, in the robot frame.
+ *
+ *  @param t : Time driven, in seconds.
+ */
+static void arcPoint(double v, double w, double t, float& x, float& y) {
+    if (fabs(w) < 1e-6) {
+        x = v * t;
+        y = 0;
+    }
+    else {
+        x = v / w * sin(w * t);
+        y = v / w * (1 - cos(w * t));
+    }
+}
+
+DynamicWindow::DynamicWindow(double period) {
+    this->period = period;
+    side = cornerX = cornerY = 0;
+    resolution = scale = 0;
+    plans = scored = blocked = checked = vetoed = 0;
+    time = 0;
+
+    //every arc once, in the robot frame
+    arcX.resize(SPEEDS * TURNS * STEPS);
+    arcY.resize(SPEEDS * TURNS * STEPS);
+    for (int i = 0; i < SPEEDS; i++) {
+        double v = i * MAX_SPEED / (SPEEDS - 1);
+        for (int j = 0; j < TURNS; j++) {
+            double w = -MAX_TURN + j * 2 * MAX_TURN / (TURNS - 1);
+            float* x = &arcX[(i * TURNS + j) * STEPS];
+            float* y = &arcY[(i * TURNS + j) * STEPS];
+            for (int k = 0; k < STEPS; k++)
+                arcPoint(v, w, (k + 1) * AHEAD / STEPS, x[k], y[k]);
+        }
+    }
+    LOG_CTOR << "Constructed." << std::endl;
+}
+
+DynamicWindow::~DynamicWindow() {
+    LOG_DTOR << "Destructed." << std::endl;
+}
+
+Motion DynamicWindow::plan(const LocalCostmap& costmap, const Position& target,
+                           const Motion& current) {
+    int64_t start = Scheduler::now();
+    buildClearance(costmap);
+    const Position& robot = costmap.getRobot();
+    double c = cos(robot.yaw), s = sin(robot.yaw);
+
+    //arcs may not get closer to obstacles than the robot already is
+    float limit = std::min((float)LEAST_CLEARANCE, clearanceAt(robot.x, robot.y));
+
+    //slow enough to stop at the target
+    double distance = hypot(target.x - robot.x, target.y - robot.y);
+    double topSpeed = std::min(MAX_SPEED, sqrt(2 * ACCEL * distance));
+
+    //the speeds reachable within one period, as sample indices
+    double dv = MAX_SPEED / (SPEEDS - 1), dw = 2 * MAX_TURN / (TURNS - 1);
+    int i0 = std::max(0, (int)ceil((current.x - ACCEL * period) / dv - 1e-9));
+    int i1 = std::min((int)floor(topSpeed / dv + 1e-9),
+                      (int)floor((current.x + ACCEL * period) / dv + 1e-9));
+    i1 = std::min(std::max(i1, i0), SPEEDS - 1);
+    i0 = std::min(i0, i1);
+    int j0 = std::max(0, (int)ceil((current.yaw - TURN_ACCEL * period + MAX_TURN) / dw - 1e-9));
+    int j1 = std::min(TURNS - 1,
+                      (int)floor((current.yaw + TURN_ACCEL * period + MAX_TURN) / dw + 1e-9));
+    j1 = std::max(j1, std::min(j0, TURNS - 1));
+    j0 = std::min(j0, j1);
+
+    Motion best;
+    double bestScore = -HUGE_VAL;
+    for (int i = i0; i <= i1; i++) {
+        for (int j = j0; j <= j1; j++) {
+            const float* x = &arcX[(i * TURNS + j) * STEPS];
+            const float* y = &arcY[(i * TURNS + j) * STEPS];
+
+            //closest the arc comes to an obstacle
+            float closest = CLEARANCE_CAP;
+            for (int k = 0; k < STEPS && closest >= limit; k++)
+                closest = std::min(closest, clearanceAt(robot.x + c * x[k] - s * y[k],
+                                                        robot.y + s * x[k] + c * y[k]));
+            scored++;
+            if (closest < limit)
+                continue;
+
+            //how straight at the target the end of the arc points
+            double w = -MAX_TURN + j * dw;
+            double ex = robot.x + c * x[STEPS - 1] - s * y[STEPS - 1];
+            double ey = robot.y + s * x[STEPS - 1] + c * y[STEPS - 1];
+            double off = atan2(target.y - ey, target.x - ex) - (robot.yaw + w * AHEAD);
+            off = fabs(wrapAngle(off));
+
+            double score = HEADING_WEIGHT * (1 - off / M_PI) +
+                           CLEARANCE_WEIGHT * closest / CLEARANCE_CAP +
+                           SPEED_WEIGHT * i / (SPEEDS - 1);
+            if (score > bestScore) {
+                bestScore = score;
+                best = Motion(i * dv, w);
+            }
+        }
+    }
+
+    plans++;
+    if (bestScore == -HUGE_VAL) {
+        blocked++;
+        LOG_DEBUG << "Every arc in the window is blocked." << std::endl;
+    }
+    time += Scheduler::now() - start;
+    return best;
+}
+
+bool DynamicWindow::isClear(const LocalCostmap& costmap, const Motion& motion) {
+    int64_t start = Scheduler::now();
+    buildClearance(costmap);
+    const Position& robot = costmap.getRobot();
+    double c = cos(robot.yaw), s = sin(robot.yaw);
+    float limit = std::min((float)LEAST_CLEARANCE, clearanceAt(robot.x, robot.y));
+
+    bool clear = true;
+    for (int k = 0; k < STEPS && clear; k++) {
+        float x, y;
+        arcPoint(motion.x, motion.yaw, (k + 1) * AHEAD / STEPS, x, y);
+        clear = clearanceAt(robot.x + c * x - s * y, robot.y + s * x + c * y) >= limit;
+    }
+
+    checked++;
+    if (!clear) {
+        vetoed++;
+        LOG_DEBUG << "Speeds " << motion.x << ", " << motion.yaw
+                  << " run into something." << std::endl;
+    }
+    time += Scheduler::now() - start;
+    return clear;
+}
+
+void DynamicWindow::buildClearance(const LocalCostmap& costmap) {
+    //big enough for the longest arc plus the capped clearance around it,
+    //with a border of open cells so the passes need no bounds checks
+    if (costmap.getResolution() != resolution) {
+        resolution = costmap.getResolution();
+        scale = 1.0 / resolution;
+        side = 2 * (int)ceil((MAX_SPEED * AHEAD + CLEARANCE_CAP) * scale) + 4;
+        clearance.resize((size_t)side * side);
+    }
+    const Position& robot = costmap.getRobot();
+    cornerX = (int)floor(robot.x * scale) - side / 2;
+    cornerY = (int)floor(robot.y * scale) - side / 2;
+
+    //3-4 chamfer distance, a cell is 3 and a diagonal 4
+    uint16_t cap = (uint16_t)ceil(CLEARANCE_CAP * scale * 3);
+    std::fill(clearance.begin(), clearance.end(), cap);
+    for (int y = 1; y < side - 1; y++) {
+        uint16_t* row = &clearance[(size_t)y * side];
+        for (int x = 1; x < side - 1; x++)
+            if (costmap.getCellCost(cornerX + x, cornerY + y) == Costmap::LETHAL)
+                row[x] = 0;
+    }
+    for (int y = 1; y < side - 1; y++) {
+        uint16_t* row = &clearance[(size_t)y * side];
+        const uint16_t* below = row - side;
+        for (int x = 1; x < side - 1; x++) {
+            int d = std::min<int>(row[x], row[x - 1] + 3);
+            d = std::min<int>(d, below[x] + 3);
+            d = std::min<int>(d, std::min(below[x - 1], below[x + 1]) + 4);
+            row[x] = (uint16_t)d;
+        }
+    }
+    for (int y = side - 2; y > 0; y--) {
+        uint16_t* row = &clearance[(size_t)y * side];
+        const uint16_t* above = row + side;
+        for (int x = side - 2; x > 0; x--) {
+            int d = std::min<int>(row[x], row[x + 1] + 3);
+            d = std::min<int>(d, above[x] + 3);
+            d = std::min<int>(d, std::min(above[x - 1], above[x + 1]) + 4);
+            row[x] = (uint16_t)d;
+        }
+    }
+}
+
+std::string DynamicWindow::toString() {
+    std::stringstream ss;
+    ss << "DynamicWindow: " << plans << " plans, " << scored << " arcs scored, "
+       << blocked << " blocked";
+    if (plans + checked > 0)
+        ss << ", " << time / 1e3 / (plans + checked) << " us per plan";
+    ss << ", " << checked << " speeds from elsewhere checked, " << vetoed
+       << " of them blocked";
+    ss << ".";
+    return ss.str();
+}
@@ -0,0 +1,125 @@
+/** @file       src/plan/dynamicwindow.h
+    @ingroup    PLAN
+    @brief      Dynamic Window Approach local planner.
+    @author     Alex Moriarty <alexander@dal.ca>
+    @author     Jacob Perron <perronj@yorku.ca>
+*/
+
+#ifndef __PLAN_DYNAMICWINDOW_H_
+#define __PLAN_DYNAMICWINDOW_H_
+
+#include <stdint.h>
+#include <math.h>
+#include <algorithm>
+#include <vector>
+#include <sstream>
+#include "infs/module.h"
+#include "data/motion.h"
+#include "data/position.h"
+#include "plan/localcostmap.h"
+
+/** Picks speeds that drive towards a target without hitting anything.
+ *
+ *  Every tick, the speeds the robot can reach within one control period
+ *  from its current ones, under its acceleration limits, form the dynamic
+ *  window. Each pair of speeds in the window is driven for a short time
+ *  ahead as an arc, and the arcs that pass within the robot radius of an
+ *  obstacle are dropped. Of the rest, the one that ends up heading most
+ *  towards the target, keeps furthest from obstacles and drives fastest
+ *  is picked.
+ *
+ *  All the speeds the robot can drive at are sampled on a fixed grid, and
+ *  the arc of every pair is rolled out once, in the robot frame, when the
+ *  planner is constructed. Scoring an arc is then a rotation and a
+ *  lookup per point, in a small distance field of the obstacles around
+ *  the robot rebuilt from the LocalCostmap each tick, so the few hundred
+ *  pairs in a window cost well under a millisecond.
+ */
+class DynamicWindow : public Module {
+    public:
+
+        /** Constructor, rolls out every arc.
+         *
+         *  @param period : Time between two calls to @ref plan , in
+         *      seconds.
+         */
+        DynamicWindow(double period = 0.1);
+
+        /** Destructor. */
+        ~DynamicWindow();
+
+        /** Picks the speeds to drive at for the next period.
+         *
+         *  @param costmap : The obstacles around the robot, placed where
+         *      the robot is.
+         *
+         *  @param target : Where the robot is driving to.
+         *
+         *  @param current : The speeds the robot is driving at.
+         *
+         *  @return The best speeds in the window, or a stop if every arc
+         *      in it runs into something.
+         */
+        Motion plan(const LocalCostmap& costmap, const Position& target,
+                    const Motion& current);
+
+        /** Checks speeds picked by something else for obstacles.
+         *
+         *  @param costmap : The obstacles around the robot, placed where
+         *      the robot is.
+         *
+         *  @param motion : The speeds to drive at.
+         *
+         *  @return False if their arc runs into something, by the rule
+         *      that drops arcs in @ref plan .
+         */
+        bool isClear(const LocalCostmap& costmap, const Motion& motion);
+
+        /** @return Time between two calls to @ref plan , in seconds. */
+        double getPeriod() const { return period; }
+
+        /** Returns the number of plans, arcs scored and how long it took. */
+        std::string toString();
+
+    private:
+
+        /** Disable copy constructor. */
+        DynamicWindow(const DynamicWindow& source);
+
+        /** Disable assignment operator. */
+        DynamicWindow& operator=(const DynamicWindow& source);
+
+        /** Rebuilds @ref clearance around the robot from a costmap. */
+        void buildClearance(const LocalCostmap& costmap);
+
+        /** @return Clearance at a point of the world, in meters. */
+        float clearanceAt(double x, double y) const {
+            int cx = std::min(std::max((int)floor(x * scale) - cornerX, 0), side - 1);
+            int cy = std::min(std::max((int)floor(y * scale) - cornerY, 0), side - 1);
+            return clearance[(size_t)cy * side + cx] * (float)resolution / 3;
+        }
+
+        /** Time between two plans, in seconds. */
+        double period;
+
+        /** Points of every arc in the robot frame, STEPS per arc, arcs by
+         *  speed then turn rate.
+         */
+        std::vector<float> arcX, arcY;
+
+        /** Distance from every cell around the robot to the nearest
+         *  obstacle, in thirds of a cell, capped.
+         */
+        std::vector<uint16_t> clearance;
+
+        /** Side of @ref clearance in cells, and its lower left cell. */
+        int side, cornerX, cornerY;
+
+        /** Resolution @ref clearance was sized for, and cells per meter. */
+        double resolution, scale;
+
+        /** Statistics. */
+        unsigned long plans, scored, blocked, checked, vetoed;
+        int64_t time;
+};
+#endif
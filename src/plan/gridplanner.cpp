@@ -0,0 +1,383 @@
+#include "gridplanner.h"
+#include <math.h>
+#include <float.h>
+#include <algorithm>
+#include "util/geometry.h"
+
+GridPlanner::GridPlanner() {
+    mode = ASTAR;
+    map = NULL;
+    width = height = 0;
+    radius = 0;
+    words = 0;
+    blockedMap = NULL;
+    blockedRevision = 0;
+    blockedRadius = 0;
+    goalX = goalY = 0;
+    expanded = heapOps = 0;
+}
+
+GridPlanner::~GridPlanner() {
+}
+
+void GridPlanner::prepare(const Map& map) {
+    if (map.getWidth() == width && map.getHeight() == height)
+        return;
+
+    width = map.getWidth();
+    height = map.getHeight();
+    size_t cells = (size_t)width * height;
+    g.assign(cells, FLT_MAX);
+    f.assign(cells, FLT_MAX);
+    parent.assign(cells, -1);
+    slot.assign(cells, -1);
+    state.assign(cells, UNSEEN);
+    heap.clear();
+    heap.reserve(cells);
+    touched.clear();
+    touched.reserve(cells);
+}
+
+void GridPlanner::inflate(const Map& m) {
+    if (&m == blockedMap && m.getRevision() == blockedRevision &&
+        radius == blockedRadius && blocked.size() == (size_t)words * height)
+        return;
+    blockedMap = &m;
+    blockedRevision = m.getRevision();
+    blockedRadius = radius;
+
+    //the obstacles, then every cell too close to one
+    bool footprint = radius > 0 && m.hasDistance();
+    float limit = radius;
+    words = (width + 63) >> 6;
+    blocked.resize((size_t)words * height);
+    for (int y = 0; y < height; y++)
+        for (int w = 0; w < words; w++) {
+            uint64_t bits = m.getRowWord(w, y);
+            if (footprint) {
+                int x0 = w << 6, n = std::min(64, width - x0);
+                for (int i = 0; i < n; i++)
+                    if (m.getClearance(x0 + i, y) < limit)
+                        bits |= (uint64_t)1 << i;
+            }
+            blocked[y * words + w] = bits;
+        }
+}
+
+void GridPlanner::reset() {
+    for (size_t i = 0; i < touched.size(); i++) {
+        int c = touched[i];
+        g[c] = FLT_MAX;
+        f[c] = FLT_MAX;
+        parent[c] = -1;
+        slot[c] = -1;
+        state[c] = UNSEEN;
+    }
+    touched.clear();
+    heap.clear();
+}
+
+float GridPlanner::heuristic(int x, int y) const {
+    int dx = abs(x - goalX);
+    int dy = abs(y - goalY);
+    return dx > dy ? dx + (SQRT2 - 1) * dy : dy + (SQRT2 - 1) * dx;
+}
+
+void GridPlanner::setMode(searchMode m) {
+    mode = m;
+}
+
+void GridPlanner::setRadius(double r) {
+    radius = r;
+}
+
+bool GridPlanner::search(const Map& m, int sx, int sy, int gx, int gy,
+                         std::vector<int>& path) {
+    path.clear();
+    map = &m;
+    prepare(m);
+    inflate(m);
+    reset();
+    expanded = heapOps = 0;
+
+    if (!isFree(sx, sy) || !isFree(gx, gy))
+        return false;
+
+    goalX = gx;
+    goalY = gy;
+    int start = sy * width + sx;
+    int goal = gy * width + gx;
+    relax(sx, sy, -1, 0);
+
+    while (!heap.empty()) {
+        int cell = pop();
+        if (cell == goal)
+            break;
+        state[cell] = CLOSED;
+        expanded++;
+
+        if (mode == JUMP_POINT)
+            expandJumps(cell % width, cell / width, cell);
+        else
+            expandAll(cell % width, cell / width, cell);
+    }
+
+    if (parent[goal] < 0 && goal != start)
+        return false;
+
+    //walk back from the goal, filling in the cells between jump points
+    for (int c = goal; c >= 0; c = parent[c]) {
+        path.push_back(c);
+        int p = parent[c];
+        if (p < 0)
+            break;
+        int dx = p % width - c % width;
+        int dy = p / width - c / width;
+        int step = (dx > 0) - (dx < 0) + ((dy > 0) - (dy < 0)) * width;
+        for (int k = c + step; k != p; k += step)
+            path.push_back(k);
+    }
+    std::reverse(path.begin(), path.end());
+    return true;
+}
+
+static const int DX[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+static const int DY[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+
+void GridPlanner::expandAll(int x, int y, int cell) {
+    for (int k = 0; k < 8; k++) {
+        int nx = x + DX[k];
+        int ny = y + DY[k];
+        if (!isFree(nx, ny))
+            continue;
+        //no cutting corners of obstacles
+        if (k >= 4 && (!isFree(nx, y) || !isFree(x, ny)))
+            continue;
+        if (state[ny * width + nx] == CLOSED)
+            continue;
+        relax(nx, ny, cell, g[cell] + (k < 4 ? 1 : SQRT2));
+    }
+}
+
+void GridPlanner::expandJumps(int x, int y, int cell) {
+    //directions worth jumping in, pruned by the direction we came from
+    int dirs[8][2];
+    int n = 0;
+    if (parent[cell] < 0) {
+        for (int k = 0; k < 8; k++) {
+            if (!isFree(x + DX[k], y + DY[k]))
+                continue;
+            if (k >= 4 && (!isFree(x + DX[k], y) || !isFree(x, y + DY[k])))
+                continue;
+            dirs[n][0] = DX[k];
+            dirs[n++][1] = DY[k];
+        }
+    }
+    else {
+        int px = parent[cell] % width, py = parent[cell] / width;
+        int dx = (x > px) - (x < px);
+        int dy = (y > py) - (y < py);
+        if (dx != 0 && dy != 0) {
+            bool h = isFree(x + dx, y), v = isFree(x, y + dy);
+            if (v) { dirs[n][0] = 0; dirs[n++][1] = dy; }
+            if (h) { dirs[n][0] = dx; dirs[n++][1] = 0; }
+            if (h && v) { dirs[n][0] = dx; dirs[n++][1] = dy; }
+        }
+        else if (dx != 0) {
+            bool next = isFree(x + dx, y);
+            bool up = isFree(x, y + 1), down = isFree(x, y - 1);
+            if (next) { dirs[n][0] = dx; dirs[n++][1] = 0; }
+            if (next && up) { dirs[n][0] = dx; dirs[n++][1] = 1; }
+            if (next && down) { dirs[n][0] = dx; dirs[n++][1] = -1; }
+            if (up) { dirs[n][0] = 0; dirs[n++][1] = 1; }
+            if (down) { dirs[n][0] = 0; dirs[n++][1] = -1; }
+        }
+        else {
+            bool next = isFree(x, y + dy);
+            bool right = isFree(x + 1, y), left = isFree(x - 1, y);
+            if (next) { dirs[n][0] = 0; dirs[n++][1] = dy; }
+            if (next && right) { dirs[n][0] = 1; dirs[n++][1] = dy; }
+            if (next && left) { dirs[n][0] = -1; dirs[n++][1] = dy; }
+            if (right) { dirs[n][0] = 1; dirs[n++][1] = 0; }
+            if (left) { dirs[n][0] = -1; dirs[n++][1] = 0; }
+        }
+    }
+
+    for (int k = 0; k < n; k++) {
+        int jx = x, jy = y;
+        if (!jump(jx, jy, dirs[k][0], dirs[k][1]))
+            continue;
+        if (state[jy * width + jx] == CLOSED)
+            continue;
+        //jumps are straight or diagonal lines
+        int d = std::max(abs(jx - x), abs(jy - y));
+        relax(jx, jy, cell, g[cell] + (dirs[k][0] && dirs[k][1] ? d * SQRT2 : d));
+    }
+}
+
+bool GridPlanner::jump(int& x, int& y, int dx, int dy) {
+    if (dy == 0) {
+        x = jumpRow(x, y, dx);
+        return x >= 0;
+    }
+    if (dx == 0) {
+        y = jumpColumn(x, y, dy);
+        return y >= 0;
+    }
+
+    //diagonal, a jump point wherever a straight jump finds one
+    while (true) {
+        if (!isFree(x + dx, y) || !isFree(x, y + dy) || !isFree(x + dx, y + dy))
+            return false;
+        x += dx;
+        y += dy;
+        if (x == goalX && y == goalY)
+            return true;
+        if (jumpRow(x, y, dx) >= 0 || jumpColumn(x, y, dy) >= 0)
+            return true;
+    }
+}
+
+int GridPlanner::jumpRow(int x, int y, int dx) {
+    int c = x + dx;
+    if (c < 0 || c >= width)
+        return -1;
+    int word = c >> 6;
+
+    //a cell forces a jump point when the cell above or below it is free
+    //but the one before that, in the direction of travel, is not
+    if (dx > 0) {
+        uint64_t mask = ~(uint64_t)0 << (c & 63);
+        while (true) {
+            uint64_t b = rowBits(word, y);
+            uint64_t up = rowBits(word, y + 1), upPrev = rowBits(word - 1, y + 1);
+            uint64_t dn = rowBits(word, y - 1), dnPrev = rowBits(word - 1, y - 1);
+            uint64_t forced = (~up & ((up << 1) | (upPrev >> 63))) |
+                              (~dn & ((dn << 1) | (dnPrev >> 63)));
+            uint64_t stop = b | forced;
+            if (y == goalY && (goalX >> 6) == word)
+                stop |= (uint64_t)1 << (goalX & 63);
+            stop &= mask;
+            if (stop) {
+                int bit = __builtin_ctzll(stop);
+                if ((b >> bit) & 1)
+                    return -1;
+                return (word << 6) + bit;
+            }
+            //cells past the edge are occupied, so the loop ends there
+            word++;
+            mask = ~(uint64_t)0;
+        }
+    }
+    else {
+        uint64_t mask = (c & 63) == 63 ? ~(uint64_t)0
+                                       : ((uint64_t)1 << ((c & 63) + 1)) - 1;
+        while (true) {
+            uint64_t b = rowBits(word, y);
+            uint64_t up = rowBits(word, y + 1), upNext = rowBits(word + 1, y + 1);
+            uint64_t dn = rowBits(word, y - 1), dnNext = rowBits(word + 1, y - 1);
+            uint64_t forced = (~up & ((up >> 1) | (upNext << 63))) |
+                              (~dn & ((dn >> 1) | (dnNext << 63)));
+            uint64_t stop = b | forced;
+            if (y == goalY && (goalX >> 6) == word)
+                stop |= (uint64_t)1 << (goalX & 63);
+            stop &= mask;
+            if (stop) {
+                int bit = 63 - __builtin_clzll(stop);
+                if ((b >> bit) & 1)
+                    return -1;
+                return (word << 6) + bit;
+            }
+            word--;
+            if (word < 0)
+                return -1;
+            mask = ~(uint64_t)0;
+        }
+    }
+}
+
+int GridPlanner::jumpColumn(int x, int y, int dy) {
+    for (int cy = y + dy; ; cy += dy) {
+        if (!isFree(x, cy))
+            return -1;
+        if (x == goalX && cy == goalY)
+            return cy;
+        if ((isFree(x - 1, cy) && !isFree(x - 1, cy - dy)) ||
+            (isFree(x + 1, cy) && !isFree(x + 1, cy - dy)))
+            return cy;
+    }
+}
+
+void GridPlanner::relax(int x, int y, int from, float cost) {
+    int cell = y * width + x;
+    if (cost >= g[cell])
+        return;
+
+    if (state[cell] == UNSEEN)
+        touched.push_back(cell);
+    g[cell] = cost;
+    f[cell] = cost + heuristic(x, y);
+    parent[cell] = from;
+    heapOps++;
+
+    if (state[cell] == OPEN) {
+        siftUp(slot[cell]);
+    }
+    else {
+        state[cell] = OPEN;
+        slot[cell] = heap.size();
+        heap.push_back(cell);
+        siftUp(slot[cell]);
+    }
+}
+
+/** Heap order: lower f first, ties to the higher g (closer to the goal). */
+#define BEFORE(a, b) (f[a] < f[b] || (f[a] == f[b] && g[a] > g[b]))
+
+void GridPlanner::siftUp(int i) {
+    int cell = heap[i];
+    while (i > 0) {
+        int up = (i - 1) >> 1;
+        if (!BEFORE(cell, heap[up]))
+            break;
+        heap[i] = heap[up];
+        slot[heap[i]] = i;
+        i = up;
+    }
+    heap[i] = cell;
+    slot[cell] = i;
+}
+
+void GridPlanner::siftDown(int i) {
+    int n = heap.size();
+    int cell = heap[i];
+    while (true) {
+        int child = 2 * i + 1;
+        if (child >= n)
+            break;
+        if (child + 1 < n && BEFORE(heap[child + 1], heap[child]))
+            child++;
+        if (!BEFORE(heap[child], cell))
+            break;
+        heap[i] = heap[child];
+        slot[heap[i]] = i;
+        i = child;
+    }
+    heap[i] = cell;
+    slot[cell] = i;
+}
+
+#undef BEFORE
+
+int GridPlanner::pop() {
+    int top = heap[0];
+    int last = heap.back();
+    heap.pop_back();
+    if (!heap.empty()) {
+        heap[0] = last;
+        slot[last] = 0;
+        siftDown(0);
+    }
+    slot[top] = -1;
+    return top;
+}
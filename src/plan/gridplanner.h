@@ -0,0 +1,223 @@
+/** @file       src/plan/gridplanner.h
+    @ingroup    PLAN
+    @brief      A* search over the Map.
+    @author     Alex Moriarty <alexander@dal.ca>
+    @author     Jacob Perron <perronj@yorku.ca>
+*/
+
+#ifndef __PLAN_GRIDPLANNER_H_
+#define __PLAN_GRIDPLANNER_H_
+
+#include <stdint.h>
+#include <vector>
+#include "plan/map.h"
+
+/** Finds shortest paths between cells of a Map with A*.
+ *
+ *  The grid is 8-connected: straight steps cost 1 and diagonal steps
+ *  sqrt(2), and a diagonal step may not cut the corner of an occupied
+ *  cell. The heuristic is the octile distance, which is exact on an empty
+ *  grid, so the search expands few cells on open floors.
+ *
+ *  The open list is a binary heap indexed by cell, so a cell whose cost
+ *  improves is moved up in place instead of being pushed again. All per
+ *  cell buffers (cost, parent, heap slot, state) are allocated once for
+ *  the size of the map and kept between queries. Only the cells a query
+ *  touched are reset before the next one, so after the first query on a
+ *  map a search allocates nothing and costs nothing for the cells it
+ *  never reached.
+ *
+ *  On uniform-cost maps the planner can instead run Jump Point Search
+ *  (@ref JUMP_POINT ). It prunes the many symmetric paths A* expands on
+ *  open floors and only puts "jump points", where the path may have to
+ *  turn, on the heap, yet returns a path of the same optimal length.
+ *  Horizontal jumps test 64 cells per step using the packed rows of the
+ *  Map (Map::getRowWord): the obstacles in the row and the cells where
+ *  an obstacle above or below ends, which force a jump point, are found
+ *  with a few shifts and a count of trailing zeros. The version used here
+ *  is the one that never cuts corners, matching the A* moves.
+ *
+ *  The robot is not a point: given its radius (@ref setRadius ), cells
+ *  closer than that to an obstacle, by the distance field of the Map,
+ *  are blocked as well. Both searches run on a packed grid of blocked
+ *  cells laid out like Map::getRowWord , rebuilt only when the map
+ *  changed since the last search (Map::getRevision ).
+ */
+class GridPlanner {
+    public:
+
+        /** Search algorithm. */
+        enum searchMode {
+            ASTAR,      //expands every neighbour
+            JUMP_POINT  //Jump Point Search, uniform-cost grids only
+        };
+
+        /** Default constructor. */
+        GridPlanner();
+
+        /** Destructor. */
+        ~GridPlanner();
+
+        /** Sets the search algorithm, A* by default. */
+        void setMode(searchMode mode);
+
+        /** @return The search algorithm. */
+        searchMode getMode() const { return mode; }
+
+        /** Sets the radius of the robot, 0 by default.
+         *
+         *  @param radius : Cells with less clearance than this, in meters,
+         *      are blocked. Ignored on maps without a distance field
+         *      (Map::computeDistance ), where only obstacles are.
+         */
+        void setRadius(double radius);
+
+        /** @return The radius of the robot, in meters. */
+        double getRadius() const { return radius; }
+
+        /** Searches for the shortest path between two free cells.
+         *
+         *  @param map : The map to search.
+         *
+         *  @param sx, sy : The start cell.
+         *
+         *  @param gx, gy : The goal cell.
+         *
+         *  @param path : Filled with the cells of the path, start first,
+         *      as indices y*width+x.
+         *
+         *  @return False if either cell is blocked, closer to an obstacle
+         *      than the radius included, or the goal cannot be reached.
+         */
+        bool search(const Map& map, int sx, int sy, int gx, int gy,
+                    std::vector<int>& path);
+
+        /** @return Number of cells expanded by the last search. */
+        unsigned long getExpanded() const { return expanded; }
+
+        /** @return Number of heap pushes and updates in the last search. */
+        unsigned long getHeapOps() const { return heapOps; }
+
+    private:
+
+        /** Disable copy constructor. */
+        GridPlanner(const GridPlanner& source);
+
+        /** Disable assignment operator. */
+        GridPlanner& operator=(const GridPlanner& source);
+
+        /** Expands a cell with every free neighbour, for A*. */
+        void expandAll(int x, int y, int cell);
+
+        /** Expands a cell with the jump points it leads to, for JPS. */
+        void expandJumps(int x, int y, int cell);
+
+        /** Jumps from a cell in one of the 8 directions.
+         *
+         *  @param x, y : The cell to jump from, set to the jump point.
+         *
+         *  @return False if the jump hit an obstacle or the edge first.
+         */
+        bool jump(int& x, int& y, int dx, int dy);
+
+        /** Jumps along a row, 64 cells at a time.
+         *
+         *  @return Column of the jump point, or -1 if there is none.
+         */
+        int jumpRow(int x, int y, int dx);
+
+        /** Jumps along a column.
+         *
+         *  @return Row of the jump point, or -1 if there is none.
+         */
+        int jumpColumn(int x, int y, int dy);
+
+        /** @return 64 cells of a row, bit set if blocked, all blocked
+         *      off the map.
+         */
+        uint64_t rowBits(int word, int y) const {
+            if (word < 0 || word >= words || y < 0 || y >= height)
+                return ~(uint64_t)0;
+            return blocked[y * words + word];
+        }
+
+        /** @return True if the cell is on the map and not blocked. */
+        bool isFree(int x, int y) const {
+            return x >= 0 && y >= 0 && x < width && y < height &&
+                   !((blocked[y * words + (x >> 6)] >> (x & 63)) & 1);
+        }
+
+        /** Sizes the buffers for a map, only when its size changed. */
+        void prepare(const Map& map);
+
+        /** Brings the blocked cells up to date with the map and radius. */
+        void inflate(const Map& map);
+
+        /** Resets the cells touched by the previous search. */
+        void reset();
+
+        /** Lowers the cost of cell (x, y), pushing or moving it in the heap. */
+        void relax(int x, int y, int from, float cost);
+
+        /** @return Octile distance from a cell to the goal. */
+        float heuristic(int x, int y) const;
+
+        /** Moves the heap entry at a slot up or down into place. */
+        void siftUp(int slot);
+        void siftDown(int slot);
+
+        /** Removes and returns the cell with the lowest f. */
+        int pop();
+
+        /** Cell states. */
+        enum { UNSEEN = 0, OPEN = 1, CLOSED = 2 };
+
+        /** Search algorithm. */
+        searchMode mode;
+
+        /** Map of the current search. */
+        const Map* map;
+
+        /** Size of the map the buffers are made for. */
+        int width, height;
+
+        /** Radius of the robot, in meters. */
+        double radius;
+
+        /** Blocked cells, @ref words per row, packed like the Map. */
+        std::vector<uint64_t> blocked;
+        int words;
+
+        /** Map, revision and radius the blocked cells were made for. */
+        const Map* blockedMap;
+        unsigned long blockedRevision;
+        double blockedRadius;
+
+        /** Goal of the current search. */
+        int goalX, goalY;
+
+        /** Cost from the start, per cell. */
+        std::vector<float> g;
+
+        /** Cost plus heuristic, per cell, the heap key. */
+        std::vector<float> f;
+
+        /** Cell each cell was reached from. */
+        std::vector<int32_t> parent;
+
+        /** Slot of each open cell in @ref heap . */
+        std::vector<int32_t> slot;
+
+        /** UNSEEN, OPEN or CLOSED, per cell. */
+        std::vector<uint8_t> state;
+
+        /** The open list, a binary heap of cells ordered by @ref f . */
+        std::vector<int32_t> heap;
+
+        /** Cells whose buffers the last search changed. */
+        std::vector<int32_t> touched;
+
+        /** Statistics of the last search. */
+        unsigned long expanded, heapOps;
+};
+#endif
@@ -0,0 +1,61 @@
+#include "inflationlayer.h"
+#include <math.h>
+#include <algorithm>
+
+InflationLayer::InflationLayer(double resolution, double inscribedRadius,
+                               double inflationRadius, double decay) {
+    radius = std::max(0, (int)ceil(inflationRadius / resolution));
+    int side = 2 * radius + 1;
+    kernel.assign((size_t)side * side, 0);
+    for (int dy = -radius; dy <= radius; dy++) {
+        for (int dx = -radius; dx <= radius; dx++) {
+            double d = sqrt((double)(dx * dx + dy * dy)) * resolution;
+            uint8_t cost = 0;
+            if (d == 0)
+                cost = Costmap::LETHAL;
+            else if (d <= inscribedRadius)
+                cost = Costmap::INSCRIBED;
+            else if (d <= inflationRadius)
+                cost = (uint8_t)((Costmap::INSCRIBED - 1) *
+                                 exp(-decay * (d - inscribedRadius)));
+            kernel[(size_t)(dy + radius) * side + dx + radius] = cost;
+        }
+    }
+}
+
+void InflationLayer::updateBounds(Bounds& bounds) {
+    //a changed obstacle reaches this far
+    bounds.grow(radius);
+}
+
+void InflationLayer::updateCosts(Costmap& master, const Bounds& window) {
+    int w = master.getWidth(), h = master.getHeight();
+    int side = 2 * radius + 1;
+
+    //every obstacle cell that can reach into the window
+    Bounds reach = window;
+    reach.grow(radius);
+    reach.clip(w, h);
+    for (int y = reach.y0; y <= reach.y1; y++) {
+        for (int x = reach.x0; x <= reach.x1; x++) {
+            if (master.getCost(x, y) != Costmap::LETHAL)
+                continue;
+
+            //inside an obstacle, a cell on its edge is always closer
+            if ((x == 0 || master.getCost(x - 1, y) == Costmap::LETHAL) &&
+                (x == w - 1 || master.getCost(x + 1, y) == Costmap::LETHAL) &&
+                (y == 0 || master.getCost(x, y - 1) == Costmap::LETHAL) &&
+                (y == h - 1 || master.getCost(x, y + 1) == Costmap::LETHAL))
+                continue;
+
+            //stamp the kernel, clipped to the window
+            int ky0 = std::max(y - radius, window.y0), ky1 = std::min(y + radius, window.y1);
+            int kx0 = std::max(x - radius, window.x0), kx1 = std::min(x + radius, window.x1);
+            for (int ky = ky0; ky <= ky1; ky++) {
+                const uint8_t* k = &kernel[(size_t)(ky - y + radius) * side + radius - x];
+                for (int kx = kx0; kx <= kx1; kx++)
+                    master.raiseCost(kx, ky, k[kx]);
+            }
+        }
+    }
+}
@@ -0,0 +1,67 @@
+/** @file       src/plan/inflationlayer.h
+    @ingroup    PLAN
+    @brief      Costmap layer that inflates obstacles by the robot size.
+    @author     Alex Moriarty <alexander@dal.ca>
+    @author     Jacob Perron <perronj@yorku.ca>
+*/
+
+#ifndef __PLAN_INFLATIONLAYER_H_
+#define __PLAN_INFLATIONLAYER_H_
+
+#include <stdint.h>
+#include <vector>
+#include "plan/costmap.h"
+
+/** Spreads the cost of every obstacle over the cells around it.
+ *
+ *  Cells closer to an obstacle than the inscribed radius of the robot
+ *  get Costmap::INSCRIBED , as the robot cannot be centred there. Beyond
+ *  that the cost decays exponentially with distance until the inflation
+ *  radius, past which obstacles add nothing.
+ *
+ *  The costs are a precomputed kernel stamped around every lethal cell
+ *  on the edge of an obstacle; cells inside an obstacle are skipped, as
+ *  an edge cell is always closer. Since a change only reaches as far as
+ *  the inflation radius, the window is grown by that much.
+ */
+class InflationLayer : public CostmapLayer {
+    public:
+
+        /** Constructor.
+         *
+         *  @param resolution : Side of a cell in meters.
+         *
+         *  @param inscribedRadius : Radius of the robot in meters.
+         *
+         *  @param inflationRadius : Distance in meters obstacles add cost to.
+         *
+         *  @param decay : Rate the cost falls off past the inscribed
+         *      radius, per meter.
+         */
+        InflationLayer(double resolution, double inscribedRadius,
+                       double inflationRadius, double decay = 10.0);
+
+        /** Inherited from CostmapLayer. */
+        void updateBounds(Bounds& bounds);
+
+        /** Inherited from CostmapLayer. */
+        void updateCosts(Costmap& master, const Bounds& window);
+
+    private:
+
+        /** Disable default constructor. */
+        InflationLayer();
+
+        /** Disable copy constructor. */
+        InflationLayer(const InflationLayer& source);
+
+        /** Disable assignment operator. */
+        InflationLayer& operator=(const InflationLayer& source);
+
+        /** Inflation radius in cells. */
+        int radius;
+
+        /** Cost at each offset within the radius, (2r+1)^2 row by row. */
+        std::vector<uint8_t> kernel;
+};
+#endif
@@ -12,13 +12,28 @@ Local::~Local() {
 }
 
 Position Local::getLocal() {
+    return matcher.predict(getOdometry());
+}
+
+Position Local::getLocal(const RangerData& scan) {
+    return matcher.update(getOdometry(), scan);
+}
+
+Position Local::getOdometry() {
+    //odometry has been consumed
+    proxy->NotFresh();
     return Position(proxy->GetXPos(), proxy->GetYPos(), proxy->GetYaw());
 }
 
+bool Local::isFresh() {
+    return proxy->IsFresh();
+}
+
 std::string Local::toString() {
     std::stringstream out;
     out << "X: " << proxy->GetXPos() << " ";
     out << "Y: " << proxy->GetYPos() << " ";
     out << "Yaw: " << proxy->GetYaw();
+    out << " " << matcher.toString();
     return out.str();
 }
@@ -10,6 +10,8 @@
 
 #include "infs/module.h"
 #include "data/position.h"
+#include "data/rangerdata.h"
+#include "plan/scanmatcher.h"
 #include <libplayerc++/playerc++.h>
 #include <sstream>
 
@@ -18,6 +20,11 @@
  *  Utilizes PlayerCc::Position2dProxy to obtain robots up-to-date position.
  *  All classes that need to know the robots current location can do so by
  *  calling @ref getLocal .
+ *
+ *  When the robot has a laser, the wheel odometry is corrected by
+ *  matching each new scan against the one before, see ScanMatcher. The
+ *  location is then the matched pose of the last scan plus the odometry
+ *  motion since.
  */
 class Local : public Module {
     public:
@@ -37,6 +44,24 @@ class Local : public Module {
          */
         Position getLocal();
 
+        /** Returns the location of the robot, corrected by a new scan.
+         *
+         *  The odometry motion since the last scan is replaced by the
+         *  motion found by matching this scan against it.
+         *
+         *  @param scan : Fresh laser readings taken at the current location.
+         *
+         *  @return The robots location.
+         */
+        Position getLocal(const RangerData& scan);
+
+        /** Checks if the odometry changed since it was last retrieved.
+         *
+         *  @return True if Player delivered a new position since the last
+         *      call to @ref getLocal .
+         */
+        bool isFresh();
+
         /** Inherited from Module. */
         std::string toString();
 
@@ -48,7 +73,13 @@ class Local : public Module {
         /** Disable copy constructor. */
         Local(const Local& source);
 
+        /** @return The location reported by the wheel odometry. */
+        Position getOdometry();
+
         /** Reference to Position2dProxy. */
         PlayerCc::Position2dProxy* proxy;
+
+        /** Corrects the odometry from laser scans. */
+        ScanMatcher matcher;
 };
 #endif
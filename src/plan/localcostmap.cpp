@@ -0,0 +1,128 @@
+#include "localcostmap.h"
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include "util/scankernels.h"
+
+CREATE_LOGGER("LocalCostmap");
+
+LocalCostmap::LocalCostmap(int cells, double res) {
+    size = 1;
+    while (size < cells)
+        size <<= 1;
+    mask = size - 1;
+    resolution = res;
+    scale = 1.0 / res;
+    originX = originY = -size / 2;
+    costs.assign((size_t)size * size, Costmap::FREE);
+    moves = cleared = 0;
+    LOG_CTOR << "Constructed." << std::endl;
+}
+
+LocalCostmap::~LocalCostmap() {
+    LOG_DTOR << "Destructed." << std::endl;
+}
+
+void LocalCostmap::youAreHere(const Position& p) {
+    robot = p;
+    int x = (int)floor(p.x * scale) - size / 2;
+    int y = (int)floor(p.y * scale) - size / 2;
+    int dx = x - originX, dy = y - originY;
+    if (dx == 0 && dy == 0)
+        return;
+    moves++;
+
+    //moved past the whole window, nothing in it stays
+    if (abs(dx) >= size || abs(dy) >= size) {
+        memset(&costs[0], Costmap::FREE, costs.size());
+        cleared += costs.size();
+        originX = x;
+        originY = y;
+        return;
+    }
+
+    //the slots of the cells left behind take the newly exposed ones
+    if (dx > 0)
+        clearColumns(originX, x - 1);
+    else if (dx < 0)
+        clearColumns(x + size, originX + size - 1);
+    if (dy > 0)
+        clearRows(originY, y - 1);
+    else if (dy < 0)
+        clearRows(y + size, originY + size - 1);
+    originX = x;
+    originY = y;
+}
+
+void LocalCostmap::clearColumns(int x0, int x1) {
+    for (int x = x0; x <= x1; x++) {
+        uint8_t* slot = &costs[x & mask];
+        for (int y = 0; y < size; y++)
+            slot[(size_t)y * size] = Costmap::FREE;
+    }
+    cleared += (unsigned long)(x1 - x0 + 1) * size;
+}
+
+void LocalCostmap::clearRows(int y0, int y1) {
+    for (int y = y0; y <= y1; y++)
+        memset(&costs[(size_t)(y & mask) * size], Costmap::FREE, size);
+    cleared += (unsigned long)(y1 - y0 + 1) * size;
+}
+
+void LocalCostmap::addScan(const RangerData& data) {
+    const Scan& scan = data.scan;
+    if (scan.size == 0 || data.maxRange <= 0)
+        return;
+
+    ScanKernels::toCells(scan, robot.x * scale, robot.y * scale, robot.yaw,
+                         scale, data.maxRange, x0, y0, x1, y1);
+
+    ScanKernels::traceScan(*this, scan, data.maxRange, x0, y0, x1, y1);
+}
+
+bool LocalCostmap::anyInside(double minX, double maxX,
+                             double minY, double maxY) const {
+    double c = cos(robot.yaw), s = sin(robot.yaw);
+
+    //cells covering the corners of the box
+    double cornerX[2] = { minX, maxX }, cornerY[2] = { minY, maxY };
+    double lowX = HUGE_VAL, highX = -HUGE_VAL, lowY = HUGE_VAL, highY = -HUGE_VAL;
+    for (int i = 0; i < 2; i++) {
+        for (int j = 0; j < 2; j++) {
+            double wx = robot.x + c * cornerX[i] - s * cornerY[j];
+            double wy = robot.y + s * cornerX[i] + c * cornerY[j];
+            lowX = std::min(lowX, wx);
+            highX = std::max(highX, wx);
+            lowY = std::min(lowY, wy);
+            highY = std::max(highY, wy);
+        }
+    }
+    int cx0 = std::max((int)floor(lowX * scale), originX);
+    int cx1 = std::min((int)floor(highX * scale), originX + size - 1);
+    int cy0 = std::max((int)floor(lowY * scale), originY);
+    int cy1 = std::min((int)floor(highY * scale), originY + size - 1);
+
+    //centres of the lethal ones back into the robot frame
+    for (int y = cy0; y <= cy1; y++) {
+        double wy = (y + 0.5) * resolution - robot.y;
+        for (int x = cx0; x <= cx1; x++) {
+            if (cell(x, y) != Costmap::LETHAL)
+                continue;
+            double wx = (x + 0.5) * resolution - robot.x;
+            double rx = c * wx + s * wy, ry = -s * wx + c * wy;
+            if (rx >= minX && rx <= maxX && ry >= minY && ry <= maxY)
+                return true;
+        }
+    }
+    return false;
+}
+
+std::string LocalCostmap::toString() {
+    std::stringstream ss;
+    ss << "LocalCostmap: " << size << "x" << size << " cells, slid "
+       << moves << " times";
+    if (moves > 0)
+        ss << " clearing " << cleared / moves << " cells on average";
+    ss << ".";
+    return ss.str();
+}
@@ -0,0 +1,174 @@
+/** @file       src/plan/localcostmap.h
+    @ingroup    PLAN
+    @brief      Rolling-window costmap centred on the robot.
+    @author     Alex Moriarty <alexander@dal.ca>
+    @author     Jacob Perron <perronj@yorku.ca>
+*/
+
+#ifndef __PLAN_LOCALCOSTMAP_H_
+#define __PLAN_LOCALCOSTMAP_H_
+
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+#include <sstream>
+#include "infs/module.h"
+#include "data/rangerdata.h"
+#include "data/position.h"
+#include "plan/costmap.h"
+
+/** A fixed-size grid of the obstacles around the robot.
+ *
+ *  Cells are squares of the frame the robot pose is given in, cell (x, y)
+ *  covering [x, x+1) and [y, y+1) times the resolution, and the grid
+ *  keeps the square of cells centred on the robot. It needs no map and
+ *  takes the same memory however far the robot travels.
+ *
+ *  The grid is a circular buffer in both axes: cell (x, y) always lives
+ *  in slot (x mod size, y mod size). When the robot moves the window
+ *  slides by moving its origin, and only the rows and columns of slots
+ *  that now stand for newly exposed cells are cleared. Nothing is ever
+ *  copied, so following the robot costs one strip per cell travelled.
+ *
+ *  Scans mark the cells their readings end in as Costmap::LETHAL and
+ *  clear the cells the rays pass through, which, unlike the readings of
+ *  a single tick, remembers obstacles that left the field of view.
+ */
+class LocalCostmap : public Module {
+    public:
+
+        /** Constructor, an empty window at the origin.
+         *
+         *  @param size : Side of the window in cells, rounded up to a
+         *      power of two.
+         *
+         *  @param resolution : Side of a cell in meters.
+         */
+        LocalCostmap(int size = 128, double resolution = 0.05);
+
+        /** Destructor. */
+        ~LocalCostmap();
+
+        /** Centres the window on the robot.
+         *
+         *  @param robot : Where the robot is.
+         */
+        void youAreHere(const Position& robot);
+
+        /** Marks and clears the cells of a scan taken where the robot
+         *  was last placed with @ref youAreHere .
+         *
+         *  @param data : The ranger readings.
+         */
+        void addScan(const RangerData& data);
+
+        /** @return Cost of the cell holding a point, Costmap::FREE if the
+         *      point is outside the window.
+         */
+        uint8_t getCost(double x, double y) const {
+            int cx = (int)floor(x * scale), cy = (int)floor(y * scale);
+            return inWindow(cx, cy) ? cell(cx, cy) : Costmap::FREE;
+        }
+
+        /** @return Cost of a cell, Costmap::FREE if it is outside the
+         *      window. Cell (x, y) covers [x, x+1) and [y, y+1) times the
+         *      resolution.
+         */
+        uint8_t getCellCost(int x, int y) const {
+            return inWindow(x, y) ? cell(x, y) : Costmap::FREE;
+        }
+
+        /** Checks a box in the robot frame for obstacles.
+         *
+         *  @param minX, maxX : Extent of the box ahead of the robot, in
+         *      meters.
+         *
+         *  @param minY, maxY : Extent of the box to the left of the robot,
+         *      in meters.
+         *
+         *  @return True if the centre of a lethal cell lies in the box.
+         */
+        bool anyInside(double minX, double maxX, double minY, double maxY) const;
+
+        /** @return Where the robot was last placed. */
+        const Position& getRobot() const { return robot; }
+
+        /** @return Side of a cell in meters. */
+        double getResolution() const { return resolution; }
+
+        /** @return Side of the window in cells. */
+        int getSize() const { return size; }
+
+        /** Returns how far the window slid and how much it cleared. */
+        std::string toString();
+
+    private:
+
+        /** Disable copy constructor. */
+        LocalCostmap(const LocalCostmap& source);
+
+        /** Disable assignment operator. */
+        LocalCostmap& operator=(const LocalCostmap& source);
+
+        /** @return True if a cell is inside the window. */
+        bool inWindow(int x, int y) const {
+            return (unsigned int)(x - originX) < (unsigned int)size &&
+                   (unsigned int)(y - originY) < (unsigned int)size;
+        }
+
+        /** @return The slot of a cell, which must be inside the window. */
+        uint8_t& cell(int x, int y) {
+            return costs[(size_t)(y & mask) * size + (x & mask)];
+        }
+
+        /** @return The slot of a cell, which must be inside the window. */
+        uint8_t cell(int x, int y) const {
+            return costs[(size_t)(y & mask) * size + (x & mask)];
+        }
+
+        /** Clears the slots of the columns x0 to x1, every row. */
+        void clearColumns(int x0, int x1);
+
+        /** Clears the slots of the rows y0 to y1, every column. */
+        void clearRows(int y0, int y1);
+
+        /** Rays are walked by ScanKernels::traceScan . */
+        friend class ScanKernels;
+
+        /** @return True if the cell is inside the window. */
+        bool inside(int x, int y) const {
+            return inWindow(x, y);
+        }
+
+        /** Frees a cell a ray passed through. */
+        void clear(int x, int y) {
+            cell(x, y) = Costmap::FREE;
+        }
+
+        /** Makes a cell a ray ended in lethal. */
+        void mark(int x, int y) {
+            cell(x, y) = Costmap::LETHAL;
+        }
+
+        /** Side of the window in cells, a power of two, and size - 1. */
+        int size, mask;
+
+        /** Side of a cell in meters, and cells per meter. */
+        double resolution, scale;
+
+        /** Cell at the lower left corner of the window. */
+        int originX, originY;
+
+        /** Where the robot was last placed. */
+        Position robot;
+
+        /** Cost of every slot, row by row. */
+        std::vector<uint8_t> costs;
+
+        /** Start and end cells of every ray of the current scan. */
+        IntArray x0, y0, x1, y1;
+
+        /** Statistics. */
+        unsigned long moves, cleared;
+};
+#endif
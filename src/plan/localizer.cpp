@@ -0,0 +1,305 @@
+#include "localizer.h"
+#include <math.h>
+#include <algorithm>
+#define BOOST_BIND_GLOBAL_PLACEHOLDERS
+#include <boost/bind.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+#include "util/geometry.h"
+#include "util/scankernels.h"
+#include "util/scheduler.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+CREATE_LOGGER("Localizer");
+
+/** Chance a reading hits the nearest obstacle, and of it being random. */
+static const double Z_HIT = 0.9, Z_RANDOM = 0.1;
+
+/** Standard deviation of a hit around the nearest obstacle, in meters. */
+static const double SIGMA_HIT = 0.2;
+
+/** Readings of a scan treated as independent. Neighbouring readings of a
+ *  dense laser are not, and counting all of them makes the weights so
+ *  sharp that a few particles take all the weight.
+ */
+static const double INDEPENDENT_BEAMS = 30;
+
+/** Odometry noise: rotation from rotation, rotation from translation,
+ *  translation from translation and translation from rotation.
+ */
+static const double ALPHA1 = 0.2, ALPHA2 = 0.2, ALPHA3 = 0.2, ALPHA4 = 0.1;
+
+/** Odometry motion the filter waits for, in meters and radians. */
+static const double UPDATE_DISTANCE = 0.1, UPDATE_ANGLE = 0.1;
+
+/** Particles each thread weighs, at least. */
+static const int PARTICLES_PER_THREAD = 500;
+
+Localizer::Localizer(const Map& m, int particles) {
+    map = &m;
+    width = m.getWidth();
+    height = m.getHeight();
+    scale = 1.0 / m.getResolution();
+    count = std::max(1, particles);
+
+    //log-likelihood of a reading ending in each cell
+    field.resize((size_t)width * height);
+    for (int cy = 0; cy < height; cy++) {
+        for (int cx = 0; cx < width; cx++) {
+            double d = m.getClearance(cx, cy);
+            field[(size_t)cy * width + cx] =
+                log(Z_HIT * exp(-d * d / (2 * SIGMA_HIT * SIGMA_HIT)) + Z_RANDOM);
+        }
+    }
+    offMap = log(Z_RANDOM);
+
+    x.resize(count);
+    y.resize(count);
+    yaw.resize(count);
+    weight.assign(count, 1.0 / count);
+    nextX.resize(count);
+    nextY.resize(count);
+    nextYaw.resize(count);
+    beamScale = 1;
+    initialized = false;
+    matcher.setMap(m);
+    runs = resamples = matched = 0;
+    time = 0;
+    LOG_CTOR << "Constructed." << std::endl;
+}
+
+Localizer::~Localizer() {
+    LOG_DTOR << "Destructed." << std::endl;
+}
+
+double Localizer::gaussian(double sigma) {
+    if (sigma <= 0)
+        return 0;
+    boost::random::normal_distribution<double> normal(0, sigma);
+    return normal(rng);
+}
+
+void Localizer::init(const Position& p, double spread, double yawSpread) {
+    for (int i = 0; i < count; i++) {
+        x[i] = p.x + gaussian(spread);
+        y[i] = p.y + gaussian(spread);
+        yaw[i] = wrapAngle(p.yaw + gaussian(yawSpread));
+        weight[i] = 1.0 / count;
+    }
+    pose = filterPose = p;
+    initialized = true;
+    MAKE_LOG << "Placed " << count << " particles around (" << p.x << ", "
+             << p.y << ")." << std::endl;
+}
+
+Position Localizer::update(const Position& odometry, const RangerData& scan) {
+    if (!initialized) {
+        init(odometry);
+        filterOdometry = odometry;
+    }
+
+    //motion since the filter last ran, in the frame of the robot then
+    double dx = odometry.x - filterOdometry.x, dy = odometry.y - filterOdometry.y;
+    double dyaw = wrapAngle(odometry.yaw - filterOdometry.yaw);
+    if (sqrt(dx * dx + dy * dy) < UPDATE_DISTANCE && fabs(dyaw) < UPDATE_ANGLE) {
+        double c = cos(filterOdometry.yaw), s = sin(filterOdometry.yaw);
+        double fx = c * dx + s * dy, fy = -s * dx + c * dy;
+        c = cos(filterPose.yaw);
+        s = sin(filterPose.yaw);
+        pose = Position(filterPose.x + c * fx - s * fy, filterPose.y + s * fx + c * fy,
+                        wrapAngle(filterPose.yaw + dyaw));
+        return pose;
+    }
+
+    int64_t start = Scheduler::now();
+    move(filterOdometry, odometry);
+    if (weigh(scan))
+        resample();
+    estimate();
+
+    //a laser sees enough of the walls to pin the mean down
+    Position match = pose;
+    if (scan.type == LASER && matcher.matchMap(scan, match)) {
+        pose = match;
+        matched++;
+    }
+    filterOdometry = odometry;
+    filterPose = pose;
+    runs++;
+    time += Scheduler::now() - start;
+    return pose;
+}
+
+void Localizer::move(const Position& from, const Position& to) {
+    double dx = to.x - from.x, dy = to.y - from.y;
+    double trans = sqrt(dx * dx + dy * dy);
+    double rot1 = trans < 0.01 ? 0 : wrapAngle(atan2(dy, dx) - from.yaw);
+    double rot2 = wrapAngle(to.yaw - from.yaw - rot1);
+
+    //driving backwards is not a half turn either way
+    double r1 = std::min(fabs(rot1), fabs(wrapAngle(rot1 - M_PI)));
+    double r2 = std::min(fabs(rot2), fabs(wrapAngle(rot2 - M_PI)));
+    double sigmaRot1 = sqrt(ALPHA1 * r1 * r1 + ALPHA2 * trans * trans);
+    double sigmaTrans = sqrt(ALPHA3 * trans * trans + ALPHA4 * (r1 * r1 + r2 * r2));
+    double sigmaRot2 = sqrt(ALPHA1 * r2 * r2 + ALPHA2 * trans * trans);
+
+    for (int i = 0; i < count; i++) {
+        double a = yaw[i] + rot1 - gaussian(sigmaRot1);
+        double t = trans - gaussian(sigmaTrans);
+        x[i] += t * cos(a);
+        y[i] += t * sin(a);
+        yaw[i] = wrapAngle(a + rot2 - gaussian(sigmaRot2));
+    }
+}
+
+bool Localizer::weigh(const RangerData& data) {
+    //end points of the readings that hit something, in cells
+    const Scan& scan = data.scan;
+    FloatArray px, py;
+    ScanKernels::toCartesian(scan, px, py);
+    beamX.clear();
+    beamY.clear();
+    use.clear();
+    for (unsigned int i = 0; i < scan.size; i++) {
+        if (scan.range[i] >= data.maxRange || scan.range[i] <= data.minRange)
+            continue;
+        beamX.push_back(px[i] * scale);
+        beamY.push_back(py[i] * scale);
+        use.push_back(1);
+    }
+    if (beamX.empty())
+        return false;
+    beamScale = std::min(1.0, INDEPENDENT_BEAMS / beamX.size());
+    while (beamX.size() % Scan::WIDTH != 0) {
+        beamX.push_back(0);
+        beamY.push_back(0);
+        use.push_back(0);
+    }
+
+    workers.run(boost::bind(&Localizer::weighParticles, this, _1, _2),
+                0, count - 1, PARTICLES_PER_THREAD);
+    return true;
+}
+
+void Localizer::weighParticles(int first, int last) {
+    const unsigned int beams = beamX.size();
+    const float* bx = &beamX[0];
+    const float* by = &beamY[0];
+    const float* u = &use[0];
+    const float* f = &field[0];
+    const float yaw0 = map->getOrigin().yaw;
+
+    for (int i = first; i <= last; i++) {
+        //particle pose in the grid
+        double gx, gy;
+        map->worldToCell(x[i], y[i], gx, gy);
+        const float c = cos(yaw[i] - yaw0), s = sin(yaw[i] - yaw0);
+        float sum = 0;
+
+#ifdef __SSE2__
+        __m128 vc = _mm_set1_ps(c), vs = _mm_set1_ps(s);
+        __m128 vx = _mm_set1_ps(gx), vy = _mm_set1_ps(gy);
+        __m128 zero = _mm_setzero_ps(), vw = _mm_set1_ps(width);
+        __m128 vh = _mm_set1_ps(height);
+        __m128 maxX = _mm_set1_ps(width - 1), maxY = _mm_set1_ps(height - 1);
+        __m128 off = _mm_set1_ps(offMap), acc = zero;
+        int32_t index[4] __attribute__((aligned(16)));
+        float value[4] __attribute__((aligned(16)));
+        for (unsigned int j = 0; j < beams; j += Scan::WIDTH) {
+            __m128 bxj = _mm_load_ps(bx + j), byj = _mm_load_ps(by + j);
+            __m128 ex = _mm_add_ps(vx, _mm_sub_ps(_mm_mul_ps(vc, bxj), _mm_mul_ps(vs, byj)));
+            __m128 ey = _mm_add_ps(vy, _mm_add_ps(_mm_mul_ps(vs, bxj), _mm_mul_ps(vc, byj)));
+
+            //off the map reads the constant, on it the field
+            __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(ex, zero), _mm_cmplt_ps(ex, vw)),
+                                       _mm_and_ps(_mm_cmpge_ps(ey, zero), _mm_cmplt_ps(ey, vh)));
+            __m128i ix = _mm_cvttps_epi32(_mm_max_ps(zero, _mm_min_ps(ex, maxX)));
+            __m128i iy = _mm_cvttps_epi32(_mm_max_ps(zero, _mm_min_ps(ey, maxY)));
+            __m128 cell = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(iy), vw), _mm_cvtepi32_ps(ix));
+            _mm_store_si128((__m128i*)index, _mm_cvttps_epi32(cell));
+            value[0] = f[index[0]];
+            value[1] = f[index[1]];
+            value[2] = f[index[2]];
+            value[3] = f[index[3]];
+            __m128 ll = _mm_or_ps(_mm_and_ps(inside, _mm_load_ps(value)),
+                                  _mm_andnot_ps(inside, off));
+            acc = _mm_add_ps(acc, _mm_mul_ps(ll, _mm_load_ps(u + j)));
+        }
+        float lanes[4] __attribute__((aligned(16)));
+        _mm_store_ps(lanes, acc);
+        sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#else
+        for (unsigned int j = 0; j < beams; j++) {
+            float ex = gx + c * bx[j] - s * by[j];
+            float ey = gy + s * bx[j] + c * by[j];
+            if (ex >= 0 && ex < width && ey >= 0 && ey < height)
+                sum += u[j] * f[(size_t)(int)ey * width + (int)ex];
+            else
+                sum += u[j] * offMap;
+        }
+#endif
+
+        weight[i] = log(weight[i]) + beamScale * sum;
+    }
+}
+
+void Localizer::resample() {
+    //weights from log-weights, the best one at 1 to stay in range
+    double best = -HUGE_VAL;
+    for (int i = 0; i < count; i++)
+        best = std::max(best, weight[i]);
+    double total = 0;
+    for (int i = 0; i < count; i++)
+        total += weight[i] = exp(weight[i] - best);
+
+    double squares = 0;
+    for (int i = 0; i < count; i++) {
+        weight[i] /= total;
+        squares += weight[i] * weight[i];
+    }
+
+    //only resample once few particles carry the weight
+    if (1 / squares >= count / 2.0)
+        return;
+
+    //low-variance sampler, one random number for the whole set
+    boost::random::uniform_real_distribution<double> uniform(0, 1.0 / count);
+    double r = uniform(rng), c = weight[0];
+    int i = 0;
+    for (int m = 0; m < count; m++) {
+        double target = r + (double)m / count;
+        while (target > c && i < count - 1)
+            c += weight[++i];
+        nextX[m] = x[i];
+        nextY[m] = y[i];
+        nextYaw[m] = yaw[i];
+    }
+    x.swap(nextX);
+    y.swap(nextY);
+    yaw.swap(nextYaw);
+    weight.assign(count, 1.0 / count);
+    resamples++;
+}
+
+void Localizer::estimate() {
+    double mx = 0, my = 0, mc = 0, ms = 0;
+    for (int i = 0; i < count; i++) {
+        mx += weight[i] * x[i];
+        my += weight[i] * y[i];
+        mc += weight[i] * cos(yaw[i]);
+        ms += weight[i] * sin(yaw[i]);
+    }
+    pose = Position(mx, my, atan2(ms, mc));
+}
+
+std::string Localizer::toString() {
+    std::stringstream ss;
+    ss << "Localizer: " << count << " particles, " << runs << " runs";
+    if (runs > 0)
+        ss << " of " << time / 1e6 / runs << " ms on average, "
+           << resamples << " resampled, " << matched << " matched";
+    ss << ". At (" << pose.x << ", " << pose.y << ", " << pose.yaw << ").";
+    return ss.str();
+}
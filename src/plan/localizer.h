@@ -0,0 +1,181 @@
+/** @file       src/plan/localizer.h
+    @ingroup    PLAN
+    @brief      Monte Carlo localization against a Map.
+    @author     Alex Moriarty <alexander@dal.ca>
+    @author     Jacob Perron <perronj@yorku.ca>
+*/
+
+#ifndef __PLAN_LOCALIZER_H_
+#define __PLAN_LOCALIZER_H_
+
+#include <stdint.h>
+#include <vector>
+#include <sstream>
+#include <boost/random/mersenne_twister.hpp>
+#include "infs/module.h"
+#include "data/rangerdata.h"
+#include "data/position.h"
+#include "plan/map.h"
+#include "plan/scanmatcher.h"
+#include "util/workerpool.h"
+
+/** Corrects odometry drift with a particle filter.
+ *
+ *  Each particle is a guess of the robot pose on the Map. Once the
+ *  odometry has moved far enough, every particle is moved by the
+ *  odometry motion plus noise and weighed by how well the latest scan
+ *  fits the map from its pose. Particles are then resampled in
+ *  proportion to their weights with a low-variance sampler, but only
+ *  when the weights have degenerated enough to need it.
+ *
+ *  Scans are scored against a likelihood field: the log-likelihood of a
+ *  reading ending in each cell, precomputed from the distance field of
+ *  the map. Weighing a particle then takes one table lookup per reading.
+ *  The readings are walked four at a time with SSE, and the particles
+ *  split across threads.
+ *
+ *  The particles are spread by the motion noise, so their mean wanders
+ *  by a few centimeters from run to run. With a laser, the mean is then
+ *  matched against the edges of the map by ScanMatcher, and the match
+ *  is reported instead when it converges. The particles are left as
+ *  they are.
+ *
+ *  The field is built when the Localizer is made; the map is treated as
+ *  fixed from then on.
+ */
+class Localizer : public Module {
+    public:
+
+        /** Constructor.
+         *
+         *  The map must have its distance field computed.
+         *
+         *  @param map : The map, which must outlive the Localizer.
+         *
+         *  @param particles : Number of particles.
+         */
+        Localizer(const Map& map, int particles = 5000);
+
+        /** Destructor. */
+        ~Localizer();
+
+        /** Scatters the particles around a pose.
+         *
+         *  @param pose : Where the robot is believed to be.
+         *
+         *  @param spread : Standard deviation of the position, in meters.
+         *
+         *  @param yawSpread : Standard deviation of the heading, in radians.
+         */
+        void init(const Position& pose, double spread = 0.1, double yawSpread = 0.1);
+
+        /** Tracks the robot from a new odometry reading and scan.
+         *
+         *  The first call places the particles around the odometry. The
+         *  filter runs once the odometry has moved far enough since it
+         *  last ran; in between, the odometry motion is added to the
+         *  last estimate.
+         *
+         *  @param odometry : Pose reported by the odometry.
+         *
+         *  @param scan : Readings taken at that pose.
+         *
+         *  @return The estimated pose of the robot on the map.
+         */
+        Position update(const Position& odometry, const RangerData& scan);
+
+        /** @return The last estimated pose of the robot on the map. */
+        const Position& getPose() const { return pose; }
+
+        /** Returns the number of filter runs and how long they took. */
+        std::string toString();
+
+    private:
+
+        /** Disable default constructor. */
+        Localizer();
+
+        /** Disable copy constructor. */
+        Localizer(const Localizer& source);
+
+        /** Disable assignment operator. */
+        Localizer& operator=(const Localizer& source);
+
+        /** Moves every particle by the odometry motion between two poses. */
+        void move(const Position& from, const Position& to);
+
+        /** Weighs every particle against a scan.
+         *
+         *  @return False if no reading of the scan hit anything, leaving
+         *      the weights as they were.
+         */
+        bool weigh(const RangerData& scan);
+
+        /** Log-likelihood of the beams from the particles first to last. */
+        void weighParticles(int first, int last);
+
+        /** Normalizes the weights and resamples if they degenerated. */
+        void resample();
+
+        /** Sets @ref pose to the weighted mean of the particles. */
+        void estimate();
+
+        /** @return A sample of a normal distribution. */
+        double gaussian(double sigma);
+
+        /** The map localized on. */
+        const Map* map;
+
+        /** Size of the map in cells, and cells per meter. */
+        int width, height;
+        float scale;
+
+        /** Log-likelihood of a reading ending in each cell, row by row. */
+        FloatArray field;
+
+        /** Log-likelihood of a reading ending off the map. */
+        float offMap;
+
+        /** Number of particles. */
+        int count;
+
+        /** Pose of every particle. */
+        FloatArray x, y, yaw;
+
+        /** Log-weight, then weight, of every particle. */
+        std::vector<double> weight;
+
+        /** Scratch for resampling. */
+        FloatArray nextX, nextY, nextYaw;
+
+        /** End points of the readings used, in the robot frame. Padded to
+         *  Scan::WIDTH with points weighted 0 in @ref use .
+         */
+        FloatArray beamX, beamY, use;
+
+        /** Scale applied to the summed log-likelihood of a scan. */
+        float beamScale;
+
+        /** Threads the particles are weighed on. */
+        WorkerPool workers;
+
+        /** Random numbers for the motion noise and the resampler. */
+        boost::mt19937 rng;
+
+        /** Whether the particles have been placed. */
+        bool initialized;
+
+        /** Odometry when the filter last ran. */
+        Position filterOdometry;
+
+        /** Estimated pose when the filter last ran, and most recently. */
+        Position filterPose, pose;
+
+        /** Matches laser scans against the map, see @ref update . */
+        ScanMatcher matcher;
+
+        /** Statistics. */
+        unsigned long runs, resamples, matched;
+        int64_t time;
+};
+#endif
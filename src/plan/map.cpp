@@ -0,0 +1,450 @@
+#include "map.h"
+#include <math.h>
+#include <fstream>
+#include <png.h>
+#include <algorithm>
+#define BOOST_BIND_GLOBAL_PLACEHOLDERS
+#include <boost/bind.hpp>
+#include "util/scheduler.h"
+
+CREATE_LOGGER("Map");
+
+/** Pixels darker than this are obstacles. */
+static const int OBSTACLE_THRESHOLD = 128;
+
+unsigned long Map::revisions = 0;
+
+Map::Map() {
+    tracking = false;
+    resize(0, 0, 1, Position());
+    LOG_CTOR << "Constructed." << std::endl;
+}
+
+Map::Map(double width, double height, double resolution, Position origin) {
+    tracking = false;
+    resize(width, height, resolution, origin);
+    LOG_CTOR << "Constructed." << std::endl;
+}
+
+Map::~Map() {
+    LOG_DTOR << "Destructed." << std::endl;
+}
+
+void Map::resize(double w, double h, double res, Position o) {
+    resolution = res;
+    origin = o;
+    cosYaw = cos(origin.yaw);
+    sinYaw = sin(origin.yaw);
+    width = (int)ceil(w / res - 1e-9);
+    height = (int)ceil(h / res - 1e-9);
+    if (width < 0)
+        width = 0;
+    if (height < 0)
+        height = 0;
+
+    //rows of tiles are padded to whole cache lines
+    tilesX = ((width + TILE - 1) / TILE + 7) / 8 * 8;
+    tilesY = (height + TILE - 1) / TILE;
+    tiles.assign((size_t)tilesX * tilesY, 0);
+    changes.clear();
+    revision = ++revisions;
+    clearanceCells = 0;
+    columnDistance.clear();
+    clearance.clear();
+    dirtyX0 = dirtyY0 = INT_MAX;
+    dirtyX1 = dirtyY1 = -1;
+    logOdds.assign(tiles.size() * TILE * TILE, 0);
+
+    //cells past the edges read as occupied, so scans stop at the border
+    padding = 0;
+    for (int y = 0; y < tilesY * TILE; y++) {
+        for (int x = (y < height ? width : 0); x < tilesX * TILE; x++) {
+            setOccupied(x, y, true);
+            padding++;
+        }
+    }
+}
+
+bool Map::load(const std::string& bitmap, double w, double h, Position o,
+               double res) {
+    png_image image;
+    memset(&image, 0, sizeof(image));
+    image.version = PNG_IMAGE_VERSION;
+    if (!png_image_begin_read_from_file(&image, bitmap.c_str())) {
+        MAKE_LOG << "Failed to read " << bitmap << ": " << image.message << std::endl;
+        return false;
+    }
+    image.format = PNG_FORMAT_GRAY;
+    std::vector<png_byte> pixels(PNG_IMAGE_SIZE(image));
+    if (!png_image_finish_read(&image, NULL, &pixels[0], 0, NULL)) {
+        MAKE_LOG << "Failed to decode " << bitmap << ": " << image.message << std::endl;
+        png_image_free(&image);
+        return false;
+    }
+
+    int pw = image.width;
+    int ph = image.height;
+    if (res <= 0)
+        res = w / pw;
+    resize(w, h, res, o);
+
+    //sample the pixel under the centre of every cell, image row 0 is the top
+    double sx = (double)pw / width;
+    double sy = (double)ph / height;
+    for (int y = 0; y < height; y++) {
+        int py = ph - 1 - (int)((y + 0.5) * sy);
+        const png_byte* row = &pixels[(size_t)py * pw];
+        for (int x = 0; x < width; x++) {
+            int px = (int)((x + 0.5) * sx);
+            if (row[px] < OBSTACLE_THRESHOLD)
+                setOccupied(x, y, true);
+        }
+    }
+
+    //boundary 1
+    for (int x = 0; x < width; x++) {
+        setOccupied(x, 0, true);
+        setOccupied(x, height - 1, true);
+    }
+    for (int y = 0; y < height; y++) {
+        setOccupied(0, y, true);
+        setOccupied(width - 1, y, true);
+    }
+
+    MAKE_LOG << "Loaded " << bitmap << ", " << toString() << std::endl;
+    return true;
+}
+
+/** Reads the numbers inside the brackets following a keyword.
+ *
+ *  @return Number of values read.
+ */
+static int readVector(const std::string& block, const std::string& key,
+                      double* values, int n) {
+    size_t at = block.find(key + " ");
+    if (at == std::string::npos)
+        at = block.find(key + "[");
+    if (at == std::string::npos)
+        return 0;
+    size_t open = block.find('[', at);
+    size_t close = block.find(']', open);
+    if (open == std::string::npos || close == std::string::npos)
+        return 0;
+
+    std::istringstream in(block.substr(open + 1, close - open - 1));
+    int i = 0;
+    while (i < n && in >> values[i])
+        i++;
+    return i;
+}
+
+bool Map::loadWorld(const std::string& world, double res) {
+    std::ifstream file(world.c_str());
+    if (!file) {
+        MAKE_LOG << "Failed to open " << world << std::endl;
+        return false;
+    }
+
+    //strip comments
+    std::string text, line;
+    while (std::getline(file, line))
+        text += line.substr(0, line.find('#')) + "\n";
+
+    //find the floorplan instance, not its definition in map.inc
+    size_t at = 0;
+    std::string block;
+    while ((at = text.find("floorplan", at)) != std::string::npos) {
+        size_t open = text.find_first_not_of(" \t\n", at + 9);
+        if (open != std::string::npos && text[open] == '(') {
+            size_t close = text.find(')', open);
+            block = text.substr(open, close - open);
+            break;
+        }
+        at += 9;
+    }
+    if (block.empty()) {
+        MAKE_LOG << "No floorplan in " << world << std::endl;
+        return false;
+    }
+
+    double size[3] = { 0, 0, 0 };
+    double pose[4] = { 0, 0, 0, 0 };
+    if (readVector(block, "size", size, 3) < 2) {
+        MAKE_LOG << "Floorplan in " << world << " has no size." << std::endl;
+        return false;
+    }
+    readVector(block, "pose", pose, 4);
+
+    size_t key = block.find("bitmap");
+    size_t open = block.find('"', key);
+    size_t close = block.find('"', open + 1);
+    if (key == std::string::npos || open == std::string::npos ||
+        close == std::string::npos) {
+        MAKE_LOG << "Floorplan in " << world << " has no bitmap." << std::endl;
+        return false;
+    }
+    std::string bitmap = block.substr(open + 1, close - open - 1);
+
+    //bitmaps are relative to the world file
+    size_t slash = world.rfind('/');
+    if (slash != std::string::npos && bitmap[0] != '/')
+        bitmap = world.substr(0, slash + 1) + bitmap;
+
+    return load(bitmap, size[0], size[1],
+                Position(pose[0], pose[1], pose[3] * M_PI / 180.0), res);
+}
+
+void Map::trackChanges(bool on) {
+    tracking = on;
+    if (!on)
+        changes.clear();
+}
+
+void Map::takeChanges(std::vector<int>& cells) {
+    cells.clear();
+    cells.swap(changes);
+}
+
+/** Rows or columns of the distance transform each thread takes, at least. */
+static const int ROWS_PER_THREAD = 64;
+
+void Map::computeDistance(double maxClearance) {
+    clearanceCells = std::max(1, (int)ceil(maxClearance / resolution));
+    size_t cells = (size_t)width * height;
+    columnDistance.assign(cells, 0);
+    clearance.assign(cells, 0);
+    if (cells == 0)
+        return;
+
+    int64_t start = Scheduler::now();
+    transform(0, 0, width - 1, height - 1);
+    dirtyX0 = dirtyY0 = INT_MAX;
+    dirtyX1 = dirtyY1 = -1;
+    MAKE_LOG << "Distance transform of " << width << "x" << height << " cells in "
+             << (Scheduler::now() - start) / 1e6 << " ms." << std::endl;
+}
+
+void Map::updateDistance() {
+    if (clearanceCells == 0 || dirtyX1 < 0)
+        return;
+
+    //padding cells are marked too, keep to the map
+    int x0 = std::max(dirtyX0, 0), x1 = std::min(dirtyX1, width - 1);
+    int y0 = std::max(dirtyY0, 0), y1 = std::min(dirtyY1, height - 1);
+    dirtyX0 = dirtyY0 = INT_MAX;
+    dirtyX1 = dirtyY1 = -1;
+    if (x0 <= x1 && y0 <= y1)
+        transform(x0, y0, x1, y1);
+}
+
+float Map::getClearance(const Position& p) const {
+    int x, y;
+    if (clearanceCells == 0 || !worldToGrid(p.x, p.y, x, y))
+        return 0;
+    return getClearance(x, y);
+}
+
+void Map::transform(int x0, int y0, int x1, int y1) {
+    //only cells within R of the window change, and they only look at
+    //obstacles within R of themselves
+    revision = ++revisions;
+    int r = clearanceCells;
+    int outY0 = std::max(y0 - r, 0), outY1 = std::min(y1 + r, height - 1);
+    int outX0 = std::max(x0 - r, 0), outX1 = std::min(x1 + r, width - 1);
+    int inY0 = std::max(y0 - 2 * r, 0), inY1 = std::min(y1 + 2 * r, height - 1);
+    int inX0 = std::max(x0 - 2 * r, 0), inX1 = std::min(x1 + 2 * r, width - 1);
+
+    //columns of the window, then every row around it, split over threads
+    workers.run(boost::bind(&Map::distanceColumns, this, _1, _2,
+                            inY0, inY1, outY0, outY1),
+                x0, x1, ROWS_PER_THREAD);
+    workers.run(boost::bind(&Map::distanceRows, this, _1, _2,
+                            inX0, inX1, outX0, outX1),
+                outY0, outY1, ROWS_PER_THREAD);
+}
+
+void Map::distanceColumns(int x0, int x1, int y0, int y1, int out0, int out1) {
+    int cols = x1 - x0 + 1;
+    int far = clearanceCells + 1;
+    std::vector<int32_t> d((size_t)cols * (y1 - y0 + 1));
+
+    //distance to the nearest obstacle above, row by row so the grid is
+    //read in order, then to the nearest one below
+    for (int y = y0; y <= y1; y++) {
+        int32_t* row = &d[(size_t)(y - y0) * cols];
+        const int32_t* prev = row - cols;
+        for (int i = 0; i < cols; i++) {
+            if (isOccupied(x0 + i, y))
+                row[i] = 0;
+            else
+                row[i] = y == y0 ? far : std::min(prev[i] + 1, far);
+        }
+    }
+    for (int y = y1 - 1; y >= y0; y--) {
+        int32_t* row = &d[(size_t)(y - y0) * cols];
+        const int32_t* next = row + cols;
+        for (int i = 0; i < cols; i++)
+            row[i] = std::min(row[i], next[i] + 1);
+    }
+
+    for (int y = out0; y <= out1; y++) {
+        const int32_t* row = &d[(size_t)(y - y0) * cols];
+        int32_t* out = &columnDistance[(size_t)y * width + x0];
+        for (int i = 0; i < cols; i++)
+            out[i] = row[i] * row[i];
+    }
+}
+
+void Map::distanceRows(int y0, int y1, int x0, int x1, int out0, int out1) {
+    int far = (clearanceCells + 1) * (clearanceCells + 1);
+    int maxSq = clearanceCells * clearanceCells;
+    int n = x1 - x0 + 1;
+    std::vector<int> v(n);
+    std::vector<float> z(n + 1);
+
+    for (int y = y0; y <= y1; y++) {
+        const int32_t* f = &columnDistance[(size_t)y * width + x0];
+
+        //lower envelope of the parabolas rooted at cells near an obstacle
+        int k = -1;
+        for (int q = 0; q < n; q++) {
+            if (f[q] >= far)
+                continue;
+            float s = 0;
+            while (k >= 0) {
+                int p = v[k];
+                s = ((f[q] + q * q) - (f[p] + p * p)) / (2.0f * (q - p));
+                if (s > z[k])
+                    break;
+                k--;
+            }
+            k++;
+            v[k] = q;
+            z[k] = k == 0 ? -1e30f : s;
+            z[k + 1] = 1e30f;
+        }
+
+        float* out = &clearance[(size_t)y * width];
+        if (k < 0) {
+            for (int x = out0; x <= out1; x++)
+                out[x] = clearanceCells * resolution;
+            continue;
+        }
+        int j = 0;
+        for (int x = out0; x <= out1; x++) {
+            int q = x - x0;
+            while (z[j + 1] < q)
+                j++;
+            int p = v[j];
+            int dSq = (q - p) * (q - p) + f[p];
+            out[x] = sqrt((float)std::min(dSq, maxSq)) * resolution;
+        }
+    }
+}
+
+uint64_t Map::getRowWord(int word, int y) const {
+    int tx = word * 8;
+    if (tx >= tilesX)
+        return ~(uint64_t)0;
+
+    //byte y%8 of the eight tiles covering the word, one cache line
+    const uint64_t* tile = &tiles[(size_t)(y >> 3) * tilesX + tx];
+    int shift = (y & 7) << 3;
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; i++)
+        bits |= ((tile[i] >> shift) & 0xff) << (i << 3);
+    return bits;
+}
+
+int Map::nextSpan(int y, int x, bool occupied, int& end) const {
+    if (x < 0)
+        x = 0;
+    if (x >= width) {
+        end = width;
+        return width;
+    }
+
+    //find the first cell of the wanted kind
+    int start = width;
+    int word = x >> 6;
+    uint64_t bits = getRowWord(word, y);
+    if (!occupied)
+        bits = ~bits;
+    bits &= ~(uint64_t)0 << (x & 63);
+    while (true) {
+        if (bits) {
+            start = (word << 6) + __builtin_ctzll(bits);
+            break;
+        }
+        word++;
+        if ((word << 6) >= width)
+            break;
+        bits = getRowWord(word, y);
+        if (!occupied)
+            bits = ~bits;
+    }
+    if (start >= width) {
+        end = width;
+        return width;
+    }
+
+    //then the first cell of the other kind
+    end = width;
+    word = start >> 6;
+    bits = getRowWord(word, y);
+    if (occupied)
+        bits = ~bits;
+    bits &= ~(uint64_t)0 << (start & 63);
+    while (true) {
+        if (bits) {
+            end = (word << 6) + __builtin_ctzll(bits);
+            break;
+        }
+        word++;
+        if ((word << 6) >= width)
+            break;
+        bits = getRowWord(word, y);
+        if (occupied)
+            bits = ~bits;
+    }
+    if (end > width)
+        end = width;
+    return start;
+}
+
+bool Map::worldToGrid(double wx, double wy, int& x, int& y) const {
+    double cx, cy;
+    worldToCell(wx, wy, cx, cy);
+    x = (int)floor(cx);
+    y = (int)floor(cy);
+    return inBounds(x, y);
+}
+
+void Map::worldToCell(double wx, double wy, double& cx, double& cy) const {
+    //into the map frame, relative to its lower-left corner
+    double dx = wx - origin.x;
+    double dy = wy - origin.y;
+    cx = (cosYaw * dx + sinYaw * dy) / resolution + width / 2.0;
+    cy = (-sinYaw * dx + cosYaw * dy) / resolution + height / 2.0;
+}
+
+Position Map::gridToWorld(int x, int y) const {
+    double mx = (x + 0.5) * resolution - width * resolution / 2;
+    double my = (y + 0.5) * resolution - height * resolution / 2;
+    return Position(origin.x + cosYaw * mx - sinYaw * my,
+                    origin.y + sinYaw * mx + cosYaw * my, 0);
+}
+
+unsigned long Map::countOccupied() const {
+    unsigned long n = 0;
+    for (size_t i = 0; i < tiles.size(); i++)
+        n += __builtin_popcountll(tiles[i]);
+    return n - padding;
+}
+
+std::string Map::toString() {
+    std::stringstream ss;
+    ss << "Map " << width << "x" << height << " cells of " << resolution
+       << " m, " << countOccupied() << " occupied.";
+    return ss.str();
+}
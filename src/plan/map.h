@@ -8,33 +8,407 @@
 #ifndef __PLAN_MAP_H_
 #define __PLAN_MAP_H_
 
+#include <stdint.h>
+#include <limits.h>
+#include <vector>
+#include <sstream>
+#include <boost/align/aligned_allocator.hpp>
 #include "infs/module.h"
+#include "data/position.h"
+#include "util/workerpool.h"
 
-/** Map 
- * 
+/** Map
+ *
  *  Contains known data the robot has collected from the outside world.
- *  Intended to for use calculating future paths and avoiding 
+ *  Intended to for use calculating future paths and avoiding
  *  wrong turns.
+ *
+ *  The map is an occupancy grid of square cells, one bit per cell (set
+ *  if occupied). Cells are packed in 8x8 tiles, each tile one 64-bit
+ *  word with row @c y%8 of the tile in byte @c y%8 . Tiles are stored
+ *  row by row, each row of tiles padded to a multiple of eight and cache
+ *  line aligned, so eight tiles side by side fill exactly one cache line
+ *  and a 64-cell stretch of a row (@ref getRowWord ) is gathered from a
+ *  single line, while neighbours above and below usually share the word.
+ *
+ *  Every cell also keeps the log-odds of being occupied, in tenths, in
+ *  a byte array laid out like the tiles (one cache line per tile). The
+ *  occupancy bit follows it with hysteresis: it is set once the log-odds
+ *  reach @ref LOG_ODDS_OCCUPIED and cleared once they fall to
+ *  @ref LOG_ODDS_FREE . A Mapper updates them from live range data.
+ *  While @ref trackChanges is on, every cell whose occupancy bit flips
+ *  that way is recorded, so planners can repair their paths instead of
+ *  planning again from scratch.
+ *
+ *  Once @ref computeDistance is called the map also keeps the Euclidean
+ *  distance from every cell to the nearest occupied cell, so clearance
+ *  is a single lookup (@ref getClearance ). It is computed exactly with
+ *  the separable transform of Felzenszwalb and Huttenlocher: a linear
+ *  scan down every column, then the lower envelope of parabolas along
+ *  every row, each pass split over a pool of threads. Distances are
+ *  capped at a maximum clearance, which bounds what a change can affect:
+ *  @ref updateDistance only recomputes the window around the cells that
+ *  flipped since the last update. GridPlanner and DStarLite block every
+ *  cell closer to an obstacle than the robot's radius, and the Localizer
+ *  scores range readings by the clearance where they end.
+ *
+ *  Every change to the occupancy or the distances gives the map a new
+ *  revision number (@ref getRevision ), unique across maps, so planners
+ *  can tell when what they derived from it is stale.
+ *
+ *  Cell (0, 0) is the lower-left corner of the map. The map is placed in
+ *  the world like a Stage floorplan: @ref origin is the world pose of its
+ *  centre.
  **/
 class Map : public Module{
     public:
+
+        /** Side of a tile, in cells. */
+        static const int TILE = 8;
+
+        /** Log-odds are clamped to +-LOG_ODDS_MAX. */
+        static const int LOG_ODDS_MAX = 100;
+
+        /** Log-odds at which a cell becomes occupied. */
+        static const int LOG_ODDS_OCCUPIED = 20;
+
+        /** Log-odds at which an occupied cell becomes free again. */
+        static const int LOG_ODDS_FREE = 0;
+
         /**
-        * Default constructor.
+        * Default constructor, creates an empty 0x0 map.
         */
         Map();
+
+        /** Constructor, creates a map with every cell free.
+         *
+         *  @param width : Width of the map in meters.
+         *
+         *  @param height : Height of the map in meters.
+         *
+         *  @param resolution : Side of a cell in meters.
+         *
+         *  @param origin : World pose of the centre of the map.
+         */
+        Map(double width, double height, double resolution,
+            Position origin = Position());
+
         /**
          * Destructor
          */
          ~Map();
 
+        /** Loads a Stage bitmap stretched over the given area.
+         *
+         *  Dark pixels are obstacles, like Stage treats them, and the
+         *  border is marked occupied as with Stage's "boundary 1".
+         *
+         *  @param bitmap : Path of a PNG file.
+         *
+         *  @param width : Width of the map in meters.
+         *
+         *  @param height : Height of the map in meters.
+         *
+         *  @param origin : World pose of the centre of the map.
+         *
+         *  @param resolution : Side of a cell in meters, or 0 to use one
+         *      cell per pixel.
+         *
+         *  @return False if the bitmap could not be read.
+         */
+        bool load(const std::string& bitmap, double width, double height,
+                  Position origin, double resolution = 0);
+
+        /** Loads the floorplan of a Stage .world file.
+         *
+         *  Reads the size, pose and bitmap of the floorplan model and
+         *  loads the bitmap, relative to the world file, with @ref load .
+         *
+         *  @param world : Path of the .world file.
+         *
+         *  @param resolution : Side of a cell in meters, or 0 to use one
+         *      cell per pixel.
+         *
+         *  @return False if the world has no floorplan or it failed to load.
+         */
+        bool loadWorld(const std::string& world, double resolution = 0);
+
+        /** @return Width of the map in cells. */
+        int getWidth() const { return width; }
+
+        /** @return Height of the map in cells. */
+        int getHeight() const { return height; }
+
+        /** @return Side of a cell in meters. */
+        double getResolution() const { return resolution; }
+
+        /** @return World pose of the centre of the map. */
+        Position getOrigin() const { return origin; }
+
+        /** @return True if the cell is on the map. */
+        bool inBounds(int x, int y) const {
+            return x >= 0 && y >= 0 && x < width && y < height;
+        }
+
+        /** Checks a cell, which must be on the map.
+         *
+         *  @return True if the cell is occupied.
+         */
+        bool isOccupied(int x, int y) const {
+            return (tiles[tileIndex(x, y)] >> bitIndex(x, y)) & 1;
+        }
+
+        /** Marks a cell, which must be on the map, occupied or free.
+         *
+         *  The log-odds are set to the maximum, or to unknown (zero).
+         */
+        void setOccupied(int x, int y, bool occupied) {
+            uint64_t bit = (uint64_t)1 << bitIndex(x, y);
+            if (occupied)
+                tiles[tileIndex(x, y)] |= bit;
+            else
+                tiles[tileIndex(x, y)] &= ~bit;
+            logOdds[cellIndex(x, y)] = occupied ? LOG_ODDS_MAX : 0;
+            markDirty(x, y);
+        }
+
+        /** @return Log-odds of a cell, which must be on the map, in tenths. */
+        int getLogOdds(int x, int y) const {
+            return logOdds[cellIndex(x, y)];
+        }
+
+        /** Adds evidence to a cell, which must be on the map.
+         *
+         *  @param delta : Log-odds to add, in tenths. Positive if the cell
+         *      was seen occupied, negative if seen free.
+         */
+        void addLogOdds(int x, int y, int delta) {
+            int8_t& cell = logOdds[cellIndex(x, y)];
+            int l = cell + delta;
+            if (l > LOG_ODDS_MAX)
+                l = LOG_ODDS_MAX;
+            else if (l < -LOG_ODDS_MAX)
+                l = -LOG_ODDS_MAX;
+            cell = l;
+            uint64_t bit = (uint64_t)1 << bitIndex(x, y);
+            uint64_t& tile = tiles[tileIndex(x, y)];
+            uint64_t old = tile;
+            if (l >= LOG_ODDS_OCCUPIED)
+                tile |= bit;
+            else if (l <= LOG_ODDS_FREE)
+                tile &= ~bit;
+            if (tile != old) {
+                if (tracking)
+                    changes.push_back(y * width + x);
+                markDirty(x, y);
+            }
+        }
+
+        /** Starts or stops recording the cells @ref addLogOdds flips.
+         *
+         *  Stopping also forgets the cells recorded so far.
+         */
+        void trackChanges(bool on);
+
+        /** Hands over the cells that flipped since the last call.
+         *
+         *  @param cells : Swapped with the recorded cells, as y*width+x,
+         *      in the order they flipped. A cell may appear more than once.
+         */
+        void takeChanges(std::vector<int>& cells);
+
+        /** Returns 64 cells of a row at once.
+         *
+         *  @param word : Which 64 cells, cells 64*word to 64*word+63.
+         *
+         *  @param y : The row, which must be on the map.
+         *
+         *  @return One bit per cell, bit 0 for the leftmost. Cells beyond
+         *      the right edge read as occupied.
+         */
+        uint64_t getRowWord(int word, int y) const;
+
+        /** Finds the next run of occupied or free cells in a row.
+         *
+         *  @param y : The row, which must be on the map.
+         *
+         *  @param x : Cell to start searching from.
+         *
+         *  @param occupied : Which kind of cells to look for.
+         *
+         *  @param end : Set to the cell just after the run.
+         *
+         *  @return First cell of the run, or the width if there is none.
+         */
+        int nextSpan(int y, int x, bool occupied, int& end) const;
+
+        /** Converts a world point to the cell it falls in.
+         *
+         *  @return False if the point is off the map, the cell is set
+         *      either way.
+         */
+        bool worldToGrid(double wx, double wy, int& x, int& y) const;
+
+        /** Converts a world point to fractional cell coordinates.
+         *
+         *  Cell (x, y) covers [x, x+1) and [y, y+1).
+         */
+        void worldToCell(double wx, double wy, double& cx, double& cy) const;
+
+        /** @return World position of the centre of a cell. */
+        Position gridToWorld(int x, int y) const;
+
+        /** Computes the distance of every cell to the nearest obstacle.
+         *
+         *  @param maxClearance : Larger distances are reported as this, in
+         *      meters. Bounds the window an update has to recompute.
+         */
+        void computeDistance(double maxClearance = 2.0);
+
+        /** Brings the distances up to date after cells flipped.
+         *
+         *  Only cells within the maximum clearance of a flipped cell are
+         *  recomputed. Does nothing before @ref computeDistance .
+         */
+        void updateDistance();
+
+        /** Looks up the clearance of a cell, which must be on the map,
+         *  once @ref computeDistance was called.
+         *
+         *  @return Distance between the centres of the cell and of the
+         *      nearest occupied cell, in meters, at most the maximum
+         *      clearance. Zero for occupied cells.
+         */
+        float getClearance(int x, int y) const {
+            return clearance[y * width + x];
+        }
+
+        /** @return Clearance of the cell a world point falls in, zero off
+         *      the map.
+         */
+        float getClearance(const Position& p) const;
+
+        /** @return True once @ref computeDistance was called. */
+        bool hasDistance() const { return clearanceCells > 0; }
+
+        /** @return Number changed whenever a cell or distance is. */
+        unsigned long getRevision() const { return revision; }
+
+        /** @return Number of occupied cells. */
+        unsigned long countOccupied() const;
+
         /** Inherited from Module   */
         std::string toString();
 
     private:
-        /** 
+        /**
         * Disable copy constructor.
         */
         Map(const Map& source);
 
+        /** Disable assignment operator. */
+        Map& operator=(const Map& source);
+
+        /** Grows the window of cells flipped since the last update. */
+        void markDirty(int x, int y) {
+            revision = ++revisions;
+            if (x < dirtyX0) dirtyX0 = x;
+            if (x > dirtyX1) dirtyX1 = x;
+            if (y < dirtyY0) dirtyY0 = y;
+            if (y > dirtyY1) dirtyY1 = y;
+        }
+
+        /** Recomputes the distances around a window of flipped cells. */
+        void transform(int x0, int y0, int x1, int y1);
+
+        /** Column pass, the vertical distance of cells in some columns.
+         *
+         *  @param x0, x1 : The columns.
+         *
+         *  @param y0, y1 : Rows the obstacles are looked for in.
+         *
+         *  @param out0, out1 : Rows written.
+         */
+        void distanceColumns(int x0, int x1, int y0, int y1, int out0, int out1);
+
+        /** Row pass, the clearance of cells in some rows.
+         *
+         *  @param y0, y1 : The rows.
+         *
+         *  @param x0, x1 : Columns the column distances are read from.
+         *
+         *  @param out0, out1 : Columns written.
+         */
+        void distanceRows(int y0, int y1, int x0, int x1, int out0, int out1);
+
+        /** Sizes the grid and frees every cell. */
+        void resize(double width, double height, double resolution,
+                    Position origin);
+
+        /** @return Index of the tile holding a cell. */
+        int tileIndex(int x, int y) const {
+            return (y >> 3) * tilesX + (x >> 3);
+        }
+
+        /** @return Index of a cell in the log-odds array. */
+        int cellIndex(int x, int y) const {
+            return (tileIndex(x, y) << 6) | bitIndex(x, y);
+        }
+
+        /** @return Bit of a cell inside its tile. */
+        static int bitIndex(int x, int y) {
+            return ((y & 7) << 3) | (x & 7);
+        }
+
+        /** Size of the map in cells. */
+        int width, height;
+
+        /** Size of the map in tiles. */
+        int tilesX, tilesY;
+
+        /** Side of a cell in meters. */
+        double resolution;
+
+        /** World pose of the centre of the map. */
+        Position origin;
+
+        /** Cached rotation of the map in the world. */
+        double cosYaw, sinYaw;
+
+        /** Number of padding cells, which always read as occupied. */
+        unsigned long padding;
+
+        /** One word per tile. */
+        std::vector<uint64_t, boost::alignment::aligned_allocator<uint64_t, 64> > tiles;
+
+        /** Log-odds of every cell, 64 bytes per tile. */
+        std::vector<int8_t, boost::alignment::aligned_allocator<int8_t, 64> > logOdds;
+
+        /** True while flipped cells are recorded. */
+        bool tracking;
+
+        /** Cells flipped since the last @ref takeChanges . */
+        std::vector<int> changes;
+
+        /** Revision of this map, and the last one given to any map. */
+        unsigned long revision;
+        static unsigned long revisions;
+
+        /** Maximum clearance in cells, 0 until @ref computeDistance . */
+        int clearanceCells;
+
+        /** Window of cells flipped since the last distance update. */
+        int dirtyX0, dirtyY0, dirtyX1, dirtyY1;
+
+        /** Squared vertical distance to the nearest obstacle per cell,
+         *  capped just above the squared maximum clearance.
+         */
+        std::vector<int32_t> columnDistance;
+
+        /** Distance to the nearest obstacle per cell, in meters. */
+        std::vector<float> clearance;
+
+        /** Threads the distance transform is split over. */
+        WorkerPool workers;
 };
 #endif
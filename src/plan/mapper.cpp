@@ -0,0 +1,73 @@
+#include "mapper.h"
+#include "util/scankernels.h"
+#include "util/scheduler.h"
+
+CREATE_LOGGER("Mapper");
+
+/** Log-odds, in tenths, added for a hit and a pass through a cell. */
+static const int LASER_HIT = 9, LASER_MISS = -4;
+static const int SONAR_HIT = 4, SONAR_MISS = -2;
+
+Mapper::Mapper(Map& m) {
+    map = &m;
+    scans = cells = 0;
+    hitOdds = missOdds = 0;
+    time = 0;
+    LOG_CTOR << "Constructed." << std::endl;
+}
+
+Mapper::~Mapper() {
+    LOG_DTOR << "Destructed." << std::endl;
+}
+
+void Mapper::update(const RangerData& data, const Position& robot) {
+    const Scan& scan = data.scan;
+    if (scan.size == 0 || data.maxRange <= 0)
+        return;
+    int64_t start = Scheduler::now();
+
+    //robot pose in the grid
+    double px, py;
+    map->worldToCell(robot.x, robot.y, px, py);
+    float yaw = robot.yaw - map->getOrigin().yaw;
+    float scale = 1.0 / map->getResolution();
+
+    ScanKernels::toCells(scan, px, py, yaw, scale, data.maxRange,
+                         x0, y0, x1, y1);
+
+    hitOdds = LASER_HIT;
+    missOdds = LASER_MISS;
+    if (data.type == SONAR) {
+        hitOdds = SONAR_HIT;
+        missOdds = SONAR_MISS;
+    }
+    cells += ScanKernels::traceScan(*this, scan, data.maxRange,
+                                    x0, y0, x1, y1);
+
+    //only around the cells that flipped
+    map->updateDistance();
+
+    scans++;
+    time += Scheduler::now() - start;
+}
+
+unsigned long Mapper::getScans() {
+    return scans;
+}
+
+unsigned long Mapper::getCells() {
+    return cells;
+}
+
+double Mapper::getCellRate() {
+    if (time == 0)
+        return 0;
+    return cells * 1e9 / time;
+}
+
+std::string Mapper::toString() {
+    std::stringstream ss;
+    ss << "Mapper: " << scans << " scans, " << cells << " cell updates, "
+       << (unsigned long)getCellRate() << " cells/s.";
+    return ss.str();
+}
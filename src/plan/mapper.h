@@ -0,0 +1,112 @@
+/** @file       src/plan/mapper.h
+    @ingroup    PLAN
+    @brief      Builds the Map from range data.
+    @author     Alex Moriarty <alexander@dal.ca>
+    @author     Jacob Perron <perronj@yorku.ca>
+*/
+
+#ifndef __PLAN_MAPPER_H_
+#define __PLAN_MAPPER_H_
+
+#include <stdint.h>
+#include <sstream>
+#include "infs/module.h"
+#include "data/rangerdata.h"
+#include "data/position.h"
+#include "plan/map.h"
+
+/** Updates a Map online from every ranger scan.
+ *
+ *  Each reading is a ray from the ranger to the point it hit. The cells
+ *  the ray passes through were seen free and lose log-odds, the cell it
+ *  ends in was seen occupied and gains log-odds. Readings at or beyond
+ *  the ranger's maximum range only clear cells.
+ *
+ *  A scan is processed as a batch: ScanKernels::toCells first turns every
+ *  reading into the integer start and end cell of its ray with SIMD, then
+ *  ScanKernels::traceScan walks each ray with an integer Bresenham
+ *  traversal straight over the packed grid, with no floating point
+ *  inside the loop.
+ *
+ *  Sonar beams are treated as a single ray along their axis, with less
+ *  weight than laser readings. After each scan the distances of the map
+ *  are updated around the cells that flipped.
+ */
+class Mapper : public Module {
+    public:
+
+        /** Constructor.
+         *
+         *  @param map : The map to update.
+         */
+        Mapper(Map& map);
+
+        /** Destructor. */
+        ~Mapper();
+
+        /** Adds a scan to the map.
+         *
+         *  @param data : The ranger readings.
+         *
+         *  @param robot : Where the robot was, in the world, when the scan
+         *      was taken.
+         */
+        void update(const RangerData& data, const Position& robot);
+
+        /** @return Number of scans added. */
+        unsigned long getScans();
+
+        /** @return Number of cell updates made. */
+        unsigned long getCells();
+
+        /** @return Cell updates made per second spent in @ref update . */
+        double getCellRate();
+
+        /** Returns the number of scans and the update rate. */
+        std::string toString();
+
+    private:
+
+        /** Disable default constructor. */
+        Mapper();
+
+        /** Disable copy constructor. */
+        Mapper(const Mapper& source);
+
+        /** Disable assignment operator. */
+        Mapper& operator=(const Mapper& source);
+
+        /** Rays are walked by ScanKernels::traceScan . */
+        friend class ScanKernels;
+
+        /** @return True if the cell is on the map. */
+        bool inside(int x, int y) const {
+            return map->inBounds(x, y);
+        }
+
+        /** Lowers the log-odds of a cell a ray passed through. */
+        void clear(int x, int y) {
+            map->addLogOdds(x, y, missOdds);
+        }
+
+        /** Raises the log-odds of a cell a ray ended in. */
+        void mark(int x, int y) {
+            map->addLogOdds(x, y, hitOdds);
+        }
+
+        /** The map being built. */
+        Map* map;
+
+        /** Start and end cells of every ray of the current scan. */
+        IntArray x0, y0, x1, y1;
+
+        /** Log-odds added for a hit and a pass with the current ranger. */
+        int hitOdds, missOdds;
+
+        /** Statistics. */
+        unsigned long scans, cells;
+
+        /** Time spent in @ref update , in nanoseconds. */
+        int64_t time;
+};
+#endif
@@ -0,0 +1,238 @@
+/** @file       src/plan/mpcsolver.h
+    @ingroup    PLAN
+    @brief      Linear model predictive control on fixed-size matrices.
+    @author     Alex Moriarty <alexander@dal.ca>
+    @author     Jacob Perron <perronj@yorku.ca>
+*/
+
+#ifndef __PLAN_MPCSOLVER_H_
+#define __PLAN_MPCSOLVER_H_
+
+#include <stdint.h>
+#include <math.h>
+#include <algorithm>
+#include "util/matrix.h"
+#include "util/scheduler.h"
+
+/** Finds the inputs that keep a linear system closest to zero.
+ *
+ *  Over a horizon of N steps, the system moves from a state x(k) to
+ *  x(k+1) = A(k) x(k) + B(k) u(k) + c(k), with NX states and NU inputs, each
+ *  input kept within bounds. The inputs minimise the sum of x'Q x over
+ *  the states of the horizon, x'Qf x for the last one, plus u'R u.
+ *
+ *  The states are eliminated, leaving a quadratic in the N*NU inputs
+ *  alone, which is minimised by the fast gradient method projected on the
+ *  bounds. Every iterate is within the bounds, so the solver can stop at
+ *  any time with inputs that can be applied, and does at a deadline.
+ *  Each solve starts from the inputs of the last one, shifted a step, so
+ *  tracking a slowly changing reference takes few iterations.
+ *
+ *  All the matrices are sized at compile time. The solver keeps its
+ *  model and solution inside itself and works on the stack, so a solve
+ *  never touches the heap. The weights are taken to be diagonal.
+ */
+template <int N, int NX, int NU>
+class MpcSolver {
+    public:
+
+        typedef Matrix<NX, 1> State;
+        typedef Matrix<NU, 1> Input;
+
+        /** How a solve ended. */
+        enum Status {
+            CONVERGED,  //inputs stopped changing
+            TRUNCATED,  //out of iterations or time, inputs usable
+            TIMED_OUT   //out of time before the first iteration
+        };
+
+        /** Constructor, identity weights and no model. */
+        MpcSolver() {
+            q = qf = Matrix<NX, NX>::identity();
+            r = Matrix<NU, NU>::identity();
+            maxIterations = 100;
+            tolerance = 1e-6;
+            iterations = 0;
+        }
+
+        /** Sets the weights of the states, the last state and the inputs. */
+        void setWeights(const Matrix<NX, NX>& q, const Matrix<NX, NX>& qf,
+                        const Matrix<NU, NU>& r) {
+            this->q = q;
+            this->qf = qf;
+            this->r = r;
+        }
+
+        /** Sets the most iterations of a solve, and the largest change of
+         *  an input at which it has converged.
+         */
+        void setLimits(int maxIterations, double tolerance) {
+            this->maxIterations = maxIterations;
+            this->tolerance = tolerance;
+        }
+
+        /** Sets the model of step k, from state k to state k+1.
+         *
+         *  @param c : Moves the state regardless of it and the input, as
+         *      when it is an error from a reference the system cannot
+         *      follow exactly.
+         */
+        void setModel(int k, const Matrix<NX, NX>& a, const Matrix<NX, NU>& b,
+                      const State& c = State()) {
+            this->a[k] = a;
+            this->b[k] = b;
+            this->c[k] = c;
+        }
+
+        /** Sets the bounds of the input of step k. */
+        void setBounds(int k, const Input& lower, const Input& upper) {
+            this->lower[k] = lower;
+            this->upper[k] = upper;
+        }
+
+        /** Forgets the last solution, so the next solve starts from zero. */
+        void reset() {
+            u.setZero();
+        }
+
+        /** Finds the inputs from a state.
+         *
+         *  @param x0 : The state at the start of the horizon.
+         *
+         *  @param deadline : Time to stop by, as of Scheduler::now .
+         *
+         *  @return How the solve ended. Unless TIMED_OUT, the inputs are
+         *      within their bounds.
+         */
+        Status solve(const State& x0, int64_t deadline) {
+            const int S = N * NX, U = N * NU;
+            iterations = 0;
+
+            //state k+1 = drift[k] + G[k] u, with the blocks of G kept in one
+            //matrix of S rows
+            Matrix<S, U> gamma;
+            Matrix<S, 1> drift;
+            State x = x0;
+            for (int k = 0; k < N; k++) {
+                for (int i = 0; i < NX; i++) {
+                    //the earlier inputs carried through A(k)
+                    if (k > 0)
+                        for (int j = 0; j < k * NU; j++) {
+                            double sum = 0;
+                            for (int m = 0; m < NX; m++)
+                                sum += a[k](i, m) * gamma((k - 1) * NX + m, j);
+                            gamma(k * NX + i, j) = sum;
+                        }
+                    for (int j = 0; j < NU; j++)
+                        gamma(k * NX + i, k * NU + j) = b[k](i, j);
+                }
+                x = a[k] * x;
+                x += c[k];
+                x.setBlock(drift, k * NX, 0);
+            }
+
+            //the quadratic in the inputs, H = G'QG + R and g = G'Q drift
+            Matrix<U, U> h;
+            Matrix<U, 1> g;
+            for (int s = 0; s < S; s++) {
+                double w = s < S - NX ? q(s % NX, s % NX) : qf(s % NX, s % NX);
+                for (int i = 0; i < U; i++) {
+                    double gi = w * gamma(s, i);
+                    if (gi == 0)
+                        continue;
+                    g(i, 0) += gi * drift(s, 0);
+                    for (int j = i; j < U; j++)
+                        h(i, j) += gi * gamma(s, j);
+                }
+            }
+            for (int i = 0; i < U; i++) {
+                h(i, i) += r(i % NU, i % NU);
+                for (int j = 0; j < i; j++)
+                    h(i, j) = h(j, i);
+            }
+            if (Scheduler::now() > deadline)
+                return TIMED_OUT;
+
+            //step by the largest and momentum from the smallest eigenvalue,
+            //bounded by the row sums of H and by R
+            double largest = 0, smallest = HUGE_VAL;
+            for (int i = 0; i < U; i++) {
+                double sum = 0;
+                for (int j = 0; j < U; j++)
+                    sum += fabs(h(i, j));
+                largest = std::max(largest, sum);
+                smallest = std::min(smallest, r(i % NU, i % NU));
+            }
+            double rate = sqrt(smallest / largest);
+            double momentum = (1 - rate) / (1 + rate);
+
+            //start from the last solution, a step on
+            for (int i = 0; i < U - NU; i++)
+                u(i, 0) = u(i + NU, 0);
+            project(u);
+            Matrix<U, 1> y = u, next;
+            for (iterations = 1; iterations <= maxIterations; iterations++) {
+                Matrix<U, 1> gradient = h * y;
+                gradient += g;
+                next = y - gradient * (1 / largest);
+                project(next);
+
+                double change = 0;
+                for (int i = 0; i < U; i++) {
+                    change = std::max(change, fabs(next(i, 0) - u(i, 0)));
+                    y(i, 0) = next(i, 0) + momentum * (next(i, 0) - u(i, 0));
+                }
+                u = next;
+                if (change < tolerance)
+                    return CONVERGED;
+                if (Scheduler::now() > deadline)
+                    return TRUNCATED;
+            }
+            iterations = maxIterations;
+            return TRUNCATED;
+        }
+
+        /** @return The input of step k of the last solve. */
+        Input getInput(int k) const {
+            Input in;
+            in.getBlock(u, k * NU, 0);
+            return in;
+        }
+
+        /** @return Iterations taken by the last solve. */
+        int getIterations() const { return iterations; }
+
+    private:
+
+        /** Clips inputs to their bounds. */
+        void project(Matrix<N * NU, 1>& inputs) const {
+            for (int k = 0; k < N; k++)
+                for (int j = 0; j < NU; j++) {
+                    double& v = inputs(k * NU + j, 0);
+                    v = std::min(std::max(v, lower[k](j, 0)), upper[k](j, 0));
+                }
+        }
+
+        /** Model of every step. */
+        Matrix<NX, NX> a[N];
+        Matrix<NX, NU> b[N];
+        State c[N];
+
+        /** Bounds of the input of every step. */
+        Input lower[N], upper[N];
+
+        /** Weights. */
+        Matrix<NX, NX> q, qf;
+        Matrix<NU, NU> r;
+
+        /** Inputs of every step, the last solution. */
+        Matrix<N * NU, 1> u;
+
+        /** Most iterations, and change of an input that is converged. */
+        int maxIterations;
+        double tolerance;
+
+        /** Iterations taken by the last solve. */
+        int iterations;
+};
+#endif
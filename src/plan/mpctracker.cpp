@@ -0,0 +1,170 @@
+#include "mpctracker.h"
+#include <math.h>
+#include <algorithm>
+#include "util/geometry.h"
+#include "util/scheduler.h"
+
+CREATE_LOGGER("MpcTracker");
+
+const int MpcTracker::HORIZON;
+
+/** Length of a step of the horizon, in seconds. */
+static const double STEP = 0.1;
+
+/** Limits, as PurePursuit's: top speeds in meters and radians per second,
+ *  acceleration and braking in meters per second squared.
+ */
+static const double MAX_SPEED = 0.5, MAX_TURN = 1.0, ACCEL = 0.5, DECEL = 0.5;
+
+/** Weights of the position and yaw errors, doubled on the last step, and
+ *  of the corrections to the speed and turn rate.
+ */
+static const double POSITION_WEIGHT = 10, YAW_WEIGHT = 1,
+                    SPEED_WEIGHT = 0.5, TURN_WEIGHT = 0.05;
+
+/** Further off the line than this, in meters or radians, the model does
+ *  not hold and the tick falls back to pure pursuit, which turns onto the
+ *  line more tightly.
+ */
+static const double MAX_OFFSET = 0.5, MAX_YAW_OFFSET = M_PI / 4;
+
+/** Slowest reference speed the model is solved at, in meters per second. */
+static const double MIN_SPEED = 0.01;
+
+/** Iterations of a solve, and the change of an input that is converged. */
+static const int MAX_ITERATIONS = 200;
+static const double TOLERANCE = 1e-5;
+
+MpcTracker::MpcTracker() {
+    Matrix<3, 3> q, qf;
+    q(0, 0) = q(1, 1) = POSITION_WEIGHT;
+    q(2, 2) = YAW_WEIGHT;
+    qf = q * 2;
+    Matrix<2, 2> r;
+    r(0, 0) = SPEED_WEIGHT;
+    r(1, 1) = TURN_WEIGHT;
+    solver.setWeights(q, qf, r);
+    solver.setLimits(MAX_ITERATIONS, TOLERANCE);
+    budget = 5000000;
+    solves = truncated = fallbacks = iterations = 0;
+    latency = totalLatency = maxLatency = 0;
+    LOG_CTOR << "Constructed." << std::endl;
+}
+
+MpcTracker::~MpcTracker() {
+    LOG_DTOR << "Destructed." << std::endl;
+}
+
+void MpcTracker::setPath(const std::vector<Position>& waypoints) {
+    pursuit.setPath(waypoints);
+    solver.reset();
+}
+
+void MpcTracker::setBudget(double seconds) {
+    budget = (int64_t)(seconds * 1e9);
+}
+
+Motion MpcTracker::track(const Position& robot, const Motion& current, double period) {
+    //moves along the progress, and is the answer if the solve is not
+    Motion fallback = pursuit.track(robot, current, period);
+    if (pursuit.isFinished())
+        return fallback;
+    int64_t start = Scheduler::now();
+
+    //reference points along the line at the profile speeds, ramping up
+    //from the current speed, one past the horizon for the last heading
+    double along[HORIZON + 2], speed[HORIZON + 1];
+    Position point[HORIZON + 2];
+    along[0] = pursuit.getProgress();
+    double v = current.x;
+    for (int k = 0; k <= HORIZON + 1; k++) {
+        point[k] = pursuit.pointAt(along[k]);
+        if (k > HORIZON)
+            break;
+        v = std::min(pursuit.speedAt(along[k]), v + ACCEL * STEP);
+        speed[k] = v;
+        along[k + 1] = along[k] + std::max(v, MIN_SPEED) * STEP;
+    }
+    double yaw[HORIZON + 1];
+    for (int k = 0; k <= HORIZON; k++)
+        yaw[k] = atan2(point[k + 1].y - point[k].y, point[k + 1].x - point[k].x);
+
+    //too far off for the linear model, or at the end of the line where
+    //the reference has stopped and the robot cannot be moved sideways
+    Matrix<3, 1> error;
+    error(0, 0) = robot.x - point[0].x;
+    error(1, 0) = robot.y - point[0].y;
+    error(2, 0) = wrapAngle(robot.yaw - yaw[0]);
+    if (hypot(error(0, 0), error(1, 0)) > MAX_OFFSET ||
+        fabs(error(2, 0)) > MAX_YAW_OFFSET || speed[0] < MIN_SPEED) {
+        fallbacks++;
+        solver.reset();
+        return fallback;
+    }
+
+    //the unicycle linearised about each step of the reference, its inputs
+    //the corrections to the reference speeds within the limits, and what
+    //the reference turns beyond them carried as a drift of the error
+    double turn[HORIZON];
+    for (int k = 0; k < HORIZON; k++) {
+        turn[k] = std::max(-MAX_TURN, std::min(MAX_TURN, wrapAngle(yaw[k + 1] - yaw[k]) / STEP));
+        double c = cos(yaw[k]), s = sin(yaw[k]);
+        Matrix<3, 3> a = Matrix<3, 3>::identity();
+        a(0, 2) = -speed[k] * s * STEP;
+        a(1, 2) = speed[k] * c * STEP;
+        Matrix<3, 2> b;
+        b(0, 0) = c * STEP;
+        b(1, 0) = s * STEP;
+        b(2, 1) = STEP;
+        Matrix<3, 1> drift;
+        drift(0, 0) = point[k].x + speed[k] * c * STEP - point[k + 1].x;
+        drift(1, 0) = point[k].y + speed[k] * s * STEP - point[k + 1].y;
+        drift(2, 0) = wrapAngle(yaw[k] + turn[k] * STEP - yaw[k + 1]);
+        solver.setModel(k, a, b, drift);
+
+        Matrix<2, 1> lower, upper;
+        lower(0, 0) = std::max(0.0, current.x - (k + 1) * DECEL * STEP) - speed[k];
+        upper(0, 0) = std::min(MAX_SPEED, current.x + (k + 1) * ACCEL * STEP) - speed[k];
+        lower(1, 0) = -MAX_TURN - turn[k];
+        upper(1, 0) = MAX_TURN - turn[k];
+        lower(0, 0) = std::min(lower(0, 0), upper(0, 0));
+        solver.setBounds(k, lower, upper);
+    }
+
+    MpcSolver<HORIZON, 3, 2>::Status status = solver.solve(error, start + budget);
+    latency = Scheduler::now() - start;
+    totalLatency += latency;
+    maxLatency = std::max(maxLatency, latency);
+    solves++;
+    iterations += solver.getIterations();
+    LOG_DEBUG << "Solved in " << latency / 1e3 << " us, " << solver.getIterations()
+              << " iterations." << std::endl;
+    if (status == MpcSolver<HORIZON, 3, 2>::TIMED_OUT) {
+        fallbacks++;
+        solver.reset();
+        return fallback;
+    }
+    if (status == MpcSolver<HORIZON, 3, 2>::TRUNCATED)
+        truncated++;
+
+    //stopping where it stands can be cheaper than moving off, but never
+    //gets anywhere
+    Matrix<2, 1> u = solver.getInput(0);
+    Motion m(speed[0] + u(0, 0), turn[0] + u(1, 0));
+    if (m.x < MIN_SPEED && current.x < MIN_SPEED) {
+        fallbacks++;
+        return fallback;
+    }
+    return m;
+}
+
+std::string MpcTracker::toString() {
+    std::stringstream ss;
+    ss << "MpcTracker: " << solves << " solves";
+    if (solves > 0)
+        ss << " of " << totalLatency / 1e3 / solves << " us on average, "
+           << maxLatency / 1e3 << " us at most, " << iterations / (double)solves
+           << " iterations";
+    ss << ", " << truncated << " truncated, " << fallbacks << " fell back.";
+    return ss.str();
+}
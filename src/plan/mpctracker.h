@@ -0,0 +1,109 @@
+/** @file       src/plan/mpctracker.h
+    @ingroup    PLAN
+    @brief      Model predictive path tracking for differential drive.
+    @author     Alex Moriarty <alexander@dal.ca>
+    @author     Jacob Perron <perronj@yorku.ca>
+*/
+
+#ifndef __PLAN_MPCTRACKER_H_
+#define __PLAN_MPCTRACKER_H_
+
+#include <stdint.h>
+#include <vector>
+#include <sstream>
+#include "infs/module.h"
+#include "data/motion.h"
+#include "data/position.h"
+#include "plan/purepursuit.h"
+#include "plan/mpcsolver.h"
+
+/** Drives along a line of waypoints by model predictive control.
+ *
+ *  Every tick, a reference is laid along the line from where the robot
+ *  is, HORIZON steps of a tenth of a second at the speeds of the
+ *  PurePursuit profile. The differential drive model is linearised about it, and
+ *  MpcSolver finds the corrections to the reference speeds that keep the
+ *  robot closest to it over the horizon, within the speed and
+ *  acceleration limits. Only the first is driven, and the next tick
+ *  solves again. Seeing the corners a second ahead, the robot swings
+ *  out before them rather than cutting them, which keeps it on the line
+ *  in tight corridors.
+ *
+ *  A solve gets a time budget. If the solver runs out of it before its
+ *  first iteration, or the robot is too far off the line for the
+ *  linearisation to hold, the tick falls back to the PurePursuit
+ *  command, which also keeps track of the progress along the line.
+ */
+class MpcTracker : public Module {
+    public:
+
+        /** Steps of the horizon, a tenth of a second each. */
+        static const int HORIZON = 10;
+
+        /** Constructor. */
+        MpcTracker();
+
+        /** Destructor. */
+        ~MpcTracker();
+
+        /** Sets the waypoints to drive along.
+         *
+         *  @param waypoints : Where the robot is, followed by the
+         *      positions to drive through, the last one to stop at.
+         */
+        void setPath(const std::vector<Position>& waypoints);
+
+        /** Sets how long a solve may take.
+         *
+         *  @param seconds : The budget of a tick, in seconds.
+         */
+        void setBudget(double seconds);
+
+        /** Picks the speeds to drive at for the next period.
+         *
+         *  @param robot : Where the robot is.
+         *
+         *  @param current : The speeds the robot is driving at.
+         *
+         *  @param period : Time until the next call, in seconds.
+         *
+         *  @return The speeds, a stop once finished.
+         */
+        Motion track(const Position& robot, const Motion& current, double period);
+
+        /** @return Index of the waypoint being driven to, those before it
+         *      have been driven past.
+         */
+        int getWaypoint() const { return pursuit.getWaypoint(); }
+
+        /** @return True once the robot is at the last waypoint. */
+        bool isFinished() const { return pursuit.isFinished(); }
+
+        /** @return How long the last solve took, in seconds. */
+        double getLatency() const { return latency / 1e9; }
+
+        /** Returns the solve latencies, iterations and fallbacks. */
+        std::string toString();
+
+    private:
+
+        /** Disable copy constructor. */
+        MpcTracker(const MpcTracker& source);
+
+        /** Disable assignment operator. */
+        MpcTracker& operator=(const MpcTracker& source);
+
+        /** Keeps the progress and the speed profile, and is fallen back on. */
+        PurePursuit pursuit;
+
+        /** States x, y and yaw, inputs speed and turn rate. */
+        MpcSolver<HORIZON, 3, 2> solver;
+
+        /** Time budget of a solve, in nanoseconds. */
+        int64_t budget;
+
+        /** Statistics, latencies in nanoseconds. */
+        unsigned long solves, truncated, fallbacks, iterations;
+        int64_t latency, totalLatency, maxLatency;
+};
+#endif
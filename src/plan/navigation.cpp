@@ -1,9 +1,11 @@
 #include "navigation.h"
+#include "util/scheduler.h"
 
 CREATE_LOGGER("Navigation");
 
 Navigation::Navigation() {
-
+    costmap = NULL;
+    lastTime = 0;
     LOG_CTOR << "Constructed." << std::endl;
 }
 
@@ -12,6 +14,35 @@ Navigation::~Navigation() {
     LOG_DTOR << "Destructed." << std::endl;
 }
 
+void Navigation::setLocalCostmap(const LocalCostmap* costmap) {
+    this->costmap = costmap;
+}
+
+bool Navigation::steer(const Position& target, Motion& motion) {
+    if (costmap == NULL)
+        return false;
+
+    //skipped a tick, the speed planned last is not what the robot has now
+    int64_t now = Scheduler::now();
+    if (now - lastTime > 2 * dwa.getPeriod() * 1e9)
+        last = Motion();
+
+    motion = dwa.plan(*costmap, target, last);
+    last = motion;
+    lastTime = now;
+    return true;
+}
+
+bool Navigation::check(const Motion& motion) {
+    if (costmap == NULL)
+        return true;
+    if (!dwa.isClear(*costmap, motion))
+        return false;
+    last = motion;
+    lastTime = Scheduler::now();
+    return true;
+}
+
 std::string Navigation::toString() {
-    return "Navigation";
+    return "Navigation " + dwa.toString();
 }
@@ -8,13 +8,21 @@
 #ifndef __PLAN_NAVIGATION_H_
 #define __PLAN_NAVIGATION_H_
 
+#include <stdint.h>
 #include "infs/module.h"
+#include "data/motion.h"
+#include "data/position.h"
+#include "plan/localcostmap.h"
+#include "plan/dynamicwindow.h"
 
 /** Navigation Functions and Methods
  *
  *  The Navigation Class is intended to contain all the aspects of
  *  Planning the route and passing it back to the controller.
  *  It keeps trace of where the Robot has been, where it will go next.
+ *
+ *  Between the positions of a route, the robot is steered by the
+ *  DynamicWindow local planner on the obstacles of the LocalCostmap.
  */
 class Navigation : public Module {
     public:
@@ -25,6 +33,40 @@ class Navigation : public Module {
         /** Destructor. */
          ~Navigation();
 
+        /** Sets the obstacles around the robot to steer around.
+         *
+         *  @param costmap : The costmap, owned by the Robot, or NULL to
+         *      stop steering.
+         */
+        void setLocalCostmap(const LocalCostmap* costmap);
+
+        /** Picks the speeds that drive towards a position without hitting
+         *  anything on the way.
+         *
+         *  The robot is taken to drive at the speeds last picked, or to be
+         *  at rest if it was not steered in the last period.
+         *
+         *  @param target : Where the robot is driving to.
+         *
+         *  @param motion : Set to the speeds to drive at.
+         *
+         *  @return False if there is no costmap to steer on.
+         */
+        bool steer(const Position& target, Motion& motion);
+
+        /** Checks speeds picked by something else, such as a path
+         *  tracker, for obstacles on the way.
+         *
+         *  Speeds that are clear are taken as the ones the robot drives
+         *  at, for the next @ref steer .
+         *
+         *  @param motion : The speeds to drive at.
+         *
+         *  @return False if they run into something. True if there is no
+         *      costmap to check them on.
+         */
+        bool check(const Motion& motion);
+
         /** Inherited from Module. */
         std::string toString();
 
@@ -36,5 +78,14 @@ class Navigation : public Module {
         /** Disable assignment operator. */
         Navigation& operator=(const Navigation& source);
 
+        /** Obstacles around the robot, NULL if there are none. */
+        const LocalCostmap* costmap;
+
+        /** Local planner. */
+        DynamicWindow dwa;
+
+        /** Speeds last picked, and when. */
+        Motion last;
+        int64_t lastTime;
 };
 #endif
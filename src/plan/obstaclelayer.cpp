@@ -0,0 +1,39 @@
+#include "obstaclelayer.h"
+#include "util/scankernels.h"
+
+ObstacleLayer::ObstacleLayer(const Map& m) {
+    map = &m;
+    width = m.getWidth();
+    height = m.getHeight();
+    marked.assign((size_t)width * height, 0);
+}
+
+void ObstacleLayer::addScan(const RangerData& data, const Position& robot) {
+    const Scan& scan = data.scan;
+    if (scan.size == 0 || data.maxRange <= 0)
+        return;
+
+    //robot pose in the grid
+    double px, py;
+    map->worldToCell(robot.x, robot.y, px, py);
+    float yaw = robot.yaw - map->getOrigin().yaw;
+    float scale = 1.0 / map->getResolution();
+    ScanKernels::toCells(scan, px, py, yaw, scale, data.maxRange,
+                         x0, y0, x1, y1);
+
+    ScanKernels::traceScan(*this, scan, data.maxRange, x0, y0, x1, y1);
+}
+
+void ObstacleLayer::updateBounds(Bounds& bounds) {
+    bounds.add(changed);
+    changed = Bounds();
+}
+
+void ObstacleLayer::updateCosts(Costmap& master, const Bounds& window) {
+    for (int y = window.y0; y <= window.y1; y++) {
+        const uint8_t* row = &marked[(size_t)y * width];
+        for (int x = window.x0; x <= window.x1; x++)
+            if (row[x])
+                master.raiseCost(x, y, Costmap::LETHAL);
+    }
+}
@@ -0,0 +1,97 @@
+/** @file       src/plan/obstaclelayer.h
+    @ingroup    PLAN
+    @brief      Costmap layer of the obstacles seen by the rangers.
+    @author     Alex Moriarty <alexander@dal.ca>
+    @author     Jacob Perron <perronj@yorku.ca>
+*/
+
+#ifndef __PLAN_OBSTACLELAYER_H_
+#define __PLAN_OBSTACLELAYER_H_
+
+#include <stdint.h>
+#include <vector>
+#include "data/rangerdata.h"
+#include "data/position.h"
+#include "plan/costmap.h"
+
+/** Obstacles from live range data.
+ *
+ *  Every reading marks the cell it ends in and clears the cells the ray
+ *  passed through, like the Mapper but without any memory of earlier
+ *  evidence: the last reading through a cell decides. Only cells that
+ *  actually switch between marked and clear are reported changed.
+ */
+class ObstacleLayer : public CostmapLayer {
+    public:
+
+        /** Constructor, an empty layer over the cells of a map. */
+        ObstacleLayer(const Map& map);
+
+        /** Marks and clears the cells of a scan.
+         *
+         *  @param data : The ranger readings.
+         *
+         *  @param robot : Where the robot was when the scan was taken.
+         */
+        void addScan(const RangerData& data, const Position& robot);
+
+        /** Inherited from CostmapLayer. */
+        void updateBounds(Bounds& bounds);
+
+        /** Inherited from CostmapLayer. */
+        void updateCosts(Costmap& master, const Bounds& window);
+
+    private:
+
+        /** Disable default constructor. */
+        ObstacleLayer();
+
+        /** Disable copy constructor. */
+        ObstacleLayer(const ObstacleLayer& source);
+
+        /** Disable assignment operator. */
+        ObstacleLayer& operator=(const ObstacleLayer& source);
+
+        /** Sets a cell, which must be on the map, marked or clear. */
+        void set(int x, int y, uint8_t mark) {
+            uint8_t& cell = marked[(size_t)y * width + x];
+            if (cell != mark) {
+                cell = mark;
+                changed.add(x, y);
+            }
+        }
+
+        /** Rays are walked by ScanKernels::traceScan . */
+        friend class ScanKernels;
+
+        /** @return True if the cell is on the map. */
+        bool inside(int x, int y) const {
+            return map->inBounds(x, y);
+        }
+
+        /** Clears a cell a ray passed through. */
+        void clear(int x, int y) {
+            set(x, y, 0);
+        }
+
+        /** Marks a cell a ray ended in. */
+        void mark(int x, int y) {
+            set(x, y, 1);
+        }
+
+        /** The map giving the grid. */
+        const Map* map;
+
+        /** Size of the grid in cells. */
+        int width, height;
+
+        /** One byte per cell, set if an obstacle was seen there. */
+        std::vector<uint8_t> marked;
+
+        /** Cells changed since the last update. */
+        Bounds changed;
+
+        /** Start and end cells of every ray of the current scan. */
+        IntArray x0, y0, x1, y1;
+};
+#endif
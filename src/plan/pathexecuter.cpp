@@ -1,11 +1,18 @@
 #include "pathexecuter.h"
+#include "util/scheduler.h"
 
 CREATE_LOGGER("PathExecuter");
 
 PathExecuter::PathExecuter(Motor& motor) {
     this->motor = &motor;
     this->alreadyFound = false;
-    this->path = NULL;
+    this->hasPath = false;
+    this->nav = NULL;
+    this->tracking = true;
+    this->predictive = false;
+    this->following = false;
+    this->passed = 0;
+    this->lastTime = 0;
     LOG_CTOR << "Constructed." << std::endl;
 }
 
@@ -15,42 +22,42 @@ PathExecuter::~PathExecuter() {
 }
 
 bool PathExecuter::executePosition() {
-    if (path != NULL) {
-        if (path->size() == 0) {
+    if (hasPath) {
+        if (path.size() == 0) {
             motor->halt();
             abandonPath();
-            MAKE_LOG << "Path Deleted." << std::endl;
+            MAKE_LOG << "Path finished." << std::endl;
         }
         else { //continue executing
 			//get next Position to go to
-            Position goal = path->getPosition(0);
+            Position goal = path.getPosition(0);
             if (isArrived(goal)) { //check if at goal
 				//take position off list
-                path->removePosition(0);
+                path.removePosition(0);
             }
             else
-                motor->goTo(goal);
+                driveTo(goal);
         } //end continue executing
         return false;
-    } //end if Path != NULL
+    } //end if hasPath
     return true;
 }
 
 bool PathExecuter::executeMove(bool remove) {
-    if (path != NULL) {
-        MAKE_LOG << "PE executeMove()"<< std::endl;
-        if (path->numOfMoves(0) == 0) { //0 moves to execute
-            MAKE_LOG << "zero moves to execute" << std::endl;
+    if (hasPath) {
+        LOG_DEBUG << "PE executeMove()"<< std::endl;
+        if (path.numOfMoves(0) == 0) { //0 moves to execute
+            LOG_DEBUG << "zero moves to execute" << std::endl;
             motor->halt();
 
-            if (remove && path != NULL)
+            if (remove && hasPath)
                 abandonPath();
 
             return true;
         }
         else { //continue executing
             //get current move
-            Move m = path->getMove();
+            Move m = path.getMove();
             Motion motion;
 
             if (m.isMeters) { //if moving
@@ -62,7 +69,7 @@ bool PathExecuter::executeMove(bool remove) {
                     motion.x = PathExecuter::SPEED;
 
                 if (difference >= std::abs(m.value)) { //check if arrived
-                    path->removeMove();
+                    path.removeMove();
                     lastLocation = robotLocation;
                 }
                 else { //continue current Move
@@ -77,50 +84,50 @@ bool PathExecuter::executeMove(bool remove) {
                     motion.yaw = PathExecuter::TURNRATE;
 
                 double angleDiff = std::abs(robotLocation.yaw - lastLocation.yaw);
-                MAKE_LOG << "Angle diff : " << angleDiff << std::endl;
-                MAKE_LOG << "angle to move : " << m.value*(180.0/M_PI) << std::endl;
+                LOG_DEBUG << "Angle diff : " << angleDiff << std::endl;
+                LOG_DEBUG << "angle to move : " << m.value*(180.0/M_PI) << std::endl;
                 if (angleDiff >= std::abs(m.value)) { //check if arrived
-                    MAKE_LOG << "Removing move" << std::endl;
-                    path->removeMove();
+                    LOG_DEBUG << "Removing move" << std::endl;
+                    path.removeMove();
                     lastLocation = robotLocation;
                 }
                 else { //continue turning
-                    MAKE_LOG << "updating" << std::endl;
+                    LOG_DEBUG << "updating" << std::endl;
                     motor->setMotion(motion);
                     motor->update();
                 }
             }
         } //end continue
         return false;
-    } //end if path!=NULL
+    } //end if hasPath
     return true;
 }
 
 bool PathExecuter::execute() {
-	if (path != NULL) {
-        if (path->size() == 0) {
+	if (hasPath) {
+        if (path.size() == 0) {
             motor->halt();
             abandonPath();
-            MAKE_LOG << "Path Deleted." << std::endl;
+            MAKE_LOG << "Path finished." << std::endl;
         }
         else { //continue executing
 			//get next Position to go to
-            Position goal = path->getPosition(0);
+            Position goal = path.getPosition(0);
             if (alreadyFound || isArrived(goal)) { //check if at goal
                 alreadyFound = true;
 				//now execute moves
-                //if (path->numOfMoves(0) > 0)
+                //if (path.numOfMoves(0) > 0)
     			if (executeMove(false)) { //take position off list
-                    path->removePosition(0);
+                    path.removePosition(0);
                     lastLocation = robotLocation;
                     alreadyFound = false;
                 }
             }
-            else
-                motor->goTo(goal);
+            else if (!tracking || !follow())
+                driveTo(goal);
          } //end continue executing
         return false;
-    } //end if Path != NULL
+    } //end if hasPath
     return true;
 }
 
@@ -131,19 +138,115 @@ void PathExecuter::setMotion(Motion m) {
     motor->update();
 }
 
+bool PathExecuter::getTarget(Position& target) {
+    if (!hasPath || path.size() == 0 || alreadyFound)
+        return false;
+    target = path.getPosition(0);
+    return true;
+}
+
+void PathExecuter::driveTo(Position goal) {
+    //steer clear of obstacles on the way, turn to the yaw on arrival
+    Motion motion;
+    if (nav != NULL && robotLocation.calcDistTo(goal) > ACCURACY &&
+        nav->steer(goal, motion)) {
+        motor->setMotion(motion);
+        motor->update();
+    }
+    else
+        motor->goTo(goal);
+}
+
+bool PathExecuter::follow() {
+    //blend through the positions up to the first with moves to make
+    if (!following) {
+        std::vector<Position> waypoints(1, robotLocation);
+        for (int i = 0; i < path.size(); i++) {
+            waypoints.push_back(path.getPosition(i));
+            if (path.numOfMoves(i) > 0)
+                break;
+        }
+        if (waypoints.size() < 3)
+            return false; //a single position, nothing to blend
+        if (predictive)
+            mpc.setPath(waypoints);
+        else
+            tracker.setPath(waypoints);
+        following = true;
+        passed = 1;
+    }
+
+    //another behaviour had the motors since the last call, so the speed
+    //sent then is stale; start from rest and a nominal period
+    int64_t now = Scheduler::now();
+    double period = (now - lastTime) / 1e9;
+    if (period > 0.5) {
+        speed = Motion();
+        period = 0.1;
+    }
+    Motion m;
+    int waypoint;
+    bool finished;
+    if (predictive) {
+        m = mpc.track(robotLocation, speed, period);
+        waypoint = mpc.getWaypoint();
+        finished = mpc.isFinished();
+    }
+    else {
+        m = tracker.track(robotLocation, speed, period);
+        waypoint = tracker.getWaypoint();
+        finished = tracker.isFinished();
+    }
+
+    //positions driven past are done with
+    for (; passed < waypoint; passed++)
+        path.removePosition(0);
+    if (finished) {
+        following = false;
+        return false;
+    }
+
+    //the tracker is blind, the local planner steers around what it hits
+    if (nav != NULL && !nav->check(m))
+        return false;
+
+    speed = m;
+    lastTime = now;
+    motor->setMotion(m);
+    motor->update();
+    return true;
+}
+
 void PathExecuter::halt() {
+    speed = Motion();
     motor->halt();
 }
 
+void PathExecuter::setTracking(bool on) {
+    tracking = on;
+    following = false;
+}
+
+void PathExecuter::setPredictive(bool on) {
+    predictive = on;
+    following = false;
+}
+
+void PathExecuter::setNavigation(Navigation& nav) {
+    this->nav = &nav;
+}
+
 void PathExecuter::setMotor(Motor& motor) {
     this->motor = &motor;
 }
 
-void PathExecuter::setPath(Path& path) {
+void PathExecuter::setPath(const Path& path) {
     abandonPath();
-    this->path = &path;
+    this->path = path;
+    this->hasPath = true;
     this->lastLocation = robotLocation;
     this->alreadyFound = false;
+    this->following = false;
 }
 
 void PathExecuter::setLocal(Position pos) {
@@ -151,7 +254,6 @@ void PathExecuter::setLocal(Position pos) {
 }
 
 bool PathExecuter::isArrived(Position goal) {
-    double ACCURACY = 0.10;
     double DEG_ACCURACY = 0.1;
     if (robotLocation.calcDistTo(goal) <= ACCURACY) {
         if (std::abs(robotLocation.yaw*(180.0/M_PI) - goal.yaw*(180.0/M_PI)) <= DEG_ACCURACY)
@@ -161,13 +263,10 @@ bool PathExecuter::isArrived(Position goal) {
 }
 
 void PathExecuter::abandonPath() {
-    //delete old path if not already deleted
-    if (path != NULL) {
-        delete path;
-        path = NULL;
-    }
+    hasPath = false;
+    following = false;
 }
 
 std::string PathExecuter::toString() {
-    return "PathExecuter";
+    return "PathExecuter " + tracker.toString() + " " + mpc.toString();
 }
@@ -13,6 +13,9 @@
 #include "actr/motor.h"
 #include "data/path.h"
 #include "pathplanner.h"
+#include "navigation.h"
+#include "purepursuit.h"
+#include "mpctracker.h"
 
 /** Follows a given Path.
  *
@@ -22,15 +25,29 @@
  *  A Path should be created, ideally by the PathPlanner, and then supplied
  *  to this class for execution. This should be the only class, with the
  *  exception of ObjectAvoider, that should physically move the robot. This
- *  Class also handles deleting Path objects once it has exhausted executing
- *  a said Path. A controller can determine that a Path has been fully executed
- *  by checking if the pointer to the Path is NULL.
+ *  Class keeps its own copy of the Path, consumed as it is executed, in
+ *  storage reused from one Path to the next. A controller can determine
+ *  that a Path has been fully executed when execute returns true.
+ *
+ *  When tracking, which is the default, the positions of a Path are
+ *  driven through without stopping by PurePursuit, up to the last one or
+ *  the first one with moves to make, where the robot stops. Predictive
+ *  tracking drives them with MpcTracker instead, which holds the line
+ *  closer around corners, as in tight corridors. Neither looks out for
+ *  obstacles, so given a Navigation the speeds they pick are checked on
+ *  its costmap first, and while they would run into something the robot
+ *  is steered by the local planner instead.
+ *
+ *  Given a Navigation, positions are driven to with its local planner,
+ *  which looks ahead for obstacles, and Player's "GoTo" only turns the
+ *  robot to the yaw of a position once it is there.
  */
 class PathExecuter : public Module {
     public:
 
         const static double SPEED = 0.5;
         const static double TURNRATE = 0.5;
+        const static double ACCURACY = 0.10;
 
         /** Default constructor. */
         PathExecuter();
@@ -52,11 +69,9 @@ class PathExecuter : public Module {
          *  from Player/Stage, otherwise it follows each Move from the first
          *  Position only.
          *
-         *  @param path : A reference to the current path.
-         *
-         *  @param type : Decides whether to execute across positions or moves.
+         *  @param path : The path, copied so the caller can reuse it.
          */
-        void setPath(Path& path);
+        void setPath(const Path& path);
 
         /** Applies a motion and updates the motor.
          *
@@ -92,8 +107,8 @@ class PathExecuter : public Module {
          *  Resumes executing the path or starts executing a newly given path
          * 	with respect to Move structs.
          *
-         *  @param remove : Set true (by default) to have PathExecuter delete
-         *                  the Path object when finished executing.
+         *  @param remove : Set true (by default) to have PathExecuter abandon
+         *                  the Path when finished executing.
          *
          *  @return True if finished executing the path, false otherwise.
          */
@@ -115,6 +130,40 @@ class PathExecuter : public Module {
          */
         bool execute();
 
+        /** Gives the Position the robot is driving to.
+         *
+         *  @param target : Set to the next Position of the path.
+         *
+         *  @return False if no Position is being driven to, such as with
+         *      no path or while its moves are executed.
+         */
+        bool getTarget(Position& target);
+
+        /** Sets whether to drive through positions without stopping.
+         *
+         *  @param on : True to track the path with PurePursuit, false to
+         *      stop at every position.
+         */
+        void setTracking(bool on);
+
+        /** @return True if positions are driven through without stopping. */
+        bool isTracking() const { return tracking; }
+
+        /** Sets whether to track paths by model predictive control.
+         *
+         *  @param on : True to track with MpcTracker, false with
+         *      PurePursuit.
+         */
+        void setPredictive(bool on);
+
+        /** @return True if paths are tracked by model predictive control. */
+        bool isPredictive() const { return predictive; }
+
+        /** Sets the Navigation that steers between positions.
+         *
+         *  @param nav : A reference to the Navigation.
+         */
+        void setNavigation(Navigation& nav);
 
         /** Sets a reference to the robot motor.
          *
@@ -136,7 +185,7 @@ class PathExecuter : public Module {
 
         /** Abandons the current Path.
          *
-         *  Deletes the current Path and sets reference to NULL.
+         *  The current Path is dropped, its storage kept for the next.
          */
         void abandonPath();
 
@@ -152,8 +201,28 @@ class PathExecuter : public Module {
         /** Reference to the robot motor. */
         Motor* motor;
 
-        /** Reference to the current path. */
-        Path* path;
+        /** Steers between positions, NULL to use "GoTo" only. */
+        Navigation* nav;
+
+        /** Drive through positions without stopping. */
+        PurePursuit tracker;
+        MpcTracker mpc;
+
+        /** Whether to track paths, whether with mpc, and whether the
+         *  tracker is following the current one.
+         */
+        bool tracking, predictive, following;
+
+        /** Index in the tracker of the first position still on the path. */
+        int passed;
+
+        /** Speeds last given by the tracker, and when. */
+        Motion speed;
+        int64_t lastTime;
+
+        /** The current path, and whether there is one. */
+        Path path;
+        bool hasPath;
 
         /** Current Position of Robot. */
         Position robotLocation;
@@ -164,6 +233,17 @@ class PathExecuter : public Module {
         /** Used as reference for subsequent execute calls on same Path. */
         bool alreadyFound;
 
+        /** Drives towards a position. */
+        void driveTo(Position goal);
+
+        /** Drives along the path with the tracker.
+         *
+         *  @return False if there is nothing to track, it has been
+         *      tracked to its end, or the speeds picked would run into an
+         *      obstacle.
+         */
+        bool follow();
+
         /** Disable copy constructor. */
         PathExecuter(const PathExecuter& source);
 
@@ -2,14 +2,52 @@
 
 CREATE_LOGGER("PathPlanner");
 
-Path* PathPlanner::calcPath(Position p1 , Position p2){
+void PathPlanner::calcPath(Position p1 , Position p2, Path& path){
     double dist = p1.calcDistTo(p2);
     double yaw = p1.calcAngleTo(p2);
-    MAKE_LOG << "Dist: " << dist << "Yaw: " << yaw << std::endl;
-    Path* path = new Path(p1);
-    path->addMove(Move(yaw,false));
-    path->addMove(Move(dist,true));
-    return path;
+    LOG_DEBUG << "Dist: " << dist << "Yaw: " << yaw << std::endl;
+    path.reset(p1);
+    path.addMove(Move(yaw,false));
+    path.addMove(Move(dist,true));
+}
+
+bool PathPlanner::calcPath(GridPlanner& planner, const Map& map,
+                           Position robot, Position dest, Path& path) {
+    planner.setMode(GridPlanner::JUMP_POINT);
+    planner.setRadius(ROBOT_RADIUS);
+
+    int sx, sy, gx, gy;
+    std::vector<int> cells;
+    if (!map.worldToGrid(robot.x, robot.y, sx, sy) ||
+        !map.worldToGrid(dest.x, dest.y, gx, gy) ||
+        !planner.search(map, sx, sy, gx, gy, cells)) {
+        MAKE_LOG << "No path from (" << robot.x << ", " << robot.y << ") to ("
+                 << dest.x << ", " << dest.y << ")." << std::endl;
+        return false;
+    }
+    LOG_DEBUG << "JPS expanded " << planner.getExpanded() << " cells, path of "
+              << cells.size() << " cells." << std::endl;
+    toPath(map, cells, robot, dest, path);
+    return true;
+}
+
+void PathPlanner::toPath(const Map& map, const std::vector<int>& cells,
+                         Position robot, Position dest, Path& path) {
+    //keep the cells where the direction changes
+    int w = map.getWidth();
+    path.clear();
+    Position last = robot;
+    for (unsigned int i = 1; i + 1 < cells.size(); i++) {
+        int dIn = cells[i] - cells[i-1];
+        int dOut = cells[i+1] - cells[i];
+        if (dIn == dOut)
+            continue;
+        Position p = map.gridToWorld(cells[i] % w, cells[i] / w);
+        p.yaw = atan2(p.y - last.y, p.x - last.x);
+        path.addPosition(p);
+        last = p;
+    }
+    path.addPosition(dest);
 }
 
 Position PathPlanner::calcPosition(Position p1, double dist) {
@@ -20,6 +58,6 @@ Position PathPlanner::calcPosition(Position p1, double dist) {
     return end;
 }
 
-Path* PathPlanner::calcPath(Position p1, double dist) {
-    return calcPath(p1, calcPosition(p1, dist));
+void PathPlanner::calcPath(Position p1, double dist, Path& path) {
+    calcPath(p1, calcPosition(p1, dist), path);
 }
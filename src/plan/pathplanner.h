@@ -11,6 +11,9 @@
 #include <math.h>
 #include "data/position.h"
 #include "data/path.h"
+#include "data/footprint.h"
+#include "plan/map.h"
+#include "plan/gridplanner.h"
 #include "util/logger.h"
 
 /** Utility Class Containing Static Planning Functions.
@@ -20,18 +23,51 @@
  **/
 class PathPlanner {
     public:
+
         /** Calculates a Path from a Point to Destination
         *
         * Calculates a direct path from the Robot to the desired Destination.
         *
         * @param robot : Position to start calculating path from.
         * @param dest : Position of the goal Destination.
-        * @return Path.
+        * @param path : Set to the Path.
         */
-        static Path* calcPath(Position p1 , Position dest);
+        static void calcPath(Position p1 , Position dest, Path& path);
+
+        /** Calculates a Path around the obstacles of a Map.
+         *
+         *  Searches the map with Jump Point Search (see GridPlanner) and
+         *  returns the corners of the shortest path as positions, each
+         *  facing the way the robot travels to reach it. The last position is @p dest .
+         *  The path keeps ROBOT_RADIUS clear of obstacles on maps with
+         *  a distance field.
+         *
+         *  @param planner : Searches the map, owned by the caller so its
+         *      buffers are kept between calls.
+         *  @param map : The map to plan on.
+         *  @param robot : Position to start calculating path from.
+         *  @param dest : Position of the goal Destination.
+         *  @param path : Set to the Path, left alone if there is none.
+         *  @return False if the destination cannot be reached, or the
+         *      robot or destination is off the map or too close to an
+         *      obstacle.
+         */
+        static bool calcPath(GridPlanner& planner, const Map& map,
+                             Position robot, Position dest, Path& path);
+
+        /** Turns a path of cells into a Path of its corners.
+         *
+         *  @param map : The map the cells are on.
+         *  @param cells : The cells of the path, start first, as y*width+x.
+         *  @param robot : Position the path starts from.
+         *  @param dest : Position of the goal Destination, the last position.
+         *  @param path : Set to the Path.
+         */
+        static void toPath(const Map& map, const std::vector<int>& cells,
+                           Position robot, Position dest, Path& path);
 
         //comment later todo
-        static Path* calcPath(Position p1, double dist);
+        static void calcPath(Position p1, double dist, Path& path);
 
         /** Returns a new Position based on a root Position and distance traveled.
          *
@@ -0,0 +1,163 @@
+#include "purepursuit.h"
+#include <math.h>
+#include <algorithm>
+#include "util/geometry.h"
+
+CREATE_LOGGER("PurePursuit");
+
+/** Top speeds, in meters and radians per second. */
+static const double MAX_SPEED = 0.5, MAX_TURN = 1.0;
+
+/** Acceleration and braking, in meters per second squared. */
+static const double ACCEL = 0.5, DECEL = 0.5;
+
+/** Sideways acceleration allowed on turns, in meters per second squared. */
+static const double MAX_LATERAL = 0.4;
+
+/** Look-ahead is the minimum plus the distance driven in LOOKAHEAD_TIME,
+ *  up to the maximum, in meters.
+ */
+static const double LOOKAHEAD_MIN = 0.3, LOOKAHEAD_MAX = 1.0,
+                    LOOKAHEAD_TIME = 0.5;
+
+/** Distance from the last waypoint at which it is reached, in meters. */
+static const double GOAL_TOLERANCE = 0.1;
+
+PurePursuit::PurePursuit() {
+    segment = 0;
+    progress = 0;
+    finished = true;
+    tracks = 0;
+    driven = error = 0;
+    LOG_CTOR << "Constructed." << std::endl;
+}
+
+PurePursuit::~PurePursuit() {
+    LOG_DTOR << "Destructed." << std::endl;
+}
+
+void PurePursuit::setPath(const std::vector<Position>& waypoints) {
+    points = waypoints;
+    int n = points.size();
+    along.assign(n, 0);
+    for (int i = 1; i < n; i++)
+        along[i] = along[i - 1] + hypot(points[i].x - points[i - 1].x,
+                                        points[i].y - points[i - 1].y);
+
+    //a corner turned through theta is cut on an arc tangent to both legs
+    //about the minimum look-ahead from it
+    cornerSpeed.assign(n, MAX_SPEED);
+    for (int i = 1; i + 1 < n; i++) {
+        double in = atan2(points[i].y - points[i - 1].y, points[i].x - points[i - 1].x);
+        double out = atan2(points[i + 1].y - points[i].y, points[i + 1].x - points[i].x);
+        double theta = fabs(wrapAngle(out - in));
+        double curvature = tan(std::min(theta, M_PI - 1e-3) / 2) / LOOKAHEAD_MIN;
+        if (curvature > 1e-9)
+            cornerSpeed[i] = std::min(MAX_SPEED, std::min(MAX_TURN / curvature,
+                                                          sqrt(MAX_LATERAL / curvature)));
+    }
+
+    //brake in time for every corner after, and to stop at the end
+    if (n > 0)
+        cornerSpeed[n - 1] = 0;
+    for (int i = n - 2; i >= 0; i--)
+        cornerSpeed[i] = std::min(cornerSpeed[i], sqrt(cornerSpeed[i + 1] * cornerSpeed[i + 1] +
+                                                       2 * DECEL * (along[i + 1] - along[i])));
+    segment = 0;
+    progress = 0;
+    finished = n < 2;
+}
+
+Motion PurePursuit::track(const Position& robot, const Motion& current, double period) {
+    if (finished)
+        return Motion();
+    int n = points.size();
+    double total = along[n - 1];
+
+    //closest point on the line, never going back and looking no further
+    //ahead than the robot could have got
+    double best = HUGE_VAL, bestAlong = progress;
+    int bestSegment = segment;
+    for (int i = segment; i + 1 < n && along[i] <= progress + LOOKAHEAD_MAX; i++) {
+        double sx = points[i + 1].x - points[i].x, sy = points[i + 1].y - points[i].y;
+        double length = along[i + 1] - along[i];
+        double t = length > 0 ? ((robot.x - points[i].x) * sx +
+                                 (robot.y - points[i].y) * sy) / (length * length) : 0;
+        t = std::min(std::max(t, 0.0), 1.0);
+        double dx = points[i].x + t * sx - robot.x, dy = points[i].y + t * sy - robot.y;
+        double d = dx * dx + dy * dy;
+        if (d < best && along[i] + t * length >= progress) {
+            best = d;
+            bestAlong = along[i] + t * length;
+            bestSegment = i;
+        }
+    }
+    driven += bestAlong - progress;
+    progress = bestAlong;
+    segment = bestSegment;
+    if (best < HUGE_VAL)
+        error = std::max(error, sqrt(best));
+
+    Position end = points[n - 1];
+    if (hypot(end.x - robot.x, end.y - robot.y) <= GOAL_TOLERANCE) {
+        finished = true;
+        segment = n - 2;
+        return Motion();
+    }
+
+    //the arc through the look-ahead point, in the robot frame
+    double lookahead = std::min(LOOKAHEAD_MAX, LOOKAHEAD_MIN + LOOKAHEAD_TIME * fabs(current.x));
+    Position goal = pointAt(std::min(progress + lookahead, total));
+    double c = cos(robot.yaw), s = sin(robot.yaw);
+    double dx = goal.x - robot.x, dy = goal.y - robot.y;
+    double lx = c * dx + s * dy, ly = -s * dx + c * dy;
+    double d2 = lx * lx + ly * ly;
+    double curvature = d2 > 1e-9 ? 2 * ly / d2 : 0;
+
+    //fastest allowed here, then within the acceleration limits
+    double target = MAX_SPEED;
+    if (fabs(curvature) > 1e-9)
+        target = std::min(target, std::min(MAX_TURN / fabs(curvature),
+                                           sqrt(MAX_LATERAL / fabs(curvature))));
+    double next = cornerSpeed[segment + 1], left = along[segment + 1] - progress;
+    if (segment == n - 2)
+        left = std::max(left, hypot(end.x - robot.x, end.y - robot.y)); //beside the end
+    target = std::min(target, sqrt(next * next + 2 * DECEL * left));
+    if (lx < 0)
+        target = 0; //facing away, turn on the spot first
+    double v = std::min(target, current.x + ACCEL * period);
+    v = std::max(v, std::max(current.x - DECEL * period, 0.0));
+
+    Motion m;
+    m.x = v;
+    if (lx < 0)
+        m.yaw = ly >= 0 ? MAX_TURN : -MAX_TURN;
+    else
+        m.yaw = std::max(-MAX_TURN, std::min(MAX_TURN, v * curvature));
+    tracks++;
+    return m;
+}
+
+Position PurePursuit::pointAt(double distance) const {
+    int i = std::upper_bound(along.begin(), along.end(), distance) - along.begin() - 1;
+    i = std::min(std::max(i, 0), (int)points.size() - 2);
+    double length = along[i + 1] - along[i];
+    double t = length > 0 ? (distance - along[i]) / length : 0;
+    return Position(points[i].x + t * (points[i + 1].x - points[i].x),
+                    points[i].y + t * (points[i + 1].y - points[i].y), 0);
+}
+
+double PurePursuit::speedAt(double distance) const {
+    int i = std::upper_bound(along.begin(), along.end(), distance) - along.begin();
+    if (i >= (int)along.size())
+        return 0;
+    double next = cornerSpeed[i];
+    return std::min(MAX_SPEED, sqrt(next * next + 2 * DECEL * (along[i] - distance)));
+}
+
+std::string PurePursuit::toString() {
+    std::stringstream ss;
+    ss << "PurePursuit: " << tracks << " tracks over " << driven
+       << " m, at most " << error << " m off the line.";
+    return ss.str();
+}
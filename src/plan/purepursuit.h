@@ -0,0 +1,112 @@
+/** @file       src/plan/purepursuit.h
+    @ingroup    PLAN
+    @brief      Pure pursuit path tracking with a velocity profile.
+    @author     Alex Moriarty <alexander@dal.ca>
+    @author     Jacob Perron <perronj@yorku.ca>
+*/
+
+#ifndef __PLAN_PUREPURSUIT_H_
+#define __PLAN_PUREPURSUIT_H_
+
+#include <stdint.h>
+#include <vector>
+#include <sstream>
+#include "infs/module.h"
+#include "data/motion.h"
+#include "data/position.h"
+
+/** Drives along a line of waypoints without stopping at them.
+ *
+ *  Every tick the robot is projected onto the line, and a point further
+ *  along it by the look-ahead distance is chased on the arc through it
+ *  that the robot is tangent to. The look-ahead grows with speed, so the
+ *  robot cuts corners smoothly when fast and sticks to the line when
+ *  slow.
+ *
+ *  The speed follows a trapezoidal profile: the robot accelerates up to
+ *  its top speed, and brakes in time to take every corner at a speed its
+ *  turn rate and sideways acceleration allow, and to stop at the end.
+ *  The corner speeds are worked out backwards from the end once, when the
+ *  waypoints are set.
+ */
+class PurePursuit : public Module {
+    public:
+
+        /** Constructor. */
+        PurePursuit();
+
+        /** Destructor. */
+        ~PurePursuit();
+
+        /** Sets the waypoints to drive along.
+         *
+         *  @param waypoints : Where the robot is, followed by the
+         *      positions to drive through, the last one to stop at.
+         */
+        void setPath(const std::vector<Position>& waypoints);
+
+        /** Picks the speeds to drive at for the next period.
+         *
+         *  @param robot : Where the robot is.
+         *
+         *  @param current : The speeds the robot is driving at.
+         *
+         *  @param period : Time until the next call, in seconds.
+         *
+         *  @return The speeds, a stop once finished.
+         */
+        Motion track(const Position& robot, const Motion& current, double period);
+
+        /** @return Index of the waypoint being driven to, those before it
+         *      have been driven past.
+         */
+        int getWaypoint() const { return segment + 1; }
+
+        /** @return True once the robot is at the last waypoint. */
+        bool isFinished() const { return finished; }
+
+        /** @return Distance along the line the robot has got to. */
+        double getProgress() const { return progress; }
+
+        /** @return The point a distance along the line. */
+        Position pointAt(double distance) const;
+
+        /** @return Fastest the robot may drive a distance along the line
+         *      to brake in time for the corners after and the end.
+         */
+        double speedAt(double distance) const;
+
+        /** Returns the distance driven and how far off the line. */
+        std::string toString();
+
+    private:
+
+        /** Disable copy constructor. */
+        PurePursuit(const PurePursuit& source);
+
+        /** Disable assignment operator. */
+        PurePursuit& operator=(const PurePursuit& source);
+
+        /** The waypoints. */
+        std::vector<Position> points;
+
+        /** Distance along the line to each waypoint. */
+        std::vector<double> along;
+
+        /** Fastest the robot may pass each waypoint. */
+        std::vector<double> cornerSpeed;
+
+        /** Segment the robot is on, from waypoint segment to the next. */
+        int segment;
+
+        /** Distance along the line the robot has got to. */
+        double progress;
+
+        /** Whether the robot is at the last waypoint. */
+        bool finished;
+
+        /** Statistics. */
+        unsigned long tracks;
+        double driven, error;
+};
+#endif
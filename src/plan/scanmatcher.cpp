@@ -0,0 +1,354 @@
+#include "scanmatcher.h"
+#include <math.h>
+#include <algorithm>
+#include "util/geometry.h"
+#include "util/scankernels.h"
+#include "util/scheduler.h"
+
+CREATE_LOGGER("ScanMatcher");
+
+/** Furthest a reading is paired with a reference point, in meters. */
+static const float MAX_PAIR_DISTANCE = 0.3;
+
+/** Furthest apart neighbouring readings on one line are, in meters. */
+static const float NEIGHBOUR_DISTANCE = 0.25;
+
+/** Fewest pairs a match is trusted with. */
+static const int MIN_PAIRS = 20;
+
+/** Iterations before a match is given up on. */
+static const int MAX_ITERATIONS = 30;
+
+/** Change of the pose small enough to stop at, in meters and radians. */
+static const double CONVERGED = 1e-4;
+
+/** Least curvature of the error, per pair, along a direction of the pose
+ *  the pairs fix. Readings all on one wall leave the motion along it
+ *  below this, as in a corridor whose ends are out of sight.
+ */
+static const double WEAK_DIRECTION = 0.05;
+
+/** Furthest a match may move the pose from the initial guess, in meters
+ *  and radians. Further, the guess is trusted over the scans.
+ */
+static const double MAX_CORRECTION = 0.25, MAX_YAW_CORRECTION = 0.25;
+
+/** Normal of the line best fitting points around a centroid.
+ *
+ *  @return False if the points are all in one place.
+ */
+static bool fitNormal(double sxx, double sxy, double syy, float& nx, float& ny) {
+    if (sxx + syy <= 0)
+        return false;
+
+    //the line runs along the major axis of the covariance
+    double theta = 0.5 * atan2(2 * sxy, sxx - syy);
+    nx = -sin(theta);
+    ny = cos(theta);
+    return true;
+}
+
+/** @return True if a cell is on the map and occupied. */
+static bool occupied(const Map& m, int x, int y) {
+    return m.inBounds(x, y) && m.isOccupied(x, y);
+}
+
+/** Eigen decomposition of a symmetric 3x3 matrix by Jacobi rotations.
+ *
+ *  @param value : Set to the eigenvalues.
+ *
+ *  @param vector : Set to the eigenvectors, one per column.
+ */
+static void eigen(const double m[3][3], double value[3], double vector[3][3]) {
+    double a[3][3];
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++) {
+            a[i][j] = m[i][j];
+            vector[i][j] = i == j;
+        }
+
+    for (int sweep = 0; sweep < 16; sweep++) {
+        double off = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+        double diagonal = a[0][0] * a[0][0] + a[1][1] * a[1][1] + a[2][2] * a[2][2];
+        if (off <= 1e-24 * diagonal)
+            break;
+
+        //rotate each off-diagonal element to zero in turn
+        for (int p = 0; p < 2; p++)
+            for (int q = p + 1; q < 3; q++) {
+                if (a[p][q] == 0)
+                    continue;
+                double theta = (a[q][q] - a[p][p]) / (2 * a[p][q]);
+                double t = (theta >= 0 ? 1 : -1) / (fabs(theta) + sqrt(theta * theta + 1));
+                double c = 1 / sqrt(t * t + 1), s = t * c;
+                for (int k = 0; k < 3; k++) {
+                    double kp = a[k][p], kq = a[k][q];
+                    a[k][p] = c * kp - s * kq;
+                    a[k][q] = s * kp + c * kq;
+                }
+                for (int k = 0; k < 3; k++) {
+                    double pk = a[p][k], qk = a[q][k];
+                    a[p][k] = c * pk - s * qk;
+                    a[q][k] = s * pk + c * qk;
+                }
+                for (int k = 0; k < 3; k++) {
+                    double kp = vector[k][p], kq = vector[k][q];
+                    vector[k][p] = c * kp - s * kq;
+                    vector[k][q] = s * kp + c * kq;
+                }
+            }
+    }
+    for (int i = 0; i < 3; i++)
+        value[i] = a[i][i];
+}
+
+/** Solves a symmetric 3x3 system only along the directions it fixes.
+ *
+ *  Along the eigenvectors whose eigenvalue is below @p weak the solution
+ *  is left at zero, so a step keeps the initial guess there instead of
+ *  following noise.
+ *
+ *  @return Number of directions solved along.
+ */
+static int solve(const double a[3][3], const double b[3], double weak, double x[3]) {
+    double value[3], vector[3][3];
+    eigen(a, value, vector);
+    x[0] = x[1] = x[2] = 0;
+    int strong = 0;
+    for (int k = 0; k < 3; k++) {
+        if (value[k] < weak || value[k] <= 0)
+            continue;
+        double along = (vector[0][k] * b[0] + vector[1][k] * b[1] +
+                        vector[2][k] * b[2]) / value[k];
+        for (int i = 0; i < 3; i++)
+            x[i] += along * vector[i][k];
+        strong++;
+    }
+    return strong;
+}
+
+ScanMatcher::ScanMatcher() {
+    started = false;
+    matches = failures = degenerate = iterations = 0;
+    time = 0;
+    LOG_CTOR << "Constructed." << std::endl;
+}
+
+ScanMatcher::~ScanMatcher() {
+    LOG_DTOR << "Destructed." << std::endl;
+}
+
+Position ScanMatcher::update(const Position& odometry, const RangerData& scan) {
+    toPoints(scan, points);
+    if (!started) {
+        lastPose = odometry;
+        started = true;
+    }
+    else {
+        //odometry motion since the last scan, in its frame
+        double dx = odometry.x - lastOdometry.x, dy = odometry.y - lastOdometry.y;
+        double c = cos(lastOdometry.yaw), s = sin(lastOdometry.yaw);
+        Position motion(c * dx + s * dy, -s * dx + c * dy,
+                        wrapAngle(odometry.yaw - lastOdometry.yaw));
+        match(last, points, motion);
+
+        c = cos(lastPose.yaw);
+        s = sin(lastPose.yaw);
+        lastPose = Position(lastPose.x + c * motion.x - s * motion.y,
+                            lastPose.y + s * motion.x + c * motion.y,
+                            wrapAngle(lastPose.yaw + motion.yaw));
+    }
+
+    //this scan is the reference for the next
+    reference = points;
+    addNormals(reference);
+    last.build(reference);
+    lastOdometry = odometry;
+    return lastPose;
+}
+
+Position ScanMatcher::predict(const Position& odometry) const {
+    if (!started)
+        return odometry;
+    double dx = odometry.x - lastOdometry.x, dy = odometry.y - lastOdometry.y;
+    double c = cos(lastOdometry.yaw), s = sin(lastOdometry.yaw);
+    double mx = c * dx + s * dy, my = -s * dx + c * dy;
+    c = cos(lastPose.yaw);
+    s = sin(lastPose.yaw);
+    return Position(lastPose.x + c * mx - s * my, lastPose.y + s * mx + c * my,
+                    wrapAngle(lastPose.yaw + odometry.yaw - lastOdometry.yaw));
+}
+
+bool ScanMatcher::matchScans(const RangerData& ref, const RangerData& scan,
+                             Position& pose) {
+    toPoints(ref, reference);
+    addNormals(reference);
+    KdTree tree;
+    tree.build(reference);
+    toPoints(scan, points);
+    return match(tree, points, pose);
+}
+
+void ScanMatcher::setMap(const Map& m) {
+    std::vector<KdTree::Point> edges;
+    double c = cos(m.getOrigin().yaw), s = sin(m.getOrigin().yaw);
+    for (int y = 0; y < m.getHeight(); y++) {
+        for (int x = 0; x < m.getWidth(); x++) {
+            //only occupied cells facing a free one can be seen
+            if (!m.isOccupied(x, y) ||
+                (occupied(m, x - 1, y) && occupied(m, x + 1, y) &&
+                 occupied(m, x, y - 1) && occupied(m, x, y + 1)))
+                continue;
+
+            //fit a line to the occupied cells around it
+            int n = 0;
+            double sx = 0, sy = 0, sxx = 0, sxy = 0, syy = 0;
+            for (int j = -2; j <= 2; j++) {
+                for (int i = -2; i <= 2; i++) {
+                    if (!occupied(m, x + i, y + j))
+                        continue;
+                    n++;
+                    sx += i;
+                    sy += j;
+                    sxx += i * i;
+                    sxy += i * j;
+                    syy += j * j;
+                }
+            }
+            sx /= n;
+            sy /= n;
+            float nx, ny;
+            if (!fitNormal(sxx / n - sx * sx, sxy / n - sx * sy, syy / n - sy * sy, nx, ny))
+                continue;
+            Position p = m.gridToWorld(x, y);
+            edges.push_back(KdTree::Point(p.x, p.y, c * nx - s * ny, s * nx + c * ny));
+        }
+    }
+    map.build(edges);
+    MAKE_LOG << "Map has " << map.size() << " edge cells." << std::endl;
+}
+
+bool ScanMatcher::matchMap(const RangerData& scan, Position& pose) {
+    if (map.size() == 0)
+        return false;
+    toPoints(scan, points);
+    return match(map, points, pose);
+}
+
+void ScanMatcher::toPoints(const RangerData& data, std::vector<KdTree::Point>& out) {
+    const Scan& scan = data.scan;
+    FloatArray px, py;
+    ScanKernels::toCartesian(scan, px, py);
+    out.clear();
+    for (unsigned int i = 0; i < scan.size; i++)
+        if (scan.range[i] < data.maxRange && scan.range[i] > data.minRange)
+            out.push_back(KdTree::Point(px[i], py[i], 0, 0));
+}
+
+void ScanMatcher::addNormals(std::vector<KdTree::Point>& p) {
+    int n = p.size(), kept = 0;
+    std::vector<KdTree::Point> fitted(n);
+    for (int i = 0; i < n; i++) {
+        //neighbours in the scan close enough to be on the same surface
+        int count = 0;
+        double sx = 0, sy = 0, sxx = 0, sxy = 0, syy = 0;
+        for (int j = std::max(0, i - 2); j <= std::min(n - 1, i + 2); j++) {
+            float dx = p[j].x - p[i].x, dy = p[j].y - p[i].y;
+            if (dx * dx + dy * dy > NEIGHBOUR_DISTANCE * NEIGHBOUR_DISTANCE)
+                continue;
+            count++;
+            sx += dx;
+            sy += dy;
+            sxx += dx * dx;
+            sxy += dx * dy;
+            syy += dy * dy;
+        }
+        if (count < 3)
+            continue;
+        sx /= count;
+        sy /= count;
+        float nx, ny;
+        if (fitNormal(sxx / count - sx * sx, sxy / count - sx * sy,
+                      syy / count - sy * sy, nx, ny))
+            fitted[kept++] = KdTree::Point(p[i].x, p[i].y, nx, ny);
+    }
+    fitted.resize(kept);
+    p.swap(fitted);
+}
+
+bool ScanMatcher::match(const KdTree& tree, const std::vector<KdTree::Point>& p,
+                        Position& pose) {
+    int64_t start = Scheduler::now();
+    double x = pose.x, y = pose.y, yaw = pose.yaw;
+    bool converged = false, weak = false;
+
+    for (int it = 0; it < MAX_ITERATIONS && !converged; it++) {
+        iterations++;
+        double c = cos(yaw), s = sin(yaw);
+        double h[3][3] = { { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0, 0 } };
+        double g[3] = { 0, 0, 0 };
+        int pairs = 0;
+
+        //pair every point with the line through its nearest reference
+        for (unsigned int i = 0; i < p.size(); i++) {
+            float wx = c * p[i].x - s * p[i].y + x;
+            float wy = s * p[i].x + c * p[i].y + y;
+            int k = tree.nearest(wx, wy, MAX_PAIR_DISTANCE);
+            if (k < 0)
+                continue;
+            const KdTree::Point& q = tree[k];
+            double e = q.nx * (wx - q.x) + q.ny * (wy - q.y);
+            double j[3] = { q.nx, q.ny,
+                            q.nx * (-s * p[i].x - c * p[i].y) +
+                            q.ny * (c * p[i].x - s * p[i].y) };
+            for (int a = 0; a < 3; a++) {
+                g[a] -= j[a] * e;
+                for (int b = 0; b < 3; b++)
+                    h[a][b] += j[a] * j[b];
+            }
+            pairs++;
+        }
+
+        //one Gauss-Newton step towards the lines, along the directions
+        //they fix
+        double d[3];
+        if (pairs < MIN_PAIRS)
+            break;
+        int strong = solve(h, g, WEAK_DIRECTION * pairs, d);
+        if (strong == 0)
+            break;
+        weak = strong < 3;
+        x += d[0];
+        y += d[1];
+        yaw = wrapAngle(yaw + d[2]);
+        converged = fabs(d[0]) < CONVERGED && fabs(d[1]) < CONVERGED &&
+                    fabs(d[2]) < CONVERGED;
+    }
+
+    matches++;
+    time += Scheduler::now() - start;
+    if (weak)
+        degenerate++;
+
+    //a match far from the guess is more likely a wrong one
+    if (!converged ||
+        (x - pose.x) * (x - pose.x) + (y - pose.y) * (y - pose.y) >
+            MAX_CORRECTION * MAX_CORRECTION ||
+        fabs(wrapAngle(yaw - pose.yaw)) > MAX_YAW_CORRECTION) {
+        failures++;
+        return false;
+    }
+    pose = Position(x, y, yaw);
+    return true;
+}
+
+std::string ScanMatcher::toString() {
+    std::stringstream ss;
+    ss << "ScanMatcher: " << matches << " matches";
+    if (matches > 0)
+        ss << " of " << time / 1e6 / matches << " ms and "
+           << (double)iterations / matches << " iterations on average, "
+           << failures << " failed, " << degenerate << " degenerate";
+    ss << ".";
+    return ss.str();
+}
@@ -0,0 +1,153 @@
+/** @file       src/plan/scanmatcher.h
+    @ingroup    PLAN
+    @brief      Laser scan matching with point-to-line ICP.
+    @author     Alex Moriarty <alexander@dal.ca>
+    @author     Jacob Perron <perronj@yorku.ca>
+*/
+
+#ifndef __PLAN_SCANMATCHER_H_
+#define __PLAN_SCANMATCHER_H_
+
+#include <stdint.h>
+#include <vector>
+#include <sstream>
+#include "infs/module.h"
+#include "data/rangerdata.h"
+#include "data/position.h"
+#include "plan/map.h"
+#include "util/kdtree.h"
+
+/** Corrects odometry by aligning laser scans.
+ *
+ *  A scan is aligned with a reference by point-to-line ICP: each reading
+ *  is paired with the nearest reference point, found in a KdTree, and the
+ *  pose is solved for that moves the readings onto the lines through
+ *  their pairs, over and over until it stops changing. Matching points
+ *  against lines rather than points converges in a handful of iterations
+ *  on the walls and corners a laser sees indoors.
+ *
+ *  Scan to scan, every scan is matched against the one before it,
+ *  starting from the odometry motion in between, and the matched motions
+ *  are chained into a pose that drifts far less than the wheels. The
+ *  tree is rebuilt for each new reference scan.
+ *
+ *  Scan to map, a scan is matched against the edges of the occupied
+ *  cells of a Map, whose tree is built once. The Localizer uses this to
+ *  refine the mean of its particles.
+ *
+ *  Each step is only taken along the directions of the pose the pairs
+ *  fix, found from the eigenvalues of the normal equations; in a corridor
+ *  the motion along it stays at the initial guess rather than following
+ *  noise. A match that moves the pose too far from the guess is rejected.
+ */
+class ScanMatcher : public Module {
+    public:
+
+        /** Constructor. */
+        ScanMatcher();
+
+        /** Destructor. */
+        ~ScanMatcher();
+
+        /** Chains the motion between the last scan and this one.
+         *
+         *  The first call starts the chain at the odometry. If a scan
+         *  cannot be matched, the odometry motion is used for it.
+         *
+         *  @param odometry : Pose reported by the odometry.
+         *
+         *  @param scan : Laser readings taken at that pose.
+         *
+         *  @return The odometry corrected by the scans.
+         */
+        Position update(const Position& odometry, const RangerData& scan);
+
+        /** Adds the odometry motion since the last scan to its pose.
+         *
+         *  @param odometry : Pose reported by the odometry.
+         *
+         *  @return The odometry corrected by the scans so far, or as is
+         *      before the first scan.
+         */
+        Position predict(const Position& odometry) const;
+
+        /** Matches a scan against another.
+         *
+         *  @param reference : The scan matched against.
+         *
+         *  @param scan : The scan matched.
+         *
+         *  @param pose : Pose of @p scan in the frame of @p reference ,
+         *      set to the match if there is one.
+         *
+         *  @return True if the match converged close enough to the guess.
+         */
+        bool matchScans(const RangerData& reference, const RangerData& scan,
+                        Position& pose);
+
+        /** Sets the map matched against by @ref matchMap .
+         *
+         *  @param map : The map, copied into a tree of its obstacle edges.
+         */
+        void setMap(const Map& map);
+
+        /** Matches a scan against the map.
+         *
+         *  @param scan : The laser readings.
+         *
+         *  @param pose : Where the robot took the scan, set to the match
+         *      if there is one.
+         *
+         *  @return True if the match converged close enough to the guess.
+         */
+        bool matchMap(const RangerData& scan, Position& pose);
+
+        /** Returns the number of matches and how long they took. */
+        std::string toString();
+
+    private:
+
+        /** Disable copy constructor. */
+        ScanMatcher(const ScanMatcher& source);
+
+        /** Disable assignment operator. */
+        ScanMatcher& operator=(const ScanMatcher& source);
+
+        /** Converts the readings that hit something to points. */
+        void toPoints(const RangerData& scan, std::vector<KdTree::Point>& out);
+
+        /** Gives each point the normal of the line through its neighbours
+         *  in the scan, dropping points on no clear line.
+         */
+        void addNormals(std::vector<KdTree::Point>& points);
+
+        /** Aligns points with a tree by ICP.
+         *
+         *  @param pose : Pose of the points in the frame of the tree, the
+         *      initial guess on entry.
+         *
+         *  @return True if the match converged close enough to the guess.
+         */
+        bool match(const KdTree& tree, const std::vector<KdTree::Point>& points,
+                   Position& pose);
+
+        /** Points of the last scan, in a tree. */
+        KdTree last;
+
+        /** Obstacle edges of the map, in a tree. */
+        KdTree map;
+
+        /** Scratch for the points of a scan. */
+        std::vector<KdTree::Point> points, reference;
+
+        /** Whether a scan has been seen. */
+        bool started;
+
+        /** Odometry of the last scan, and the corrected pose there. */
+        Position lastOdometry, lastPose;
+
+        /** Statistics. */
+        unsigned long matches, failures, degenerate, iterations;
+        int64_t time;
+};
+#endif
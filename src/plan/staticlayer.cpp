@@ -0,0 +1,27 @@
+#include "staticlayer.h"
+
+StaticLayer::StaticLayer(const Map& map) {
+    width = map.getWidth();
+    height = map.getHeight();
+    occupied.resize((size_t)width * height);
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+            occupied[(size_t)y * width + x] = map.isOccupied(x, y);
+    fresh = true;
+}
+
+void StaticLayer::updateBounds(Bounds& bounds) {
+    if (!fresh)
+        return;
+    bounds.add(Bounds(0, 0, width - 1, height - 1));
+    fresh = false;
+}
+
+void StaticLayer::updateCosts(Costmap& master, const Bounds& window) {
+    for (int y = window.y0; y <= window.y1; y++) {
+        const uint8_t* row = &occupied[(size_t)y * width];
+        for (int x = window.x0; x <= window.x1; x++)
+            if (row[x])
+                master.raiseCost(x, y, Costmap::LETHAL);
+    }
+}
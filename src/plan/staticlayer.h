@@ -0,0 +1,53 @@
+/** @file       src/plan/staticlayer.h
+    @ingroup    PLAN
+    @brief      Costmap layer of the obstacles known in advance.
+    @author     Alex Moriarty <alexander@dal.ca>
+    @author     Jacob Perron <perronj@yorku.ca>
+*/
+
+#ifndef __PLAN_STATICLAYER_H_
+#define __PLAN_STATICLAYER_H_
+
+#include <stdint.h>
+#include <vector>
+#include "plan/costmap.h"
+
+/** The obstacles of the Map as it was loaded, ie. of the world bitmap.
+ *
+ *  The occupancy is copied when the layer is made, so later updates of
+ *  the map from range data do not show here. The whole map is reported
+ *  changed on the first update and nothing after that.
+ */
+class StaticLayer : public CostmapLayer {
+    public:
+
+        /** Constructor, copies the occupied cells of a map. */
+        StaticLayer(const Map& map);
+
+        /** Inherited from CostmapLayer. */
+        void updateBounds(Bounds& bounds);
+
+        /** Inherited from CostmapLayer. */
+        void updateCosts(Costmap& master, const Bounds& window);
+
+    private:
+
+        /** Disable default constructor. */
+        StaticLayer();
+
+        /** Disable copy constructor. */
+        StaticLayer(const StaticLayer& source);
+
+        /** Disable assignment operator. */
+        StaticLayer& operator=(const StaticLayer& source);
+
+        /** Size of the grid in cells. */
+        int width, height;
+
+        /** One byte per cell, set if occupied. */
+        std::vector<uint8_t> occupied;
+
+        /** True until the first update has drawn the layer. */
+        bool fresh;
+};
+#endif
@@ -1,9 +1,12 @@
 #include "ranger.h"
+#include <sstream>
+#include <math.h>
 
 CREATE_LOGGER("Ranger");
 
 Ranger::Ranger(PlayerCc::RangerProxy& proxy) {
     rangerProxy = &proxy;
+    cacheGeometry();
     LOG_CTOR <<  "Constructed." << std::endl;
 }
 
@@ -11,29 +14,93 @@ Ranger::~Ranger() {
     LOG_DTOR << "Destructed." << std::endl;
 }
 
-RangerData Ranger::getData() {
-    int count = rangerProxy->GetRangeCount();
-    RangerData data;
-
-    for (int i = 0; i < count; i++) {
-        data.range.push_back(rangerProxy->GetRange(i));
-        Position p;
-        p.x = rangerProxy->GetElementPose(i).px;
-        p.y = rangerProxy->GetElementPose(i).py;
-        p.yaw = rangerProxy->GetElementPose(i).pyaw;
-        data.pos.push_back(p);
+void Ranger::cacheGeometry() {
+    unsigned int count = rangerProxy->GetRangeCount();
+    unsigned int elements = rangerProxy->GetElementCount();
+
+    geometry.pos.resize(count);
+    geometry.type = (elements == 1 && count > 1) ? LASER : SONAR;
+    if (geometry.type == SONAR) { //one element per reading
+        for (unsigned int i = 0; i < count; i++) {
+            player_pose3d_t pose = rangerProxy->GetElementPose(i);
+            geometry.pos[i] = Position(pose.px, pose.py, pose.pyaw);
+        }
+    }
+    else { //a single scanning element
+        player_pose3d_t pose = rangerProxy->GetDevicePose();
+        double minAngle = rangerProxy->GetMinAngle();
+        double angleRes = rangerProxy->GetAngularRes();
+        for (unsigned int i = 0; i < count; i++)
+            geometry.pos[i] = Position(pose.px, pose.py, pose.pyaw + minAngle + i*angleRes);
+    }
+
+    //same geometry, laid out for the scan kernels
+    geometry.scan.resize(count);
+    for (unsigned int i = 0; i < count; i++) {
+        const Position& p = geometry.pos[i];
+        geometry.scan.angle[i] = p.yaw;
+        geometry.scan.cosAngle[i] = cos(p.yaw);
+        geometry.scan.sinAngle[i] = sin(p.yaw);
+        geometry.scan.originX[i] = p.x;
+        geometry.scan.originY[i] = p.y;
+    }
+
+    geometry.angleRes = rangerProxy->GetAngularRes();
+    geometry.minAngle = rangerProxy->GetMinAngle();
+    geometry.maxAngle = rangerProxy->GetMaxAngle();
+    geometry.maxRange = rangerProxy->GetMaxRange();
+    geometry.minRange = rangerProxy->GetMinRange();
+    geometry.range.resize(count);
+
+    MAKE_LOG << "Cached geometry of " << count << " readings from a "
+             << (geometry.type == LASER ? "laser." : "sonar.") << std::endl;
+}
+
+RangerSnapshot Ranger::getData() {
+    boost::shared_ptr<RangerData> buffer;
+
+    //reuse a buffer no consumer holds on to any more
+    for (unsigned int i = 0; i < pool.size(); i++) {
+        if (pool[i].unique()) {
+            buffer = pool[i];
+            break;
+        }
+    }
+    if (!buffer) {
+        buffer.reset(new RangerData());
+        pool.push_back(buffer);
+        MAKE_LOG << "Snapshot pool grown to " << pool.size() << "." << std::endl;
     }
 
-    data.angleRes = rangerProxy->GetAngularRes();
-    data.minAngle = rangerProxy->GetMinAngle();
-    data.maxAngle = rangerProxy->GetMaxAngle();
-    data.maxRange = rangerProxy->GetMaxRange();
-    data.minRange = rangerProxy->GetMinRange();
+    getData(*buffer);
+    return buffer;
+}
+
+void Ranger::getData(RangerData& data) {
+    unsigned int count = rangerProxy->GetRangeCount();
+
+    //geometry is static, only re-read it if the proxy changed shape
+    if (count != geometry.range.size())
+        cacheGeometry();
+    if (data.range.size() != count)
+        data = geometry;
+
+    for (unsigned int i = 0; i < count; i++) {
+        data.range[i] = rangerProxy->GetRange(i);
+        data.scan.range[i] = data.range[i];
+    }
+
+    //readings have been consumed
+    rangerProxy->NotFresh();
+}
 
-    return data;
+bool Ranger::isFresh() {
+    return rangerProxy->IsFresh();
 }
 
 std::string Ranger::toString() {
-    //TODO
-    return "Ranger (RangerProxy)";
+    std::stringstream out;
+    out << "Ranger (RangerProxy) readings: " << geometry.range.size()
+        << " snapshot buffers: " << pool.size();
+    return out.str();
 }
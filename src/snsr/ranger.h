@@ -20,11 +20,24 @@
  *
  *  This class completes the interaction between the robot and the
  *  Player/Stage RangerProxy.
+ *
+ *  The ranger geometry (element poses, angle and range limits) never
+ *  changes once the proxy has been configured, so it is read once and
+ *  cached. Each update then only copies the range readings.
+ *
+ *  Readings are handed out as immutable shared snapshots. The Ranger keeps
+ *  a small pool of buffers and refills one that no consumer references any
+ *  more, so after the first few updates no RangerData is allocated or
+ *  copied.
  */
 class Ranger : public Module {
     public:
 
-        /** Constructor. */
+        /** Constructor.
+         *
+         *  The proxy should already have had its geometry and configuration
+         *  requested.
+         */
         Ranger(PlayerCc::RangerProxy& rangerProxy);
 
         /** Destructor  */
@@ -36,9 +49,27 @@ class Ranger : public Module {
          *  Therefore a RangerData struct is used so that passing data from
          *  one class to another is easily accomplished.
          *
-         *  @return Information from the ranger.
+         *  @return Shared read-only snapshot of the latest readings.
+         */
+        RangerSnapshot getData();
+
+        /** Fills a RangerData with the latest readings, without allocating.
+         *
+         *  Meant to be called every tick with the same buffer. Only the
+         *  range readings are written, the cached geometry is copied in the
+         *  first time or whenever the number of readings changes, so the
+         *  buffer must not be shared between rangers.
+         *
+         *  @param data : Buffer to fill, reused between calls.
+         */
+        void getData(RangerData& data);
+
+        /** Checks if the ranger has readings not yet retrieved.
+         *
+         *  @return True if Player delivered new readings since the last
+         *      call to @ref getData .
          */
-        RangerData getData();
+        bool isFresh();
 
         /** Inherited from Module   */
         std::string toString();
@@ -48,6 +79,15 @@ class Ranger : public Module {
         /** RangerProxy */
         PlayerCc::RangerProxy* rangerProxy;
 
+        /** Reads the static geometry from the proxy into @ref geometry . */
+        void cacheGeometry();
+
+        /** Cached geometry, every field but the range readings. */
+        RangerData geometry;
+
+        /** Buffers backing the snapshots handed out by @ref getData . */
+        std::vector<boost::shared_ptr<RangerData> > pool;
+
     private:
 
         /** Hide default Contructor  */
@@ -0,0 +1,21 @@
+/** @file       src/util/geometry.h
+    @ingroup    UTIL
+    @brief      Angle and grid helpers.
+    @author     Alex Moriarty <alexander@dal.ca>
+    @author     Jacob Perron <perronj@yorku.ca>
+*/
+
+#ifndef __UTIL_GEOMETRY_H_
+#define __UTIL_GEOMETRY_H_
+
+#include <math.h>
+
+/** Length of a diagonal step on a grid, in cells. */
+static const float SQRT2 = 1.41421356f;
+
+/** @return An angle wrapped to [-pi, pi]. */
+static inline double wrapAngle(double a) {
+    return atan2(sin(a), cos(a));
+}
+
+#endif
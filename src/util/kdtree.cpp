@@ -0,0 +1,91 @@
+#include "kdtree.h"
+#include <algorithm>
+
+/** Orders points along one axis. */
+struct AxisLess {
+    int axis;
+    AxisLess(int a) : axis(a) { };
+    bool operator()(const KdTree::Point& a, const KdTree::Point& b) const {
+        return axis == 0 ? a.x < b.x : a.y < b.y;
+    }
+};
+
+void KdTree::build(std::vector<Point>& p) {
+    points.swap(p);
+    axis.resize(points.size());
+    split(0, points.size());
+}
+
+void KdTree::split(int first, int last) {
+    if (last - first < 2) {
+        if (last > first)
+            axis[first] = 0;
+        return;
+    }
+
+    //split across the wider side of the range
+    float minX = points[first].x, maxX = minX, minY = points[first].y, maxY = minY;
+    for (int i = first + 1; i < last; i++) {
+        minX = std::min(minX, points[i].x);
+        maxX = std::max(maxX, points[i].x);
+        minY = std::min(minY, points[i].y);
+        maxY = std::max(maxY, points[i].y);
+    }
+    int a = maxX - minX >= maxY - minY ? 0 : 1;
+    int mid = (first + last) / 2;
+    std::nth_element(points.begin() + first, points.begin() + mid,
+                     points.begin() + last, AxisLess(a));
+    axis[mid] = a;
+    split(first, mid);
+    split(mid + 1, last);
+}
+
+int KdTree::nearest(float x, float y, float maxDistance) const {
+    struct Range {
+        int first, last;
+        float bound;
+    };
+    Range stack[128];
+    int top = 0;
+    stack[top].first = 0;
+    stack[top].last = points.size();
+    stack[top++].bound = 0;
+
+    float best = maxDistance * maxDistance;
+    int found = -1;
+    while (top > 0) {
+        Range r = stack[--top];
+        if (r.first >= r.last || r.bound >= best)
+            continue;
+
+        int mid = (r.first + r.last) / 2;
+        const Point& p = points[mid];
+        float dx = x - p.x, dy = y - p.y;
+        float d = dx * dx + dy * dy;
+        if (d < best) {
+            best = d;
+            found = mid;
+        }
+
+        //the far side can only hold a closer point past the split
+        float diff = axis[mid] == 0 ? dx : dy;
+        Range nearSide, farSide;
+        nearSide.bound = r.bound;
+        farSide.bound = diff * diff;
+        if (diff < 0) {
+            nearSide.first = r.first;
+            nearSide.last = mid;
+            farSide.first = mid + 1;
+            farSide.last = r.last;
+        }
+        else {
+            nearSide.first = mid + 1;
+            nearSide.last = r.last;
+            farSide.first = r.first;
+            farSide.last = mid;
+        }
+        stack[top++] = farSide;
+        stack[top++] = nearSide;
+    }
+    return found;
+}
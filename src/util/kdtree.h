@@ -0,0 +1,76 @@
+/** @file       src/util/kdtree.h
+    @ingroup    UTIL
+    @brief      Flat 2D kd-tree for nearest neighbour queries.
+    @author     Alex Moriarty <alexander@dal.ca>
+    @author     Jacob Perron <perronj@yorku.ca>
+*/
+
+#ifndef __UTIL_KDTREE_H_
+#define __UTIL_KDTREE_H_
+
+#include <stdint.h>
+#include <vector>
+
+/** A balanced kd-tree over points in the plane.
+ *
+ *  The tree has no nodes of its own. Building it reorders the points so
+ *  that the median of every range splits it, the median sitting in the
+ *  middle of the range, so the tree is implicit in the array and a query
+ *  walks one contiguous block of memory. Rebuilding it for a new set of
+ *  points reuses the same storage.
+ *
+ *  Every point carries a normal, for matchers that compare a point with
+ *  the line through its neighbour.
+ */
+class KdTree {
+    public:
+
+        /** A point and the unit normal of the surface it lies on. */
+        struct Point {
+            float x, y, nx, ny;
+
+            /** Default constructor. */
+            Point() : x(0), y(0), nx(0), ny(0) { };
+
+            /** Constructor. */
+            Point(float x, float y, float nx, float ny) : x(x), y(y), nx(nx), ny(ny) { };
+        };
+
+        /** Constructor, an empty tree. */
+        KdTree() { };
+
+        /** Builds the tree.
+         *
+         *  @param points : The points, swapped into the tree. Left holding
+         *      the previous points of the tree.
+         */
+        void build(std::vector<Point>& points);
+
+        /** Finds the point nearest to a location.
+         *
+         *  @param x, y : The location.
+         *
+         *  @param maxDistance : Points further than this are ignored.
+         *
+         *  @return Index of the nearest point, or -1 if none is close enough.
+         */
+        int nearest(float x, float y, float maxDistance) const;
+
+        /** @return A point of the tree. */
+        const Point& operator[](int i) const { return points[i]; }
+
+        /** @return Number of points. */
+        int size() const { return points.size(); }
+
+    private:
+
+        /** Splits the points from first to last, exclusive, at the median. */
+        void split(int first, int last);
+
+        /** The points, in tree order. */
+        std::vector<Point> points;
+
+        /** Axis each point splits its range on, 0 for x and 1 for y. */
+        std::vector<uint8_t> axis;
+};
+#endif
@@ -1,50 +1,104 @@
 #include "logger.h"
+#include <stdio.h>
+
+static const int64_t NSEC_PER_SEC = 1000000000LL;
+
+/** Longest the writer thread sleeps when the ring is empty, in case a
+ *  wake up was missed.
+ */
+static const long WRITER_IDLE_MSEC = 100;
 
 Console* Logger::console;
-int Logger::ctor = 0;
-int Logger::dtor = 0;
+boost::atomic<int> Logger::ctor(0);
+boost::atomic<int> Logger::dtor(0);
+boost::atomic<unsigned long> Logger::dropped(0);
+LogSlot Logger::ring[Logger::RING_SIZE];
+boost::atomic<unsigned long> Logger::head(0);
+unsigned long Logger::tail = 0;
+boost::atomic<int64_t> Logger::cachedTime(0);
+time_t Logger::startWall = 0;
+int64_t Logger::startTime = 0;
+boost::thread Logger::writer;
+boost::atomic<bool> Logger::running(false);
+boost::atomic<bool> Logger::asleep(false);
+boost::mutex Logger::idleMutex;
+boost::condition_variable Logger::wake;
 std::ofstream Logger::logStream;
 std::ofstream Logger::structStream;
+std::string Logger::logName;
+std::string Logger::structName;
+unsigned long Logger::logSize = 0;
+unsigned long Logger::structSize = 0;
 
-Logger::Logger(const std::string& moduleName) {
-    name = moduleName;
+/** Second of the last formatted clock string, only used by the writer. */
+static time_t clockSecond = -1;
+
+/** "hh:mm:ss" of @ref clockSecond . */
+static char clockString[16];
+
+static int64_t monotonicNow() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
 }
 
-std::ofstream& Logger::getStructStream() {
-    // Get the current calendar time as a time_t object
-    time_t now = time(0);
-    // Convert time_t to tm as local time
-    tm local = *localtime(&now);
+bool Logger::ringReady = Logger::initRing();
 
-    // Format time to "hh:mm:ss" string
-    char timeString[50];
-    const char format[] = "%X";
-    strftime(timeString, sizeof(timeString) - 1, format, &local);
-    structStream << timeString << ": " << std::setw(22) << std::left << name << ": ";
+bool Logger::initRing() {
+    // Every slot starts free for its first lap
+    for (unsigned long i = 0; i < RING_SIZE; i++)
+        ring[i].seq.store(i, boost::memory_order_relaxed);
+    return true;
+}
 
-    return structStream;
+Logger::Logger(const std::string& moduleName) : level(logInfo) {
+    name = moduleName;
+    registry().push_back(this);
 }
 
-std::ofstream& Logger::getStructStream(bool ctor) {
-    if (ctor)
-       Logger::ctor++;
+std::vector<Logger*>& Logger::registry() {
+    //function static, loggers are created during static initialisation
+    static std::vector<Logger*> loggers;
+    return loggers;
+}
+
+bool Logger::setLevel(const std::string& module, logLevel level) {
+    bool found = false;
+    std::vector<Logger*>& loggers = registry();
+    for (unsigned int i = 0; i < loggers.size(); i++) {
+        if (module == "all" || loggers[i]->name == module) {
+            loggers[i]->level.store(level, boost::memory_order_relaxed);
+            found = true;
+        }
+    }
+    return found;
+}
+
+bool Logger::parseLevel(const std::string& str, logLevel& level) {
+    if (str == "debug")
+        level = logDebug;
+    else if (str == "info")
+        level = logInfo;
+    else if (str == "warn")
+        level = logWarn;
+    else if (str == "error")
+        level = logError;
+    else if (str == "off")
+        level = logOff;
     else
-       Logger::dtor++;
+        return false;
+    return true;
+}
 
-    return Logger::getStructStream();
+void Logger::countStruct(bool isCtor) const {
+    if (isCtor)
+        Logger::ctor++;
+    else
+        Logger::dtor++;
 }
-std::ofstream& Logger::getStream() {
-    // Get the current calendar time as a time_t object
-    time_t now = time(0);
-    // Convert time_t to tm as local time
-    tm local = *localtime(&now);
 
-    // Format time to "hh:mm:ss" string
-    char timeString[50];
-    const char format[] = "%X";
-    strftime(timeString, sizeof(timeString) - 1, format, &local);
-    logStream << timeString << ": " << std::setw(22) << std::left << name << ": ";
-    return logStream;
+const std::string& Logger::getName() const {
+    return name;
 }
 
 void Logger::setConsole(Console& c) {
@@ -55,29 +109,167 @@ void Logger::toConsole(const std::string line) {
     console->log(line);
 }
 
-//Opens new log file
+LogSlot* Logger::claim(unsigned long& pos) {
+    pos = head.load(boost::memory_order_relaxed);
+    for (;;) {
+        LogSlot* slot = &ring[pos & (RING_SIZE - 1)];
+        unsigned long seq = slot->seq.load(boost::memory_order_acquire);
+        long diff = (long)(seq - pos);
+        if (diff == 0) {
+            if (head.compare_exchange_weak(pos, pos + 1,
+                                           boost::memory_order_relaxed)) {
+                //the cache is not kept up to date while the writer sleeps
+                slot->time = asleep.load(boost::memory_order_relaxed) ?
+                             monotonicNow() :
+                             cachedTime.load(boost::memory_order_relaxed);
+                return slot;
+            }
+        }
+        else if (diff < 0) {
+            // The writer has not freed this slot yet, the ring is full
+            dropped++;
+            return NULL;
+        }
+        else {
+            pos = head.load(boost::memory_order_relaxed);
+        }
+    }
+}
+
+void Logger::publish(LogSlot* slot, unsigned long pos) {
+    slot->seq.store(pos + 1, boost::memory_order_release);
+    if (asleep.load(boost::memory_order_relaxed))
+        wake.notify_one();
+}
+
+void Logger::tick() {
+    cachedTime.store(monotonicNow(), boost::memory_order_relaxed);
+}
+
+void Logger::run() {
+    while (running) {
+        tick();
+        if (drain() > 0)
+            continue;
+
+        //nothing to write, sleep until a producer publishes
+        boost::unique_lock<boost::mutex> lock(idleMutex);
+        asleep = true;
+        const LogSlot& next = ring[tail & (RING_SIZE - 1)];
+        if (running && next.seq.load(boost::memory_order_acquire) != tail + 1)
+            wake.timed_wait(lock, boost::posix_time::milliseconds(WRITER_IDLE_MSEC));
+        asleep = false;
+    }
+}
+
+unsigned long Logger::drain() {
+    unsigned long n = 0;
+    for (;;) {
+        LogSlot& slot = ring[tail & (RING_SIZE - 1)];
+        if (slot.seq.load(boost::memory_order_acquire) != tail + 1)
+            break;
+        write(slot);
+        slot.seq.store(tail + RING_SIZE, boost::memory_order_release);
+        tail++;
+        n++;
+    }
+    if (n > 0) {
+        logStream.flush();
+        structStream.flush();
+    }
+    return n;
+}
+
+void Logger::write(const LogSlot& slot) {
+    // Wall-clock second of the record, formatted once per second
+    time_t second = startWall + (time_t)((slot.time - startTime) / NSEC_PER_SEC);
+    if (second != clockSecond) {
+        tm local;
+        localtime_r(&second, &local);
+        strftime(clockString, sizeof(clockString) - 1, "%X", &local);
+        clockSecond = second;
+    }
+
+    char line[LogSlot::TEXT_SIZE + 64];
+    bool newline = slot.length > 0 && slot.text[slot.length - 1] == '\n';
+    int n = snprintf(line, sizeof(line), "%s: %-22s: %.*s%s", clockString,
+                     slot.source->getName().c_str(), (int)slot.length,
+                     slot.text, newline ? "" : "\n");
+    if (n < 0)
+        return;
+    if (n >= (int)sizeof(line))
+        n = sizeof(line) - 1;
+
+    if (slot.isStruct) {
+        structStream.write(line, n);
+        structSize += n;
+        rotate(structStream, structName, structSize);
+    }
+    else {
+        logStream.write(line, n);
+        logSize += n;
+        rotate(logStream, logName, logSize);
+    }
+}
+
+void Logger::rotate(std::ofstream& stream, const std::string& fileName,
+                    unsigned long& size) {
+    if (size < MAX_FILE_SIZE)
+        return;
+
+    stream.close();
+    for (int i = MAX_OLD_FILES - 1; i >= 1; i--) {
+        std::stringstream from, to;
+        from << fileName << "." << i;
+        to << fileName << "." << (i + 1);
+        rename(from.str().c_str(), to.str().c_str());
+    }
+    rename(fileName.c_str(), (fileName + ".1").c_str());
+    stream.open(fileName.c_str(), std::ios::trunc);
+    size = 0;
+}
+
+//Opens new log file and starts the writer thread
 void Logger::start(const std::string& robot) {
-    time_t now = time(0);
-    tm local = *localtime(&now);
-    const char* fileName1;
-    const char* fileName2;
-    std::string name1;
-    std::string name2;
+    startWall = time(0);
+    startTime = monotonicNow();
+    tick();
+
+    tm local;
+    localtime_r(&startWall, &local);
     std::stringstream buildDate;
     buildDate << (local.tm_year+1900) << (local.tm_mon+1) <<  local.tm_mday;
-    name1 = "log/" + robot + "." + buildDate.str() + ".log";
-    name2 = "log/" + robot + "Struct." + buildDate.str() + ".log";
-    fileName1 = name1.c_str();
-    fileName2 = name2.c_str();
+    logName = "log/" + robot + "." + buildDate.str() + ".log";
+    structName = "log/" + robot + "Struct." + buildDate.str() + ".log";
 
-    logStream.open(fileName1, std::ios::app);
+    logStream.open(logName.c_str(), std::ios::app);
+    logStream.seekp(0, std::ios::end);
+    logSize = logStream.tellp() > 0 ? (unsigned long)logStream.tellp() : 0;
     logStream << "Start log - " << local.tm_hour<< ":" << local.tm_min << ":" << local.tm_sec << std::endl;
-    structStream.open(fileName2, std::ios::app);
+    structStream.open(structName.c_str(), std::ios::app);
+    structStream.seekp(0, std::ios::end);
+    structSize = structStream.tellp() > 0 ? (unsigned long)structStream.tellp() : 0;
     structStream << "Start log - " << local.tm_hour<< ":" << local.tm_min << ":" << local.tm_sec << std::endl;
+
+    running = true;
+    writer = boost::thread(&Logger::run);
 }
 
-//Closes log file
+//Writes out what is left and closes log file
 void Logger::stop() {
+    {
+        //the writer is either about to check the flag or waiting
+        boost::lock_guard<boost::mutex> lock(idleMutex);
+        running = false;
+    }
+    wake.notify_one();
+    if (writer.joinable())
+        writer.join();
+    tick();
+    drain();
+
+    if (dropped > 0)
+        logStream << "Dropped " << dropped << " records, ring full." << std::endl;
     logStream.close();
 
     structStream << "Constructed: " << Logger::ctor << " "
@@ -85,3 +277,83 @@ void Logger::stop() {
 
     structStream.close();
 }
+
+LogStream::LogStream(const Logger& logger, bool isStruct) {
+    slot = Logger::claim(pos);
+    if (slot) {
+        slot->source = &logger;
+        slot->isStruct = isStruct;
+        slot->length = 0;
+    }
+}
+
+LogStream::~LogStream() {
+    if (slot)
+        Logger::publish(slot, pos);
+}
+
+void LogStream::append(const char* str, unsigned int n) {
+    if (!slot)
+        return;
+    unsigned int room = LogSlot::TEXT_SIZE - slot->length;
+    if (n > room)
+        n = room;
+    memcpy(slot->text + slot->length, str, n);
+    slot->length += n;
+}
+
+LogStream& LogStream::operator<<(const char* str) {
+    append(str, strlen(str));
+    return *this;
+}
+
+LogStream& LogStream::operator<<(const std::string& str) {
+    append(str.data(), str.size());
+    return *this;
+}
+
+LogStream& LogStream::operator<<(char c) {
+    append(&c, 1);
+    return *this;
+}
+
+LogStream& LogStream::operator<<(bool b) {
+    append(b ? "1" : "0", 1);
+    return *this;
+}
+
+LogStream& LogStream::operator<<(int i) {
+    char buf[24];
+    append(buf, snprintf(buf, sizeof(buf), "%d", i));
+    return *this;
+}
+
+LogStream& LogStream::operator<<(unsigned int i) {
+    char buf[24];
+    append(buf, snprintf(buf, sizeof(buf), "%u", i));
+    return *this;
+}
+
+LogStream& LogStream::operator<<(long i) {
+    char buf[24];
+    append(buf, snprintf(buf, sizeof(buf), "%ld", i));
+    return *this;
+}
+
+LogStream& LogStream::operator<<(unsigned long i) {
+    char buf[24];
+    append(buf, snprintf(buf, sizeof(buf), "%lu", i));
+    return *this;
+}
+
+LogStream& LogStream::operator<<(double d) {
+    char buf[32];
+    append(buf, snprintf(buf, sizeof(buf), "%g", d));
+    return *this;
+}
+
+LogStream& LogStream::operator<<(std::ostream& (*manip)(std::ostream&)) {
+    if (manip == static_cast<std::ostream& (*)(std::ostream&)>(std::endl))
+        append("\n", 1);
+    return *this;
+}
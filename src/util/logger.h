@@ -4,19 +4,148 @@
 #include <iostream>
 #include <fstream>
 #include <stdlib.h>
+#include <stdint.h>
 #include <time.h>
 #include <string.h>
 #include <iomanip>
 #include <sstream>
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
 #include "hrio/console.h"
 
+/** Lowest level compiled in, 0 (debug) to 3 (error).
+ *
+ *  Set with e.g. EXT_CXXFLAGS=-DLOG_MIN_LEVEL=1 to drop debug logging from
+ *  the build. Below it the logging macros compile to nothing.
+ */
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL 0
+#endif
+
 #define CREATE_LOGGER(x) static Logger logger(x)
-#define MAKE_LOG logger.getStream()
-#define LOG_STRUCT logger.getStructStream()
-#define LOG_CTOR logger.getStructStream(true)
-#define LOG_DTOR logger.getStructStream(false)
+#define LOG_AT(level) \
+    !((level) >= LOG_MIN_LEVEL && logger.isEnabled(level)) ? (void)0 \
+        : LogVoidify() & LogStream(logger, false)
+#define LOG_DEBUG LOG_AT(logDebug)
+#define LOG_INFO LOG_AT(logInfo)
+#define LOG_WARN LOG_AT(logWarn)
+#define LOG_ERROR LOG_AT(logError)
+#define MAKE_LOG LOG_INFO
+#define LOG_STRUCT LogStream(logger, true)
+#define LOG_CTOR (logger.countStruct(true), LogStream(logger, true))
+#define LOG_DTOR (logger.countStruct(false), LogStream(logger, true))
 #define TO_CONSOLE(str) logger.toConsole(str)
 
+class Logger;
+
+/** Severity of a log record. */
+enum logLevel {
+    logDebug,
+    logInfo,
+    logWarn,
+    logError,
+    logOff
+};
+
+/** One log record waiting in the ring buffer.
+ *
+ *  @ref seq tells producers and the writer thread who owns the slot, see
+ *  Logger for the protocol.
+ */
+struct LogSlot {
+
+    /** Longest message kept, longer ones are truncated. */
+    static const unsigned int TEXT_SIZE = 232;
+
+    boost::atomic<unsigned long> seq;
+
+    /** Monotonic time the record was made, in nanoseconds. */
+    int64_t time;
+
+    /** Logger that made the record. */
+    const Logger* source;
+
+    /** True for the construction/destruction log. */
+    bool isStruct;
+
+    /** Number of characters used in @ref text . */
+    unsigned int length;
+
+    char text[TEXT_SIZE];
+};
+
+/** Builds a single log record in place.
+ *
+ *  Created by the logging macros as a temporary. The constructor claims a
+ *  slot in the ring buffer, every << writes straight into it and the
+ *  destructor, at the end of the statement, hands the slot to the writer
+ *  thread. Nothing is allocated or written to a file on the calling
+ *  thread, and nothing is locked unless the writer is asleep and has to
+ *  be woken. If the ring is full the record is dropped and counted.
+ */
+class LogStream {
+    public:
+
+        /** Claims a slot for a new record.
+         *
+         *  @param logger : The Logger the record belongs to.
+         *
+         *  @param isStruct : True for the construction/destruction log.
+         */
+        LogStream(const Logger& logger, bool isStruct);
+
+        /** Publishes the record to the writer thread. */
+        ~LogStream();
+
+        LogStream& operator<<(const char* str);
+        LogStream& operator<<(const std::string& str);
+        LogStream& operator<<(char c);
+        LogStream& operator<<(bool b);
+        LogStream& operator<<(int i);
+        LogStream& operator<<(unsigned int i);
+        LogStream& operator<<(long i);
+        LogStream& operator<<(unsigned long i);
+        LogStream& operator<<(double d);
+
+        /** Accepts std::endl. */
+        LogStream& operator<<(std::ostream& (*manip)(std::ostream&));
+
+        /** Anything else is formatted with a stringstream. */
+        template <class T>
+        LogStream& operator<<(const T& value) {
+            std::ostringstream out;
+            out << value;
+            return *this << out.str();
+        }
+
+    private:
+
+        /** Appends characters, truncating once the slot is full. */
+        void append(const char* str, unsigned int n);
+
+        /** Slot being filled, NULL if the record is dropped. */
+        LogSlot* slot;
+
+        /** Ring position of the slot. */
+        unsigned long pos;
+
+        /** Disable copy constructor. */
+        LogStream(const LogStream& source);
+
+        /** Disable assignment operator. */
+        LogStream& operator=(const LogStream& source);
+};
+
+/** Turns a finished LogStream expression into void.
+ *
+ *  Lets LOG_AT pick between logging and doing nothing with ?: , so the
+ *  operands of a disabled record are never evaluated. The & binds looser
+ *  than << , so the whole chain of << ends up on its right.
+ */
+struct LogVoidify {
+    void operator&(const LogStream&) {}
+};
 
 /** Simple and easy to use logging class.
  *
@@ -26,19 +155,43 @@
  *  each with its own name, which will be appended to all log messages
  *  created by the object.
  *
- *  In order to actually log something, a function @ref getStream should
- *  be called. It will return a filestream object where arbitrary messages
- *  can be written with << operator.
+ *  In order to actually log something, the MAKE_LOG macro (or one of
+ *  LOG_DEBUG, LOG_INFO, LOG_WARN and LOG_ERROR) is used like a stream,
+ *  with the << operator. MAKE_LOG logs at the info level. Logging is asynchronous: records are
+ *  captured into a preallocated lock-free ring buffer, stamped with a
+ *  cached monotonic time, and a background thread formats them with the
+ *  timestamp and object (module) name and writes them out. Logging from
+ *  the control loop therefore never waits on a file. While the ring is
+ *  empty the writer sleeps on a condition variable, and the next record
+ *  published wakes it.
+ *
+ *  The ring is a bounded multi-producer queue. Every slot carries a
+ *  sequence number: a producer may claim the slot at position @c pos when
+ *  its sequence equals @c pos , and publishes it by setting it to
+ *  @c pos+1 ; the writer thread frees it again by setting it to
+ *  @c pos+RING_SIZE .
  *
- *  It also appends the current timestamp and object (module) name to the
- *  stream.
+ *  Every Logger has its own runtime level, info by default, which can be
+ *  changed by module name with @ref setLevel . A record below the level,
+ *  or below LOG_MIN_LEVEL at build time, is skipped without evaluating
+ *  anything that is written to it.
  *
  *  A second log file is created just to log the construction and destruction
- *  of all classes.
+ *  of all classes. Log files are rotated once they reach @ref MAX_FILE_SIZE ,
+ *  keeping @ref MAX_OLD_FILES old files.
  */
 class Logger {
   public:
 
+    /** Number of slots in the ring, a power of two. */
+    static const unsigned long RING_SIZE = 4096;
+
+    /** Size at which a log file is rotated, in bytes. */
+    static const unsigned long MAX_FILE_SIZE = 8 * 1024 * 1024;
+
+    /** Number of rotated files kept, as name.1 to name.N. */
+    static const int MAX_OLD_FILES = 3;
+
     /** Constructor.
      *  Create a Logger instance with a specific name (which will appear
      *  in all the log entries made by this object).
@@ -47,32 +200,41 @@ class Logger {
      */
     Logger(const std::string& n);
 
-    /** Get a reference to the filestream where a message can be logged.
+    /** Counts a construction or destruction for the summary.
      *
-     * Current timestamp and the object name are written to the stream
-     * before returning.
+     *  @param ctor : Set true if constructing, or false if destructing.
      */
-    std::ofstream& getStream();
+    void countStruct(bool ctor) const;
+
+    /** @return The object (module) name. */
+    const std::string& getName() const;
 
-    /** Get a reference to the filestream for construction/destruction logging.
+    /** @return True if records of the given level are written. */
+    bool isEnabled(logLevel level) const {
+        return level >= this->level.load(boost::memory_order_relaxed);
+    }
+
+    /** Sets the runtime level of every Logger of a module.
      *
-     *  @param ctor : Set true if constructing, or false if destructing.
+     *  @param module : The object (module) name, or "all".
      *
-     *  @return Reference to filestream for constructors and destructors.
+     *  @param level : Lowest level written from now on.
+     *
+     *  @return False if no Logger has that name.
      */
-    std::ofstream& getStructStream(bool ctor);
+    static bool setLevel(const std::string& module, logLevel level);
 
-    /** Get a reference to the filestream for construction/destruction logging.
+    /** Turns a level name (debug, info, warn, error, off) into a level.
      *
-     *  @return Reference to filestream for constructors and destructors.
+     *  @return False if the name is not a level.
      */
-    std::ofstream& getStructStream();
+    static bool parseLevel(const std::string& str, logLevel& level);
 
     void toConsole(const std::string str);
 
     static void setConsole(Console& console);
 
-    /** Open a new file for logging.
+    /** Open a new file for logging and start the writer thread.
      *
      *  Should be called at the beginning of the main method.
      *
@@ -80,26 +242,102 @@ class Logger {
      */
     static void start(const std::string& robot);
 
-    /** Close the log file.
+    /** Write out all pending records and close the log file.
      *
      *  Should be called at the end of the main method or when all logging
      *  is finished for the duration of the program.
      */
     static void stop();
 
+    /** Claims the next free slot of the ring.
+     *
+     *  @param pos : Set to the ring position of the slot.
+     *
+     *  @return The slot, or NULL if the ring is full.
+     */
+    static LogSlot* claim(unsigned long& pos);
+
+    /** Hands a filled slot to the writer thread. */
+    static void publish(LogSlot* slot, unsigned long pos);
+
   private:
 
     /** Hide default constructor. */
     Logger();
 
+    /** Marks every slot of the ring free, before anything is logged. */
+    static bool initRing();
+
+    /** Body of the writer thread. */
+    static void run();
+
+    /** Writes out every published record.
+     *
+     *  @return Number of records written.
+     */
+    static unsigned long drain();
+
+    /** Formats and writes one record. */
+    static void write(const LogSlot& slot);
+
+    /** Rotates a log file if it grew past the size cap. */
+    static void rotate(std::ofstream& stream, const std::string& fileName,
+                       unsigned long& size);
+
+    /** Updates the cached monotonic time. */
+    static void tick();
+
+    /** @return Every Logger created so far. */
+    static std::vector<Logger*>& registry();
+
     /** Name of object (module). */
     std::string name;
 
+    /** Lowest level written by this Logger. */
+    boost::atomic<int> level;
+
     /** Counter for number of Constructions. */
-    static int ctor;
+    static boost::atomic<int> ctor;
 
     /** Counter for number of Destructions. */
-    static int dtor;
+    static boost::atomic<int> dtor;
+
+    /** Number of records lost because the ring was full. */
+    static boost::atomic<unsigned long> dropped;
+
+    /** The ring buffer. */
+    static LogSlot ring[RING_SIZE];
+
+    /** Set once the ring is initialised. */
+    static bool ringReady;
+
+    /** Next position producers claim. */
+    static boost::atomic<unsigned long> head;
+
+    /** Next position the writer thread reads. */
+    static unsigned long tail;
+
+    /** Monotonic time cached by the writer thread, in nanoseconds. */
+    static boost::atomic<int64_t> cachedTime;
+
+    /** Wall-clock time matching @ref startTime . */
+    static time_t startWall;
+
+    /** Monotonic time when logging started, in nanoseconds. */
+    static int64_t startTime;
+
+    /** The writer thread. */
+    static boost::thread writer;
+
+    /** Tells the writer thread to keep running. */
+    static boost::atomic<bool> running;
+
+    /** Set while the writer thread waits on @ref wake for records. */
+    static boost::atomic<bool> asleep;
+
+    /** Guards the writer going to sleep, and wakes it on a record. */
+    static boost::mutex idleMutex;
+    static boost::condition_variable wake;
 
     /** Log stream to which all objects write. */
     static std::ofstream logStream;
@@ -107,6 +345,10 @@ class Logger {
     /** Log stream for all construction/destruction. */
     static std::ofstream structStream;
 
+    /** File names and bytes written, for rotation. */
+    static std::string logName, structName;
+    static unsigned long logSize, structSize;
+
     /** Console to log too. */
     static Console* console;
 };
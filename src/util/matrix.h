@@ -0,0 +1,138 @@
+/** @file       src/util/matrix.h
+    @ingroup    UTIL
+    @brief      Fixed-size matrices sized at compile time.
+    @author     Alex Moriarty <alexander@dal.ca>
+    @author     Jacob Perron <perronj@yorku.ca>
+*/
+
+#ifndef __UTIL_MATRIX_H_
+#define __UTIL_MATRIX_H_
+
+#include <math.h>
+
+/** A dense matrix of doubles with R rows and C columns.
+ *
+ *  The elements live inside the object, row by row, so a Matrix declared
+ *  in a function is on the stack and none of the operations below touch
+ *  the heap. The sizes are template parameters, so the loops have fixed
+ *  trip counts the compiler can unroll, and mismatched sizes do not
+ *  compile.
+ */
+template <int R, int C>
+class Matrix {
+    public:
+
+        /** Constructor, every element zero. */
+        Matrix() { setZero(); }
+
+        /** @return The element in row i, column j. */
+        double& operator()(int i, int j) { return v[i][j]; }
+
+        /** @return The element in row i, column j. */
+        double operator()(int i, int j) const { return v[i][j]; }
+
+        /** Sets every element to zero. */
+        void setZero() {
+            for (int i = 0; i < R; i++)
+                for (int j = 0; j < C; j++)
+                    v[i][j] = 0;
+        }
+
+        /** @return The identity matrix. */
+        static Matrix identity() {
+            Matrix m;
+            for (int i = 0; i < R && i < C; i++)
+                m.v[i][i] = 1;
+            return m;
+        }
+
+        /** @return The transpose. */
+        Matrix<C, R> transpose() const {
+            Matrix<C, R> t;
+            for (int i = 0; i < R; i++)
+                for (int j = 0; j < C; j++)
+                    t(j, i) = v[i][j];
+            return t;
+        }
+
+        /** Adds a matrix element by element. */
+        Matrix& operator+=(const Matrix& m) {
+            for (int i = 0; i < R; i++)
+                for (int j = 0; j < C; j++)
+                    v[i][j] += m.v[i][j];
+            return *this;
+        }
+
+        /** Subtracts a matrix element by element. */
+        Matrix& operator-=(const Matrix& m) {
+            for (int i = 0; i < R; i++)
+                for (int j = 0; j < C; j++)
+                    v[i][j] -= m.v[i][j];
+            return *this;
+        }
+
+        /** Scales every element. */
+        Matrix& operator*=(double s) {
+            for (int i = 0; i < R; i++)
+                for (int j = 0; j < C; j++)
+                    v[i][j] *= s;
+            return *this;
+        }
+
+        /** @return The sum of two matrices. */
+        Matrix operator+(const Matrix& m) const { Matrix r(*this); return r += m; }
+
+        /** @return The difference of two matrices. */
+        Matrix operator-(const Matrix& m) const { Matrix r(*this); return r -= m; }
+
+        /** @return The matrix scaled. */
+        Matrix operator*(double s) const { Matrix r(*this); return r *= s; }
+
+        /** @return The product with a matrix of K columns. */
+        template <int K>
+        Matrix<R, K> operator*(const Matrix<C, K>& m) const {
+            Matrix<R, K> p;
+            for (int i = 0; i < R; i++)
+                for (int k = 0; k < C; k++) {
+                    double a = v[i][k];
+                    if (a == 0)
+                        continue;
+                    for (int j = 0; j < K; j++)
+                        p(i, j) += a * m(k, j);
+                }
+            return p;
+        }
+
+        /** Copies a block of a larger matrix into this one.
+         *
+         *  @param m : The larger matrix.
+         *
+         *  @param row, col : Element of @p m at the top left of the block.
+         */
+        template <int R2, int C2>
+        void getBlock(const Matrix<R2, C2>& m, int row, int col) {
+            for (int i = 0; i < R; i++)
+                for (int j = 0; j < C; j++)
+                    v[i][j] = m(row + i, col + j);
+        }
+
+        /** Copies this matrix into a block of a larger one.
+         *
+         *  @param m : The larger matrix.
+         *
+         *  @param row, col : Element of @p m at the top left of the block.
+         */
+        template <int R2, int C2>
+        void setBlock(Matrix<R2, C2>& m, int row, int col) const {
+            for (int i = 0; i < R; i++)
+                for (int j = 0; j < C; j++)
+                    m(row + i, col + j) = v[i][j];
+        }
+
+    private:
+
+        /** The elements, row by row. */
+        double v[R][C];
+};
+
+#endif
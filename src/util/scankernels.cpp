@@ -0,0 +1,204 @@
+#include "scankernels.h"
+#include <math.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+float ScanKernels::minimum(const Scan& scan, int& index) {
+    return sectorMinimum(scan, 0, scan.size, index);
+}
+
+float ScanKernels::sectorMinimum(const Scan& scan, unsigned int from,
+                                 unsigned int to, int& index) {
+    index = -1;
+    if (to > scan.size)
+        to = scan.size;
+    if (from >= to)
+        return FLT_MAX;
+
+    const float* r = &scan.range[0];
+    float best = FLT_MAX;
+    unsigned int i = from;
+
+    //first pass, the minimum value
+#ifdef __SSE2__
+    __m128 vbest = _mm_set1_ps(FLT_MAX);
+    for (; i + Scan::WIDTH <= to; i += Scan::WIDTH)
+        vbest = _mm_min_ps(vbest, _mm_loadu_ps(r + i));
+    float lane[Scan::WIDTH];
+    _mm_storeu_ps(lane, vbest);
+    for (unsigned int k = 0; k < Scan::WIDTH; k++)
+        if (lane[k] < best)
+            best = lane[k];
+#endif
+    for (; i < to; i++)
+        if (r[i] < best)
+            best = r[i];
+
+    //second pass, the first reading equal to the minimum
+    i = from;
+#ifdef __SSE2__
+    __m128 vmin = _mm_set1_ps(best);
+    for (; i + Scan::WIDTH <= to; i += Scan::WIDTH) {
+        int mask = _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(r + i), vmin));
+        if (mask) {
+            index = i + __builtin_ctz(mask);
+            return best;
+        }
+    }
+#endif
+    for (; i < to; i++) {
+        if (r[i] == best) {
+            index = i;
+            break;
+        }
+    }
+    return best;
+}
+
+bool ScanKernels::anyBelow(const Scan& scan, float threshold) {
+    //padding is FLT_MAX, so the whole padded array can be scanned
+    const unsigned int n = scan.range.size();
+    if (n == 0)
+        return false;
+    const float* r = &scan.range[0];
+
+#ifdef __SSE2__
+    __m128 t = _mm_set1_ps(threshold);
+    for (unsigned int i = 0; i < n; i += Scan::WIDTH)
+        if (_mm_movemask_ps(_mm_cmplt_ps(_mm_load_ps(r + i), t)))
+            return true;
+#else
+    for (unsigned int i = 0; i < n; i++)
+        if (r[i] < threshold)
+            return true;
+#endif
+    return false;
+}
+
+bool ScanKernels::anyInside(const Scan& scan, float minX, float maxX,
+                            float minY, float maxY) {
+    const unsigned int n = scan.size;
+    if (n == 0)
+        return false;
+
+    const float* r = &scan.range[0];
+    const float* c = &scan.cosAngle[0];
+    const float* s = &scan.sinAngle[0];
+    const float* ox = &scan.originX[0];
+    const float* oy = &scan.originY[0];
+    unsigned int i = 0;
+
+#ifdef __SSE2__
+    __m128 x0 = _mm_set1_ps(minX), x1 = _mm_set1_ps(maxX);
+    __m128 y0 = _mm_set1_ps(minY), y1 = _mm_set1_ps(maxY);
+    for (; i + Scan::WIDTH <= n; i += Scan::WIDTH) {
+        __m128 vr = _mm_load_ps(r + i);
+        __m128 x = _mm_add_ps(_mm_load_ps(ox + i), _mm_mul_ps(vr, _mm_load_ps(c + i)));
+        __m128 y = _mm_add_ps(_mm_load_ps(oy + i), _mm_mul_ps(vr, _mm_load_ps(s + i)));
+        __m128 in = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(x, x0), _mm_cmple_ps(x, x1)),
+                               _mm_and_ps(_mm_cmpge_ps(y, y0), _mm_cmple_ps(y, y1)));
+        if (_mm_movemask_ps(in))
+            return true;
+    }
+#endif
+    //padding would convert to the origin, so the tail is done one by one
+    for (; i < n; i++) {
+        float x = ox[i] + r[i]*c[i];
+        float y = oy[i] + r[i]*s[i];
+        if (x >= minX && x <= maxX && y >= minY && y <= maxY)
+            return true;
+    }
+    return false;
+}
+
+void ScanKernels::toCartesian(const Scan& scan, FloatArray& x, FloatArray& y) {
+    const unsigned int n = scan.range.size();
+    x.resize(n);
+    y.resize(n);
+    if (n == 0)
+        return;
+
+    const float* r = &scan.range[0];
+    const float* c = &scan.cosAngle[0];
+    const float* s = &scan.sinAngle[0];
+    const float* ox = &scan.originX[0];
+    const float* oy = &scan.originY[0];
+    float* px = &x[0];
+    float* py = &y[0];
+
+#ifdef __SSE2__
+    for (unsigned int i = 0; i < n; i += Scan::WIDTH) {
+        __m128 vr = _mm_load_ps(r + i);
+        _mm_store_ps(px + i, _mm_add_ps(_mm_load_ps(ox + i), _mm_mul_ps(vr, _mm_load_ps(c + i))));
+        _mm_store_ps(py + i, _mm_add_ps(_mm_load_ps(oy + i), _mm_mul_ps(vr, _mm_load_ps(s + i))));
+    }
+#else
+    for (unsigned int i = 0; i < n; i++) {
+        px[i] = ox[i] + r[i]*c[i];
+        py[i] = oy[i] + r[i]*s[i];
+    }
+#endif
+}
+
+void ScanKernels::toCells(const Scan& scan, float px, float py, float yaw,
+                          float scale, float maxRange, IntArray& x0,
+                          IntArray& y0, IntArray& x1, IntArray& y1) {
+    const unsigned int n = scan.range.size();
+    x0.resize(n);
+    y0.resize(n);
+    x1.resize(n);
+    y1.resize(n);
+    if (n == 0)
+        return;
+
+    const float* r = &scan.range[0];
+    const float* c = &scan.cosAngle[0];
+    const float* s = &scan.sinAngle[0];
+    const float* ox = &scan.originX[0];
+    const float* oy = &scan.originY[0];
+    const float cy = cos(yaw);
+    const float sy = sin(yaw);
+
+#ifdef __SSE2__
+    __m128 vcy = _mm_set1_ps(cy), vsy = _mm_set1_ps(sy);
+    __m128 vpx = _mm_set1_ps(px), vpy = _mm_set1_ps(py);
+    __m128 vscale = _mm_set1_ps(scale), vmax = _mm_set1_ps(maxRange);
+    __m128i one = _mm_set1_epi32(1);
+    for (unsigned int i = 0; i < n; i += Scan::WIDTH) {
+        __m128 vox = _mm_load_ps(ox + i), voy = _mm_load_ps(oy + i);
+        __m128 vc = _mm_load_ps(c + i), vs = _mm_load_ps(s + i);
+        __m128 vr = _mm_mul_ps(_mm_min_ps(_mm_load_ps(r + i), vmax), vscale);
+
+        //rotate the origin and direction into the grid
+        __m128 sx = _mm_add_ps(vpx, _mm_mul_ps(vscale,
+                        _mm_sub_ps(_mm_mul_ps(vcy, vox), _mm_mul_ps(vsy, voy))));
+        __m128 sy2 = _mm_add_ps(vpy, _mm_mul_ps(vscale,
+                        _mm_add_ps(_mm_mul_ps(vsy, vox), _mm_mul_ps(vcy, voy))));
+        __m128 dx = _mm_sub_ps(_mm_mul_ps(vcy, vc), _mm_mul_ps(vsy, vs));
+        __m128 dy = _mm_add_ps(_mm_mul_ps(vsy, vc), _mm_mul_ps(vcy, vs));
+        __m128 ex = _mm_add_ps(sx, _mm_mul_ps(vr, dx));
+        __m128 ey = _mm_add_ps(sy2, _mm_mul_ps(vr, dy));
+
+        //floor, truncation rounds negative values up by one
+        __m128 f[4] = { sx, sy2, ex, ey };
+        int32_t* out[4] = { &x0[i], &y0[i], &x1[i], &y1[i] };
+        for (int k = 0; k < 4; k++) {
+            __m128i t = _mm_cvttps_epi32(f[k]);
+            __m128i up = _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(t), f[k]));
+            _mm_store_si128((__m128i*)out[k], _mm_sub_epi32(t, _mm_and_si128(up, one)));
+        }
+    }
+#else
+    for (unsigned int i = 0; i < n; i++) {
+        float range = (r[i] < maxRange ? r[i] : maxRange) * scale;
+        float sx = px + scale*(cy*ox[i] - sy*oy[i]);
+        float sy2 = py + scale*(sy*ox[i] + cy*oy[i]);
+        x0[i] = (int32_t)floor(sx);
+        y0[i] = (int32_t)floor(sy2);
+        x1[i] = (int32_t)floor(sx + range*(cy*c[i] - sy*s[i]));
+        y1[i] = (int32_t)floor(sy2 + range*(sy*c[i] + cy*s[i]));
+    }
+#endif
+}
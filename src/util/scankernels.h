@@ -0,0 +1,185 @@
+/** @file       src/util/scankernels.h
+    @ingroup    UTIL
+    @brief      Vectorized scan processing.
+    @author     Alex Moriarty <alexander@dal.ca>
+    @author     Jacob Perron <perronj@yorku.ca>
+*/
+
+#ifndef __UTIL_SCANKERNELS_H_
+#define __UTIL_SCANKERNELS_H_
+
+#include <stdlib.h>
+#include "data/scan.h"
+
+/** Utility Class Containing Static Scan Processing Functions.
+ *
+ *  The loops every controller runs over its ranger readings each tick,
+ *  written against the structure of arrays layout of Scan. When the
+ *  compiler targets SSE2 (always the case on x86-64) four readings are
+ *  processed per instruction, otherwise a plain loop is used.
+ */
+class ScanKernels {
+    public:
+
+        /** Finds the shortest reading.
+         *
+         *  @param scan : The readings.
+         *
+         *  @param index : Set to the index of the shortest reading, or -1 if
+         *      the scan is empty.
+         *
+         *  @return The shortest range, FLT_MAX if the scan is empty.
+         */
+        static float minimum(const Scan& scan, int& index);
+
+        /** Finds the shortest reading within a range of indices.
+         *
+         *  @param scan : The readings.
+         *
+         *  @param from : First index of the sector.
+         *
+         *  @param to : One past the last index of the sector.
+         *
+         *  @param index : Set to the index of the shortest reading, or -1 if
+         *      the sector is empty.
+         *
+         *  @return The shortest range in the sector, FLT_MAX if empty.
+         */
+        static float sectorMinimum(const Scan& scan, unsigned int from,
+                                   unsigned int to, int& index);
+
+        /** Checks if any reading is shorter than a threshold.
+         *
+         *  @param scan : The readings.
+         *
+         *  @param threshold : Distance in meters.
+         *
+         *  @return True if at least one reading is below the threshold.
+         */
+        static bool anyBelow(const Scan& scan, float threshold);
+
+        /** Checks if any reading falls inside a box in the robot frame.
+         *
+         *  Each reading is converted to a point on the fly, without storing
+         *  the points.
+         *
+         *  @param scan : The readings.
+         *
+         *  @param minX, maxX : Extent of the box along the robot heading.
+         *
+         *  @param minY, maxY : Extent of the box to the robot's left.
+         *
+         *  @return True if at least one reading lies inside the box.
+         */
+        static bool anyInside(const Scan& scan, float minX, float maxX,
+                              float minY, float maxY);
+
+        /** Converts every reading to a point in the robot frame.
+         *
+         *  @param scan : The readings.
+         *
+         *  @param x : Filled with the x coordinates, resized to the padded
+         *      size of the scan.
+         *
+         *  @param y : Filled with the y coordinates, resized likewise.
+         */
+        static void toCartesian(const Scan& scan, FloatArray& x, FloatArray& y);
+
+        /** Converts every reading to the grid cells its ray starts and ends in.
+         *
+         *  Positions are in cells, so a cell (x, y) covers [x, x+1) and
+         *  [y, y+1). Ranges are clipped to @p maxRange .
+         *
+         *  @param scan : The readings.
+         *
+         *  @param px, py : Position of the robot, in cells.
+         *
+         *  @param yaw : Heading of the robot in the grid, in radians.
+         *
+         *  @param scale : Cells per meter.
+         *
+         *  @param maxRange : Longest range used, in meters.
+         *
+         *  @param x0, y0 : Filled with the cell each ray starts in, resized
+         *      to the padded size of the scan.
+         *
+         *  @param x1, y1 : Filled with the cell each ray ends in, likewise.
+         */
+        static void toCells(const Scan& scan, float px, float py, float yaw,
+                            float scale, float maxRange, IntArray& x0,
+                            IntArray& y0, IntArray& x1, IntArray& y1);
+
+        /** Walks the rays of a scan over a grid, by Bresenham's algorithm.
+         *
+         *  The grid is told about the cells through three members, which
+         *  it must make reachable from here: inside(x, y) to check a cell
+         *  is on the grid, clear(x, y) for every cell a ray passed through
+         *  and mark(x, y) for the cell a ray ended in. The grid must be
+         *  convex, a ray is dropped at the first cell off it.
+         *
+         *  @param grid : The grid updated.
+         *
+         *  @param scan : The readings, the ones at @p maxRange hit nothing.
+         *
+         *  @param maxRange : Longest range of the ranger, in meters.
+         *
+         *  @param x0, y0, x1, y1 : Cells every ray starts and ends in, as
+         *      filled by @ref toCells .
+         *
+         *  @return Number of cells cleared or marked.
+         */
+        template <class Grid>
+        static unsigned int traceScan(Grid& grid, const Scan& scan,
+                                      float maxRange, const IntArray& x0,
+                                      const IntArray& y0, const IntArray& x1,
+                                      const IntArray& y1);
+
+    private:
+
+        /** Hide default constructor. */
+        ScanKernels();
+
+        /** Disable copy constructor. */
+        ScanKernels(const ScanKernels& source);
+};
+
+template <class Grid>
+unsigned int ScanKernels::traceScan(Grid& grid, const Scan& scan,
+                                    float maxRange, const IntArray& x0,
+                                    const IntArray& y0, const IntArray& x1,
+                                    const IntArray& y1) {
+    unsigned int n = 0;
+    for (unsigned int i = 0; i < scan.size; i++) {
+        int x = x0[i], y = y0[i], ex = x1[i], ey = y1[i];
+        int dx = abs(ex - x), dy = abs(ey - y);
+        int sx = x < ex ? 1 : -1, sy = y < ey ? 1 : -1;
+        int err = dx - dy;
+
+        bool off = false;
+        while (x != ex || y != ey) {
+            if (!grid.inside(x, y)) {
+                off = true;
+                break;
+            }
+            grid.clear(x, y);
+            n++;
+
+            int e2 = err << 1;
+            if (e2 > -dy) {
+                err -= dy;
+                x += sx;
+            }
+            if (e2 < dx) {
+                err += dx;
+                y += sy;
+            }
+        }
+
+        if (!off && scan.range[i] < maxRange && grid.inside(x, y)) {
+            grid.mark(x, y);
+            n++;
+        }
+    }
+    return n;
+}
+#endif
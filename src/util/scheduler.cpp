@@ -0,0 +1,118 @@
+#include "scheduler.h"
+#include <time.h>
+#include <errno.h>
+
+CREATE_LOGGER("Scheduler");
+
+static const int64_t NSEC_PER_SEC = 1000000000LL;
+
+Scheduler::Scheduler(double frequency) {
+    setFrequency(frequency);
+    start();
+    LOG_CTOR << "Constructed." << std::endl;
+}
+
+Scheduler::~Scheduler() {
+    LOG_DTOR << "Destructed." << std::endl;
+}
+
+int64_t Scheduler::now() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+void Scheduler::start() {
+    tickStart = now();
+    deadline = tickStart + period;
+    ticks = overruns = missed = 0;
+    lastWork = worstWork = 0;
+}
+
+bool Scheduler::sleep() {
+    int64_t t = now();
+    bool onTime = true;
+    countTick(t);
+
+    if (t > deadline) {
+        //skip every period already missed, keep the original phase
+        int64_t skip = (t - deadline) / period + 1;
+        overruns++;
+        missed += skip - 1;
+        MAKE_LOG << "Overrun by " << (t - deadline) / 1000 << " us, skipping "
+                 << skip - 1 << " period(s)." << std::endl;
+        deadline += skip * period;
+        onTime = false;
+    }
+
+    timespec ts;
+    ts.tv_sec = deadline / NSEC_PER_SEC;
+    ts.tv_nsec = deadline % NSEC_PER_SEC;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ; //interrupted by a signal, sleep for the remainder
+
+    tickStart = now();
+    deadline += period;
+    return onTime;
+}
+
+void Scheduler::beginTick() {
+    tickStart = now();
+}
+
+bool Scheduler::endTick() {
+    countTick(now());
+    if (lastWork <= period)
+        return true;
+    overruns++;
+    return false;
+}
+
+void Scheduler::countTick(int64_t t) {
+    ticks++;
+    lastWork = t - tickStart;
+    if (lastWork > worstWork)
+        worstWork = lastWork;
+}
+
+void Scheduler::setFrequency(double frequency) {
+    if (frequency <= 0) {
+        MAKE_LOG << "Invalid frequency " << frequency << ", using 10 Hz." << std::endl;
+        frequency = 10;
+    }
+    period = (int64_t)(NSEC_PER_SEC / frequency);
+}
+
+double Scheduler::getFrequency() {
+    return (double)NSEC_PER_SEC / period;
+}
+
+unsigned long Scheduler::getTicks() {
+    return ticks;
+}
+
+unsigned long Scheduler::getOverruns() {
+    return overruns;
+}
+
+unsigned long Scheduler::getMissed() {
+    return missed;
+}
+
+double Scheduler::getLastWork() {
+    return (double)lastWork / NSEC_PER_SEC;
+}
+
+double Scheduler::getWorstWork() {
+    return (double)worstWork / NSEC_PER_SEC;
+}
+
+std::string Scheduler::toString() {
+    std::stringstream out;
+    out << "Scheduler " << getFrequency() << " Hz, "
+        << "ticks: " << ticks << ", "
+        << "overruns: " << overruns << ", "
+        << "missed: " << missed << ", "
+        << "worst work: " << getWorstWork() * 1000.0 << " ms";
+    return out.str();
+}
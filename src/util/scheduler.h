@@ -0,0 +1,129 @@
+/** @file       src/util/scheduler.h
+    @ingroup    UTIL
+    @brief      Fixed-rate loop scheduler.
+    @author     Alex Moriarty <alexander@dal.ca>
+    @author     Jacob Perron <perronj@yorku.ca>
+*/
+
+#ifndef __UTIL_SCHEDULER_H_
+#define __UTIL_SCHEDULER_H_
+
+#include <stdint.h>
+#include <sstream>
+#include "infs/module.h"
+
+/** Paces a loop at a fixed rate on the monotonic clock.
+ *
+ *  The superloop calls @ref start once before entering the loop and then
+ *  @ref sleep at the end of every tick. Deadlines are absolute, one period
+ *  apart, so time spent doing work inside the tick is subtracted from the
+ *  time spent sleeping and the rate does not drift.
+ *
+ *  A tick that finishes after its deadline is counted as an overrun. The
+ *  scheduler then skips the periods it missed instead of running a burst of
+ *  back-to-back ticks to catch up, so the loop stays on the same phase even
+ *  under load.
+ */
+class Scheduler : public Module {
+    public:
+
+        /** Constructor.
+         *
+         *  @param frequency : The loop rate in Hz.
+         */
+        Scheduler(double frequency);
+
+        /** Destructor. */
+        ~Scheduler();
+
+        /** Anchors the first deadline one period from now.
+         *
+         *  Should be called right before entering the loop. Statistics are
+         *  reset.
+         */
+        void start();
+
+        /** Sleeps until the next deadline.
+         *
+         *  Should be called once at the end of every tick.
+         *
+         *  @return False if the tick overran its deadline, true otherwise.
+         */
+        bool sleep();
+
+        /** Marks the start of a tick that is not paced by @ref sleep .
+         *
+         *  For loops woken by events rather than by the clock: call this
+         *  when an event arrives and @ref endTick once it is handled.
+         */
+        void beginTick();
+
+        /** Counts a tick started by @ref beginTick , without sleeping.
+         *
+         *  @return False if handling the event took longer than one
+         *      period, which is counted as an overrun.
+         */
+        bool endTick();
+
+        /** Changes the loop rate.
+         *
+         *  The new period takes effect from the next deadline.
+         *
+         *  @param frequency : The new loop rate in Hz.
+         */
+        void setFrequency(double frequency);
+
+        /** @return The loop rate in Hz. */
+        double getFrequency();
+
+        /** @return Number of ticks since @ref start . */
+        unsigned long getTicks();
+
+        /** @return Number of ticks that finished after their deadline. */
+        unsigned long getOverruns();
+
+        /** @return Number of whole periods skipped because of overruns. */
+        unsigned long getMissed();
+
+        /** @return Time spent working in the last tick, in seconds. */
+        double getLastWork();
+
+        /** @return Longest time spent working in a tick, in seconds. */
+        double getWorstWork();
+
+        /** @return Current time on the monotonic clock, in nanoseconds. */
+        static int64_t now();
+
+        /** Returns the loop rate and overrun statistics. */
+        std::string toString();
+
+    private:
+
+        /** Disable default constructor. */
+        Scheduler();
+
+        /** Disable copy constructor. */
+        Scheduler(const Scheduler& source);
+
+        /** Disable assignment operator. */
+        Scheduler& operator=(const Scheduler& source);
+
+        /** Counts a tick ending at time @p t and its work time. */
+        void countTick(int64_t t);
+
+        /** Length of one tick, in nanoseconds. */
+        int64_t period;
+
+        /** Absolute time the current tick should finish by. */
+        int64_t deadline;
+
+        /** Absolute time the current tick started. */
+        int64_t tickStart;
+
+        /** Tick statistics. */
+        unsigned long ticks, overruns, missed;
+
+        /** Work time of the last and the longest tick, in nanoseconds. */
+        int64_t lastWork, worstWork;
+};
+#endif
@@ -0,0 +1,76 @@
+#include "workerpool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool() {
+    started = 0;
+    job = NULL;
+    first = last = 0;
+    blocks = 0;
+    generation = 0;
+    pending = 0;
+    stopping = false;
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        boost::lock_guard<boost::mutex> lock(mutex);
+        stopping = true;
+    }
+    posted.notify_all();
+    threads.join_all();
+}
+
+void WorkerPool::run(const Job& job, int first, int last, int grain) {
+    int hardware = std::max(1, (int)boost::thread::hardware_concurrency());
+    int n = std::min(hardware, (last - first + 1) / std::max(grain, 1));
+    if (n <= 1) {
+        job(first, last);
+        return;
+    }
+
+    {
+        boost::lock_guard<boost::mutex> lock(mutex);
+        for (; started < hardware - 1; started++)
+            threads.add_thread(new boost::thread(&WorkerPool::work, this,
+                                                 started + 1, generation));
+        this->job = &job;
+        this->first = first;
+        this->last = last;
+        blocks = n;
+        pending = n - 1;
+        generation++;
+    }
+    posted.notify_all();
+
+    runBlock(0);
+
+    boost::unique_lock<boost::mutex> lock(mutex);
+    while (pending > 0)
+        finished.wait(lock);
+    this->job = NULL;
+}
+
+void WorkerPool::runBlock(int block) {
+    int size = last - first + 1;
+    (*job)(first + size * block / blocks, first + size * (block + 1) / blocks - 1);
+}
+
+void WorkerPool::work(int block, unsigned long seen) {
+    boost::unique_lock<boost::mutex> lock(mutex);
+    while (true) {
+        while (generation == seen && !stopping)
+            posted.wait(lock);
+        if (stopping)
+            return;
+        seen = generation;
+
+        //short jobs leave the higher numbered workers idle
+        if (block >= blocks)
+            continue;
+        lock.unlock();
+        runBlock(block);
+        lock.lock();
+        if (--pending == 0)
+            finished.notify_one();
+    }
+}
@@ -0,0 +1,87 @@
+/** @file       src/util/workerpool.h
+    @ingroup    UTIL
+    @brief      Persistent threads for data parallel loops.
+    @author     Alex Moriarty <alexander@dal.ca>
+    @author     Jacob Perron <perronj@yorku.ca>
+*/
+
+#ifndef __UTIL_WORKERPOOL_H_
+#define __UTIL_WORKERPOOL_H_
+
+#include <boost/thread.hpp>
+#include <boost/function.hpp>
+
+/** Splits a loop over a range of indices across the hardware threads.
+ *
+ *  The threads are started the first time a loop is worth splitting and
+ *  then sleep on a condition variable between loops, so a loop costs a
+ *  wake up rather than a thread creation per block. The calling thread
+ *  does the first block itself.
+ *
+ *  A pool runs one loop at a time, @ref run must not be called from two
+ *  threads at once.
+ */
+class WorkerPool {
+    public:
+
+        /** Work on the indices first to last, inclusive. */
+        typedef boost::function<void (int, int)> Job;
+
+        /** Constructor, no threads are started yet. */
+        WorkerPool();
+
+        /** Destructor, stops and joins the threads. */
+        ~WorkerPool();
+
+        /** Runs a job over a range, returning once all of it is done.
+         *
+         *  @param job : Called once per block.
+         *
+         *  @param first, last : The range of indices, inclusive.
+         *
+         *  @param grain : Fewest indices worth a thread of their own. A
+         *      range shorter than twice this runs on the calling thread.
+         */
+        void run(const Job& job, int first, int last, int grain);
+
+    private:
+
+        /** Disable copy constructor. */
+        WorkerPool(const WorkerPool& source);
+
+        /** Disable assignment operator. */
+        WorkerPool& operator=(const WorkerPool& source);
+
+        /** Runs one block of the current job. */
+        void runBlock(int block);
+
+        /** Body of a worker thread, doing the block of its number.
+         *
+         *  @param seen : Generation of the last job before it started.
+         */
+        void work(int block, unsigned long seen);
+
+        /** The worker threads, numbered from 1. */
+        boost::thread_group threads;
+        int started;
+
+        /** Guards the fields below, and the two conditions. */
+        boost::mutex mutex;
+
+        /** Signalled when a job is posted, and when one is finished. */
+        boost::condition_variable posted, finished;
+
+        /** The current job, its range and the blocks it is split into. */
+        const Job* job;
+        int first, last, blocks;
+
+        /** Counts the jobs posted, so a worker can tell a new one. */
+        unsigned long generation;
+
+        /** Blocks of the current job still running on workers. */
+        int pending;
+
+        /** Set to make the workers return. */
+        bool stopping;
+};
+#endif